@@ -979,6 +979,7 @@ void generate_service_header(const std::string &outputdirectory, ClassDefinition
 	header_out << "\t\t" <<        class_definition.name << "_Service();" << std::endl;
 	header_out << "\t\t" << "~" << class_definition.name << "_Service();" << std::endl;
 	header_out << "\t\t" << "void call(unsigned interface_no, unsigned function_no, int client_fd, saftbus::Deserializer &received, saftbus::Serializer &send);" << std::endl;
+	header_out << "\t\t" << "std::string get_function_name(unsigned interface_no, unsigned function_no);" << std::endl;
 	header_out << std::endl;
 
 	// function declaration for the functions that will be connected to the signals (e.g. std::function objects)
@@ -1156,6 +1157,24 @@ void generate_service_implementation(const std::string &outputdirectory, ClassDe
 	out << "\t}" << std::endl;
 	out << std::endl;
 
+	// function names for the call statistics in saftbus::Container::get_status
+	out << "\t" << "std::string " << class_definition.name << "_Service::get_function_name(unsigned interface_no, unsigned function_no) {" << std::endl;
+	out << "\t\tswitch(interface_no) {" << std::endl;
+	for (unsigned interface_no = 0; interface_no < class_and_all_base_classes.size(); ++interface_no) {
+		out << "\t\t\t" << "case " << interface_no << ": // " << class_and_all_base_classes[interface_no]->name << std::endl;
+		out << "\t\t\tswitch(function_no) {" << std::endl;
+		for (unsigned function_no  = 0; function_no  < class_and_all_base_classes[interface_no]->exportedfunctions.size(); ++function_no ) {
+			auto &function = class_and_all_base_classes[interface_no]->exportedfunctions[function_no];
+			out << "\t\t\t\t" << "case " << function_no << ": return \"" << function.name << "\";" << std::endl;
+		}
+		out << "\t\t\t};" << std::endl;
+		out << "\t\t\tbreak;" << std::endl;
+	}
+	out << "\t\t};" << std::endl;
+	out << "\t\t" << "return std::string();" << std::endl;
+	out << "\t}" << std::endl;
+	out << std::endl;
+
 	// signal dispatch functions
 	// for (auto &signal: class_definition.exportedsignals) {
 	// 	out << "\t\t" << "d->" << signal.name << " = std::bind(&" << class_definition.name << "_Service::" << signal.name << "_dispatch_function, this";
@@ -295,13 +295,19 @@ namespace saftbus {
 						}
 					}
 				}
-				if (d->pfd.revents & POLLHUP) {
-					assert(false); // did the server crash? this should never happen
-				}
+				// If POLLHUP is set, the server crashed or disconnected this SignalGroup (SlowConsumerPolicy::DISCONNECT).
+				// The signals that are still in the socket are dispatched, then read_from fails and the exception is thrown.
 			}
 		}
 		return result;
 	}
+	void SignalGroup::set_slow_consumer_policy(SlowConsumerPolicy policy, unsigned backlog_capacity)
+	{
+		// A Proxy in this SignalGroup makes sure that the signal fd was sent to the server.
+		auto container = Container_Proxy::create("/saftbus", *this);
+		container->set_signal_group_policy(d->signal_group_id, policy, backlog_capacity);
+	}
+
 	SignalGroup& SignalGroup::get_global()
 	{
 		static SignalGroup signal_group;
@@ -546,4 +552,40 @@ namespace saftbus {
 		get_received().get(return_value_result_);
 		return return_value_result_;
 	}
+	std::string Container_Proxy::get_trace(	) {
+		std::lock_guard<rtpi::mutex> mutex_lock(get_proxy_mutex());
+		get_send().put(get_saftbus_object_id());
+		get_send().put(interface_no);
+		get_send().put(7); // function_no
+		get_connection().atomic_send_and_receive(get_send(), get_received());
+		saftbus::FunctionResult function_result_;
+		get_received().get(function_result_);
+		if (function_result_ == saftbus::FunctionResult::EXCEPTION) {
+			std::string what;
+			get_received().get(what);
+			throw saftbus::Error(what);
+		}
+		assert(function_result_ == saftbus::FunctionResult::RETURN);
+		std::string return_value_result_;
+		get_received().get(return_value_result_);
+		return return_value_result_;
+	}
+	void Container_Proxy::set_signal_group_policy(int signal_group_fd, SlowConsumerPolicy policy, unsigned capacity) {
+		std::lock_guard<rtpi::mutex> mutex_lock(get_proxy_mutex());
+		get_send().put(get_saftbus_object_id());
+		get_send().put(interface_no);
+		get_send().put(8); // function_no
+		get_send().put(signal_group_fd);
+		get_send().put(policy);
+		get_send().put(capacity);
+		get_connection().atomic_send_and_receive(get_send(), get_received());
+		saftbus::FunctionResult function_result_;
+		get_received().get(function_result_);
+		if (function_result_ == saftbus::FunctionResult::EXCEPTION) {
+			std::string what;
+			get_received().get(what);
+			throw saftbus::Error(what);
+		}
+		assert(function_result_ == saftbus::FunctionResult::RETURN);
+	}
 }
\ No newline at end of file
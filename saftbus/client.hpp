@@ -114,6 +114,17 @@ namespace saftbus {
 		/// @return >0 if a signal was received, 0 if timeout was hit, < 0 in case of failure (e.g. service object was destroyed)
 		int wait_for_one_signal(int timeout_ms = -1);
 
+		/// @brief Choose what saftbusd does if this SignalGroup does not read its signals fast enough.
+		///
+		/// If the signal socket is not writable, saftbusd keeps the signals in a backlog and sends them
+		/// as soon as the socket becomes writable again. The policy decides what happens when the backlog is full.
+		/// The defaults are set by the environment variables SAFTBUS_SIGNAL_POLICY and SAFTBUS_SIGNAL_BACKLOG of saftbusd.
+		/// @param policy what to do if the backlog is full
+		/// @param backlog_capacity maximum number of signals in the backlog. 
+		///        0 means that signals are dropped (DROP_NEWEST, DROP_OLDEST) or the SignalGroup is disconnected (DISCONNECT) 
+		///        whenever the socket is not writable.
+		void set_slow_consumer_policy(SlowConsumerPolicy policy, unsigned backlog_capacity);
+
 		static SignalGroup &get_global();
 	};
 
@@ -187,6 +198,43 @@ namespace saftbus {
 
 	/// @brief contains all information about the status of a saftbus server.
 	struct SaftbusInfo : public SerDesAble {
+		/// @brief call statistics of one function of a service object
+		struct CallInfo : public SerDesAble {
+			enum { histogram_bins = 24 };
+			std::string interface_name;
+			std::string function_name; // "#<function_no>" if the Service does not know the name
+			uint64_t calls;
+			uint64_t total_ns;       // sum of all execution times
+			uint64_t max_ns;         // longest execution time
+			uint64_t bytes_received; // arguments, including the saftbus header
+			uint64_t bytes_sent;     // return values
+			std::vector<uint64_t> histogram;       // histogram[i] counts calls with execution time < 2^i us (the last bin counts all others)
+			std::map<int, uint64_t> client_calls;  // number of calls per client (client_fd, see ClientInfo)
+			/// @brief custom serializer
+			void serialize(Serializer &ser) const {
+				ser.put(interface_name);
+				ser.put(function_name);
+				ser.put(calls);
+				ser.put(total_ns);
+				ser.put(max_ns);
+				ser.put(bytes_received);
+				ser.put(bytes_sent);
+				ser.put(histogram);
+				ser.put(client_calls);
+			}
+			/// @brief custom deserializer
+			void deserialize(const Deserializer &des) {
+				des.get(interface_name);
+				des.get(function_name);
+				des.get(calls);
+				des.get(total_ns);
+				des.get(max_ns);
+				des.get(bytes_received);
+				des.get(bytes_sent);
+				des.get(histogram);
+				des.get(client_calls);
+			}
+		};
 		/// @brief contains all information about a service object
 		struct ObjectInfo : public SerDesAble {
 			unsigned object_id;
@@ -196,6 +244,7 @@ namespace saftbus {
 			int owner;
 			bool has_destruction_callback;
 			bool destroy_if_owner_quits;
+			std::vector<CallInfo> call_infos; // only functions that were called at least once
 			/// @brief custom serializer
 			void serialize(Serializer &ser) const {
 				ser.put(object_id);
@@ -205,6 +254,10 @@ namespace saftbus {
 				ser.put(owner);
 				ser.put(has_destruction_callback);
 				ser.put(destroy_if_owner_quits);
+				ser.put(call_infos.size());
+				for (auto &call_info: call_infos) {
+					ser.put(call_info);
+				}
 			}
 			/// @brief custom deserializer
 			void deserialize(const Deserializer &des) {
@@ -215,6 +268,12 @@ namespace saftbus {
 				des.get(owner);
 				des.get(has_destruction_callback);
 				des.get(destroy_if_owner_quits);
+				size_t size;
+				des.get(size);
+				call_infos.resize(size);
+				for (unsigned i = 0; i < size; ++i) {
+					des.get(call_infos[i]);
+				}
 			}
 		};
 		std::vector<ObjectInfo> object_infos;
@@ -237,6 +296,43 @@ namespace saftbus {
 			}
 		};
 		std::vector<ClientInfo> client_infos;
+		/// @brief backlog of one signal fd (i.e. of one SignalGroup of a client)
+		struct SignalGroupInfo : public SerDesAble {
+			int signal_fd;
+			int client_fd;
+			SlowConsumerPolicy policy;
+			unsigned capacity;   // maximum number of signals in the backlog
+			unsigned depth;      // current number of signals in the backlog
+			unsigned max_depth;  // largest depth so far
+			uint64_t delayed;    // signals that were not written immediately but went through the backlog
+			uint64_t dropped;    // signals that were lost because the backlog was full
+			bool disconnected;
+			/// @brief custom serializer
+			void serialize(Serializer &ser) const {
+				ser.put(signal_fd);
+				ser.put(client_fd);
+				ser.put(policy);
+				ser.put(capacity);
+				ser.put(depth);
+				ser.put(max_depth);
+				ser.put(delayed);
+				ser.put(dropped);
+				ser.put(disconnected);
+			}
+			/// @brief custom deserializer
+			void deserialize(const Deserializer &des) {
+				des.get(signal_fd);
+				des.get(client_fd);
+				des.get(policy);
+				des.get(capacity);
+				des.get(depth);
+				des.get(max_depth);
+				des.get(delayed);
+				des.get(dropped);
+				des.get(disconnected);
+			}
+		};
+		std::vector<SignalGroupInfo> signal_group_infos;
 		std::vector<std::string> active_plugins;
 		std::map<std::string, std::string> additional_info;
 		/// @brief custom serializer
@@ -249,6 +345,10 @@ namespace saftbus {
 			for (auto &client: client_infos) {
 				ser.put(client);
 			}
+			ser.put(signal_group_infos.size());
+			for (auto &signal_group: signal_group_infos) {
+				ser.put(signal_group);
+			}
 			ser.put(active_plugins);
 			ser.put(additional_info);
 		}
@@ -265,6 +365,11 @@ namespace saftbus {
 			for (unsigned i = 0; i < size; ++i) {
 				des.get(client_infos[i]);
 			}
+			des.get(size);
+			signal_group_infos.resize(size);
+			for (unsigned i = 0; i < size; ++i) {
+				des.get(signal_group_infos[i]);
+			}
 			des.get(active_plugins);
 			des.get(additional_info);
 		}
@@ -291,6 +396,8 @@ namespace saftbus {
 		bool remove_object(const std::string &object_path);
 		void quit();
 		SaftbusInfo get_status();
+		std::string get_trace();
+		void set_signal_group_policy(int signal_group_fd, SlowConsumerPolicy policy, unsigned capacity);
 	private:
 		int interface_no;
 
@@ -22,6 +22,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <fstream>
 #include <algorithm>
 #include <thread>
 
@@ -29,11 +30,26 @@
 void usage(char *argv0) {
 		std::cout << "saftbus-ctl version " << VERSION << std::endl;
 		std::cout << std::endl;
-		std::cout << "usage: " << argv0 << " [-s] [-r <object-path>] [-l <plugin.so> {plugin-args}] [-u <plugin.so>] [-h|--help]" << std::endl;
+		std::cout << "usage: " << argv0 << " [-s] [-c] [-b [interval-ms]] [-t <file>] [-r <object-path>] [-l <plugin.so> {plugin-args}] [-u <plugin.so>] [-h|--help]" << std::endl;
 		std::cout << std::endl;
 		std::cout << "  -s           print saftbus status, i.e. all available services," << std::endl; 
 		std::cout << "               loaded plugins and connected clients." << std::endl;
 		std::cout << std::endl;
+		std::cout << "  -c           print call statistics of all service functions that were called:" << std::endl;
+		std::cout << "               number of calls, execution time, transferred bytes, the calls" << std::endl;
+		std::cout << "               of each client and a histogram of the execution time." << std::endl;
+		std::cout << std::endl;
+		std::cout << "  -b           print the signal backlog of each signal group of all clients every" << std::endl;
+		std::cout << "               interval-ms milliseconds (default: 1000) until interrupted." << std::endl;
+		std::cout << "               The default policy and backlog capacity are set with the environment" << std::endl;
+		std::cout << "               variables SAFTBUS_SIGNAL_POLICY (drop-newest, drop-oldest, disconnect)" << std::endl;
+		std::cout << "               and SAFTBUS_SIGNAL_BACKLOG of saftbusd." << std::endl;
+		std::cout << std::endl;
+		std::cout << "  -t | --trace write the hot-path trace of saftbusd to <file> (\"-\" for stdout)." << std::endl;
+		std::cout << "               The file is in Chrome trace event format and can be opened" << std::endl;
+		std::cout << "               with chrome://tracing or https://ui.perfetto.dev" << std::endl;
+		std::cout << "               The trace is empty if saftlib was configured with --disable-trace." << std::endl;
+		std::cout << std::endl;
 		std::cout << "  -r           remove the service with <object-path> from saftbus" << std::endl; 
 		std::cout << std::endl;
 		std::cout << "  -l           load a share object file as plugin and execute the create_services" << std::endl;
@@ -52,6 +68,34 @@ void usage(char *argv0) {
 }
 
 
+void print_signal_groups(saftbus::SaftbusInfo &saftbus_info) {
+	std::map<int, pid_t> client_pids;
+	for (auto &client: saftbus_info.client_infos) {
+		client_pids[client.client_fd] = client.process_id;
+	}
+	std::cout << "signal groups:" << std::endl;
+	std::cout << "  sig-fd client      pid policy       backlog/capacity max-backlog    delayed    dropped" << std::endl;
+	for (auto &signal_group: saftbus_info.signal_group_infos) {
+		std::string policy;
+		switch(signal_group.policy) {
+			case saftbus::SlowConsumerPolicy::DROP_NEWEST: policy = "drop-newest"; break;
+			case saftbus::SlowConsumerPolicy::DROP_OLDEST: policy = "drop-oldest"; break;
+			case saftbus::SlowConsumerPolicy::DISCONNECT:  policy = "disconnect";  break;
+		}
+		std::ostringstream backlog;
+		backlog << signal_group.depth << "/" << signal_group.capacity;
+		std::cout << "  " << std::right << std::setw(6) << signal_group.signal_fd 
+		          << std::setw(7) << signal_group.client_fd 
+		          << std::setw(9) << client_pids[signal_group.client_fd] << " "
+		          << std::left << std::setw(12) << policy 
+		          << std::right << std::setw(17) << backlog.str() 
+		          << std::setw(12) << signal_group.max_depth
+		          << std::setw(11) << signal_group.delayed
+		          << std::setw(11) << signal_group.dropped 
+		          << (signal_group.disconnected ? " disconnected" : "") << std::endl;
+	}
+}
+
 void print_status(saftbus::SaftbusInfo &saftbus_info) {
 	auto max_object_path_length = std::string().size();
 	for (auto &object: saftbus_info.object_infos) {
@@ -99,6 +143,9 @@ void print_status(saftbus::SaftbusInfo &saftbus_info) {
 		std::cout << "  " << client.client_fd << " (pid=" << client.process_id << ")" << std::endl;
 	}
 
+	std::cout << std::endl;
+	print_signal_groups(saftbus_info);
+
 	for (auto &additional: saftbus_info.additional_info) {
 		std::cout << std::endl;
 		std::cout << additional.first << ":" << std::endl;
@@ -113,6 +160,44 @@ void print_status(saftbus::SaftbusInfo &saftbus_info) {
 
 }
 
+void print_calls(saftbus::SaftbusInfo &saftbus_info) {
+	std::map<int, pid_t> client_pids;
+	for (auto &client: saftbus_info.client_infos) {
+		client_pids[client.client_fd] = client.process_id;
+	}
+	std::cout << "function calls:" << std::endl;
+	std::cout << "  " << std::setw(45) << std::left << "object-path interface::function"
+	          << std::right << std::setw(10) << "calls" << std::setw(12) << "total[ms]" << std::setw(10) << "mean[us]" << std::setw(10) << "max[us]"
+	          << std::setw(12) << "rx[bytes]" << std::setw(12) << "tx[bytes]" << std::endl;
+	for (auto &object: saftbus_info.object_infos) {
+		for (auto &call: object.call_infos) {
+			std::cout << "  " << std::setw(45) << std::left << (object.object_path + " " + call.interface_name + "::" + call.function_name)
+			          << std::right << std::setw(10) << call.calls 
+			          << std::setw(12) << call.total_ns/1000000 
+			          << std::setw(10) << (call.calls ? call.total_ns/call.calls/1000 : 0)
+			          << std::setw(10) << call.max_ns/1000
+			          << std::setw(12) << call.bytes_received 
+			          << std::setw(12) << call.bytes_sent << std::endl;
+			std::cout << "      clients:";
+			for (auto &client_calls: call.client_calls) {
+				std::cout << " " << client_calls.first;
+				if (client_pids.find(client_calls.first) != client_pids.end()) {
+					std::cout << "(pid=" << client_pids[client_calls.first] << ")";
+				}
+				std::cout << ":" << client_calls.second;
+			}
+			std::cout << std::endl;
+			std::cout << "      histogram:";
+			for (unsigned bin = 0; bin < call.histogram.size(); ++bin) {
+				if (call.histogram[bin] == 0) continue;
+				if (bin+1 < call.histogram.size()) std::cout << " <" << (1u<<bin) << "us:" << call.histogram[bin];
+				else                               std::cout << " >=" << (1u<<(bin-1)) << "us:" << call.histogram[bin];
+			}
+			std::cout << std::endl;
+		}
+	}
+}
+
 
 int main(int argc, char **argv)
 {
@@ -150,6 +235,45 @@ int main(int argc, char **argv)
 					print_status(saftbus_info);
 					return 0;
 				}
+				if (argvi == "-b") {
+					int interval_ms = 1000;
+					if (i+1 < argc) {
+						std::istringstream in(argv[i+1]);
+						if (!(in >> interval_ms) || interval_ms <= 0) {
+							throw std::runtime_error("expect interval-ms > 0 after -b");
+						}
+					}
+					auto container_proxy = saftbus::Container_Proxy::create();
+					for (;;) {
+						saftbus::SaftbusInfo saftbus_info = container_proxy->get_status();
+						print_signal_groups(saftbus_info);
+						std::cout << std::endl;
+						std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+					}
+				}
+				if (argvi == "-c") {
+					saftbus::SaftbusInfo saftbus_info = saftbus::Container_Proxy::create()->get_status();
+					print_calls(saftbus_info);
+					return 0;
+				}
+				if (argvi == "-t" || argvi == "--trace") {
+					if ((++i) < argc) {
+						std::string filename = argv[i];
+						std::string trace = saftbus::Container_Proxy::create()->get_trace();
+						if (filename == "-") {
+							std::cout << trace;
+						} else {
+							std::ofstream out(filename.c_str());
+							out << trace;
+							if (!out) {
+								throw std::runtime_error(std::string("cannot write trace to ") + filename);
+							}
+						}
+						return 0;
+					} else {
+						throw std::runtime_error("expect filename after -t");
+					}
+				}
 				if (argvi == "-l") {
 					if ((++i) < argc) {
 						std::string so_filename = argv[i];
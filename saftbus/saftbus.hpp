@@ -65,6 +65,13 @@ namespace saftbus {
 		EXCEPTION,
 	};
 
+	/// @brief What saftbusd does with a signal for a SignalGroup whose backlog is full (see SignalGroup::set_slow_consumer_policy).
+	enum class SlowConsumerPolicy {
+		DROP_NEWEST, // discard the new signal
+		DROP_OLDEST, // discard the oldest signal in the backlog and append the new one
+		DISCONNECT,  // shut down the signal socket, the client gets an exception in SignalGroup::wait_for_signal
+	};
+
 	int write_all(int fd, const char *buffer, int size);
 	int read_all(int fd, char *buffer, int size);
 
@@ -204,6 +211,9 @@ namespace saftbus {
 
 		bool empty();
 
+		// number of serialized bytes
+		size_t size() const { return _data.size(); }
+
 		// has to be called before first call to put()
 		void put_init();
 	private:
@@ -228,6 +238,9 @@ namespace saftbus {
 		// fill the serdes data buffer by reading data from the file descriptor fd
 		bool read_from(int fd);
 
+		// number of bytes that were read by read_from
+		size_t size() const { return _data.size(); }
+
 		// Types derived from SerDesAble
 		template<typename T>
 		typename std::enable_if<std::is_base_of<SerDesAble,T>::value>::type // this method competed in overload resulution with template<typename T> get(T &val). "enable_if" lets this version win if a daughter class of SerDesAble is used.
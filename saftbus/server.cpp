@@ -22,6 +22,7 @@
 #include "service.hpp"
 #include "saftbus.hpp"
 #include "loop.hpp"
+#include "trace.hpp"
 
 #include <sstream>
 #include <iostream>
@@ -161,6 +162,7 @@ namespace saftbus {
 				send.put(what);
 			} 
 			if (!send.empty()) {
+				SAFTBUS_TRACE_SCOPE("reply write", fd);
 				send.write_to(fd);
 			}
 		}
@@ -23,17 +23,72 @@
 #include "plugins.hpp"
 #include "loop.hpp"
 #include "error.hpp"
+#include "trace.hpp"
 
 #include <string>
 #include <map>
 #include <set>
 #include <cassert>
+#include <cstdlib>
 #include <sstream>
+#include <chrono>
+#include <deque>
 
 #include <unistd.h>
+#include <sys/socket.h>
 
 namespace saftbus {
 
+	// statistics of all calls of one function of one Service
+	struct CallStatistics {
+		uint64_t calls;
+		uint64_t total_ns;
+		uint64_t max_ns;
+		uint64_t bytes_received;
+		uint64_t bytes_sent;
+		uint64_t histogram[SaftbusInfo::CallInfo::histogram_bins];
+		std::map<int, uint64_t> client_calls;
+		CallStatistics() : calls(0), total_ns(0), max_ns(0), bytes_received(0), bytes_sent(0), histogram() {}
+		void add(int client_fd, uint64_t duration_ns, uint64_t received, uint64_t sent) {
+			++calls;
+			total_ns += duration_ns;
+			if (duration_ns > max_ns) max_ns = duration_ns;
+			bytes_received += received;
+			bytes_sent     += sent;
+			unsigned bin = 0;
+			for (uint64_t us = duration_ns/1000; us > 0 && bin < SaftbusInfo::CallInfo::histogram_bins-1; us >>= 1) {
+				++bin;
+			}
+			++histogram[bin];
+			++client_calls[client_fd];
+		}
+	};
+
+	// Signals that could not be written immediately to one signal fd (i.e. to one SignalGroup of a client).
+	// They are written as soon as the fd becomes writable, and always before any newer signal to that fd.
+	struct SignalBacklog {
+		SlowConsumerPolicy policy;
+		unsigned capacity;
+		std::deque<Serializer> queue;
+		unsigned max_depth;
+		uint64_t delayed;
+		uint64_t dropped;
+		bool disconnected;
+		bool flushing;           // io_source is connected
+		SourceHandle io_source;  // waits for POLLOUT while the queue is not empty
+
+		static SlowConsumerPolicy default_policy;
+		static unsigned           default_capacity;
+		SignalBacklog() : policy(default_policy), capacity(default_capacity), max_depth(0), delayed(0), dropped(0), disconnected(false), flushing(false) {}
+
+		// return false if a signal was lost
+		bool push(int fd, Serializer &send);
+		bool flush(int fd, int condition);
+		void disconnect(int fd);
+	};
+	SlowConsumerPolicy SignalBacklog::default_policy   = SlowConsumerPolicy::DROP_NEWEST;
+	unsigned           SignalBacklog::default_capacity = 256;
+
 	struct Service::Impl {
 		int owner;
 		std::map<int, std::pair<int, int> > signal_fds_use_count_and_dropped_signals;
@@ -42,8 +97,81 @@ namespace saftbus {
 		uint64_t object_id;
 		std::function<void()> destruction_callback; // a funtion can be attatched here that is called whenever the service is destroyed
 		bool destroy_if_owner_quits; 
+		std::map<std::pair<unsigned, unsigned>, CallStatistics> call_statistics; // key is (interface_no, function_no)
 		void remove_signal_fd(int fd);
+		static std::map<int, SignalBacklog> signal_backlogs; // key is the signal fd, it is shared by all Services
 	};
+	std::map<int, SignalBacklog> Service::Impl::signal_backlogs;
+
+	bool SignalBacklog::push(int fd, Serializer &send)
+	{
+		bool lost = false;
+		if (queue.size() >= capacity) {
+			switch(policy) {
+				case SlowConsumerPolicy::DROP_NEWEST:
+					++dropped;
+					return false;
+				case SlowConsumerPolicy::DROP_OLDEST:
+					++dropped;
+					if (queue.empty()) {
+						return false;
+					}
+					queue.pop_front();
+					lost = true;
+				break;
+				case SlowConsumerPolicy::DISCONNECT:
+					++dropped;
+					disconnect(fd);
+					return false;
+			}
+		}
+		queue.push_back(send);
+		++delayed;
+		if (queue.size() > max_depth) {
+			max_depth = queue.size();
+		}
+		if (!flushing) {
+			io_source = Loop::get_default().connect<IoSource>(std::bind(&SignalBacklog::flush, this, std::placeholders::_1, std::placeholders::_2), fd, POLLOUT);
+			flushing = true;
+		}
+		return !lost;
+	}
+
+	bool SignalBacklog::flush(int fd, int condition)
+	{
+		if (condition & (POLLHUP | POLLERR)) {
+			queue.clear();
+			flushing = false;
+			return false;
+		}
+		while (!queue.empty()) {
+			struct pollfd pfd;
+			pfd.fd = fd;
+			pfd.events = POLLOUT;
+			if (poll(&pfd, 1, 0) <= 0) {
+				return true; // wait for the next POLLOUT
+			}
+			SAFTBUS_TRACE_SCOPE("signal backlog write", fd);
+			queue.front().write_to_no_init(fd);
+			queue.pop_front();
+		}
+		flushing = false;
+		return false;
+	}
+
+	void SignalBacklog::disconnect(int fd)
+	{
+		// The fd stays open until the client hangs up (it is closed by the ServerConnection),
+		// but the client sees the hang up on its end of the socket pair.
+		shutdown(fd, SHUT_RDWR);
+		queue.clear();
+		disconnected = true;
+		if (flushing) {
+			Loop::get_default().remove(io_source);
+			flushing = false;
+		}
+		std::cerr << "saftbus: signal fd " << fd << " was disconnected because its backlog was full" << std::endl;
+	}
 
 	struct Container::Impl {
 		std::vector<std::pair<std::string, std::unique_ptr<LibraryLoader> > > plugins;
@@ -52,6 +180,9 @@ namespace saftbus {
 		std::map<unsigned, std::unique_ptr<Service> > objects; // Container owns the Service objects
 		std::map<std::string, unsigned> object_path_lookup_table; // maps object_path to saftbus_object_id
 		std::vector<Service*> removed_services;
+		bool lazy; // true if SAFTBUS_LAZY_OBJECTS is set
+		std::map<std::string, std::function<std::unique_ptr<Service>()> > lazy_objects; // object_path to factory, for objects that were not yet needed
+		bool materialize(Container *container, const std::string &object_path);
 		std::map<std::string, std::function<std::string(void)> > additional_info_callbacks; // allow plugins to add additional info to be shown by "saftbus-ctl -s"
 		void reset_children_first(const std::string &object_path) {
 			if (object_path == "/saftbus") return;
@@ -73,6 +204,7 @@ namespace saftbus {
 
 		}
 		void clear() {
+			lazy_objects.clear();
 			// Make sure that service objects are destroyed in the opposite order (youngest object first).
 			// The std::map "objects" is sorted after object id, which is increasing for all created objects.
 			// starting with the last object in the map, the correct destruction order is assured.
@@ -169,7 +301,14 @@ namespace saftbus {
 		int interface_no, function_no;
 		received.get(interface_no);
 		received.get(function_no);
+		auto start = std::chrono::steady_clock::now();
 		call(interface_no, function_no, client_fd, received, send);
+		uint64_t duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		d->call_statistics[std::make_pair(interface_no, function_no)].add(client_fd, duration_ns, received.size(), send.size());
+	}
+
+	std::string Service::get_function_name(unsigned interface_no, unsigned function_no) {
+		return std::string();
 	}
 
 	void Service::Impl::remove_signal_fd(int fd)
@@ -182,17 +321,25 @@ namespace saftbus {
 
 	void Service::emit(Serializer &send)
 	{
+		SAFTBUS_TRACE_SCOPE("Service::emit", d->object_id);
 		for (auto &fd_use_count_dropped: d->signal_fds_use_count_and_dropped_signals) {
 			auto &fd              = fd_use_count_dropped.first;
 			auto &use_count       = fd_use_count_dropped.second.first;
 			auto &dropped_signals = fd_use_count_dropped.second.second;
 			if (use_count > 0) { // only send data if use count is > 0
+				auto &backlog = Impl::signal_backlogs[fd];
+				if (backlog.disconnected) {
+					continue;
+				}
 				struct pollfd pfd;
 				pfd.fd = fd;
 				pfd.events = POLLOUT;
-				if (poll(&pfd, 1, 0) <= 0) { // fd is not ready immediately => drop the signal
-					++dropped_signals;      // count number of dropped signals (this number can be seen when with "saftbus-ctl -s")
+				if (!backlog.queue.empty() || poll(&pfd, 1, 0) <= 0) { // fd is not ready immediately (or older signals are waiting) => put the signal in the backlog
+					if (!backlog.push(fd, send)) {
+						++dropped_signals;      // count number of dropped signals (this number can be seen when with "saftbus-ctl -s")
+					}
 				} else {
+					SAFTBUS_TRACE_SCOPE("signal write", fd);
 					send.write_to_no_init(fd); // The same data is written multiple times. Therefore the
 				}                             // put_init function must not be called automatically after write
 			}                                //
@@ -305,6 +452,21 @@ namespace saftbus {
 					send.put(saftbus::FunctionResult::RETURN);
 					send.put(function_call_result);
 				} return;
+				case 7: { // Container::get_trace
+					std::string function_call_result = d->get_trace();
+					send.put(saftbus::FunctionResult::RETURN);
+					send.put(function_call_result);
+				} return;
+				case 8: { // Container::set_signal_group_policy
+					int signal_group_fd;
+					received.get(signal_group_fd);
+					SlowConsumerPolicy policy;
+					received.get(policy);
+					unsigned capacity;
+					received.get(capacity);
+					d->set_signal_group_policy(signal_group_fd, policy, capacity);
+					send.put(saftbus::FunctionResult::RETURN);
+				} return;
 			};
 
 		};
@@ -318,6 +480,13 @@ namespace saftbus {
 			send.put(what);
 		} 
 	}
+	std::string Container_Service::get_function_name(unsigned interface_no, unsigned function_no) {
+		const char *names[] = {"register_proxy", "unregister_proxy", "load_plugin", "unload_plugin", "remove_object", "quit", "get_status", "get_trace", "set_signal_group_policy"};
+		if (interface_no == 0 && function_no < sizeof(names)/sizeof(names[0])) {
+			return names[function_no];
+		}
+		return std::string();
+	}
 
 
 	// generate a unique object_id != 0
@@ -330,9 +499,32 @@ namespace saftbus {
 		return saftbus_object_id_generator++;
 	}
 
+	bool Container::Impl::materialize(Container *container, const std::string &object_path) {
+		auto lazy_object = lazy_objects.find(object_path);
+		if (lazy_object == lazy_objects.end()) {
+			return false;
+		}
+		auto factory = std::move(lazy_object->second);
+		lazy_objects.erase(lazy_object);
+		return container->create_object(object_path, factory()) != 0;
+	}
+
 	Container::Container(ServerConnection *connection) 
 		: d(new Impl)
 	{
+		d->lazy = getenv("SAFTBUS_LAZY_OBJECTS") != nullptr;
+		const char *signal_policy = getenv("SAFTBUS_SIGNAL_POLICY");
+		if (signal_policy != nullptr) {
+			std::string policy(signal_policy);
+			     if (policy == "drop-newest") SignalBacklog::default_policy = SlowConsumerPolicy::DROP_NEWEST;
+			else if (policy == "drop-oldest") SignalBacklog::default_policy = SlowConsumerPolicy::DROP_OLDEST;
+			else if (policy == "disconnect")  SignalBacklog::default_policy = SlowConsumerPolicy::DISCONNECT;
+			else std::cerr << "SAFTBUS_SIGNAL_POLICY must be drop-newest, drop-oldest, or disconnect" << std::endl;
+		}
+		const char *signal_backlog = getenv("SAFTBUS_SIGNAL_BACKLOG");
+		if (signal_backlog != nullptr) {
+			SignalBacklog::default_capacity = strtoul(signal_backlog, nullptr, 0);
+		}
 		unsigned object_id = create_object("/saftbus", std::move(std::unique_ptr<Container_Service>(new Container_Service(this))));
 		assert(object_id == 1); // the entier system relies on having Container_Service at object_id 1	
 		d->connection = connection;
@@ -345,7 +537,8 @@ namespace saftbus {
 
 	unsigned Container::create_object(const std::string &object_path, std::unique_ptr<Service> service)
 	{
-		if (d->object_path_lookup_table.find(object_path) != d->object_path_lookup_table.end()) {
+		if (d->object_path_lookup_table.find(object_path) != d->object_path_lookup_table.end() ||
+		    d->lazy_objects.find(object_path) != d->lazy_objects.end()) {
 			// we have already registered an object under this object path
 			return 0;
 		}
@@ -362,8 +555,22 @@ namespace saftbus {
 		return 0;
 	}
 
+	bool Container::create_object_lazy(const std::string &object_path, std::function<std::unique_ptr<Service>()> factory)
+	{
+		if (!d->lazy) {
+			return create_object(object_path, factory()) != 0;
+		}
+		if (d->object_path_lookup_table.find(object_path) != d->object_path_lookup_table.end() ||
+		    d->lazy_objects.find(object_path) != d->lazy_objects.end()) {
+			return false;
+		}
+		d->lazy_objects[object_path] = factory;
+		return true;
+	}
+
 	Service* Container::get_object(const std::string &object_path)
 	{
+		d->materialize(this, object_path);
 		auto find_result = d->object_path_lookup_table.find(object_path);
 		if (find_result == d->object_path_lookup_table.end()) {
 			std::string msg = "cannot get object because its object_path \"";
@@ -393,6 +600,7 @@ namespace saftbus {
 		if (object_path == "/saftbus") {
 			throw saftbus::Error(saftbus::Error::INVALID_ARGS, "cannot remove /saftbus");
 		}
+		d->materialize(this, object_path);
 		auto find_result = d->object_path_lookup_table.find(object_path);
 		if (find_result == d->object_path_lookup_table.end()) {
 			std::string msg = "cannot remove object \"";
@@ -439,6 +647,10 @@ namespace saftbus {
 
 	bool Container::remove_object(const std::string &object_path)
 	{
+		if (d->lazy_objects.erase(object_path)) {
+			// the Service object was never needed, there is nothing else to remove
+			return false;
+		}
 		removal_helper(object_path);
 		auto object_id = d->object_path_lookup_table[object_path];
 		d->object_path_lookup_table.erase(object_path);
@@ -449,6 +661,7 @@ namespace saftbus {
 
 	int Container::register_proxy(const std::string &object_path, const std::vector<std::string> interface_names, std::map<std::string, int> &interface_name2no_map, int client_fd, int signal_group_fd)
 	{
+		d->materialize(this, object_path);
 		auto find_result = d->object_path_lookup_table.find(object_path);
 		if (find_result != d->object_path_lookup_table.end()) {
 			unsigned saftbus_object_id = find_result->second;
@@ -488,7 +701,10 @@ namespace saftbus {
 			return false;
 		}
 		auto &service = find_result->second;
-		service->call(client_fd, received, send);
+		{
+			SAFTBUS_TRACE_SCOPE("Container::call_service", saftbus_object_id);
+			service->call(client_fd, received, send);
+		}
 
 		for (auto &s: d->removed_services) {
 			if (s->d->destruction_callback) {
@@ -510,6 +726,13 @@ namespace saftbus {
 		for(auto &service: d->objects) {
 			service.second->d->remove_signal_fd(fd);
 		}
+		auto backlog = Service::Impl::signal_backlogs.find(fd);
+		if (backlog != Service::Impl::signal_backlogs.end()) {
+			if (backlog->second.flushing) {
+				Loop::get_default().remove(backlog->second.io_source);
+			}
+			Service::Impl::signal_backlogs.erase(backlog);
+		}
 	}
 
 
@@ -544,6 +767,12 @@ namespace saftbus {
 				iter->second->d->owner = -1;
 			}
 		} 
+		// the fd may be reused by the next client
+		for (auto &object: d->objects) {
+			for (auto &function: object.second->d->call_statistics) {
+				function.second.client_calls.erase(fd);
+			}
+		}
 	}
 
 
@@ -609,6 +838,27 @@ namespace saftbus {
 			object_info.owner                                    = obj.second->d->owner;
 			object_info.has_destruction_callback                 = obj.second->d->destruction_callback?true:false;
 			object_info.destroy_if_owner_quits                   = obj.second->d->destroy_if_owner_quits;
+			for (auto &function: obj.second->d->call_statistics) {
+				auto &statistics = function.second;
+				SaftbusInfo::CallInfo call_info;
+				unsigned interface_no = function.first.first;
+				unsigned function_no  = function.first.second;
+				if (interface_no < obj.second->d->interface_names.size()) {
+					call_info.interface_name = obj.second->d->interface_names[interface_no];
+				}
+				call_info.function_name = obj.second->get_function_name(interface_no, function_no);
+				if (call_info.function_name.empty()) {
+					call_info.function_name = "#" + std::to_string(function_no);
+				}
+				call_info.calls          = statistics.calls;
+				call_info.total_ns       = statistics.total_ns;
+				call_info.max_ns         = statistics.max_ns;
+				call_info.bytes_received = statistics.bytes_received;
+				call_info.bytes_sent     = statistics.bytes_sent;
+				call_info.histogram.assign(statistics.histogram, statistics.histogram + SaftbusInfo::CallInfo::histogram_bins);
+				call_info.client_calls   = statistics.client_calls;
+				object_info.call_infos.push_back(call_info);
+			}
 			result.object_infos.push_back(object_info);
 		}
 		for (auto &client: d->connection->get_client_info()) {
@@ -618,15 +868,63 @@ namespace saftbus {
 			client_info.signal_fds = client.signal_fds;
 			result.client_infos.push_back(client_info);
 		}
+		for (auto &client: d->connection->get_client_info()) {
+			for (auto &signal_fd_use_count: client.signal_fds) {
+				SaftbusInfo::SignalGroupInfo signal_group_info;
+				auto &backlog = Service::Impl::signal_backlogs[signal_fd_use_count.first];
+				signal_group_info.signal_fd    = signal_fd_use_count.first;
+				signal_group_info.client_fd    = client.client_fd;
+				signal_group_info.policy       = backlog.policy;
+				signal_group_info.capacity     = backlog.capacity;
+				signal_group_info.depth        = backlog.queue.size();
+				signal_group_info.max_depth    = backlog.max_depth;
+				signal_group_info.delayed      = backlog.delayed;
+				signal_group_info.dropped      = backlog.dropped;
+				signal_group_info.disconnected = backlog.disconnected;
+				result.signal_group_infos.push_back(signal_group_info);
+			}
+		}
 		for (auto &name_loader: d->plugins) {
 			result.active_plugins.push_back(name_loader.first);
 		}
 		for (auto &additional: d->additional_info_callbacks) {
 			result.additional_info[additional.first] = additional.second();
 		}
+		if (d->lazy_objects.size()) {
+			std::ostringstream paths;
+			for (auto &lazy_object: d->lazy_objects) {
+				paths << lazy_object.first << std::endl;
+			}
+			result.additional_info["objects not yet created"] = paths.str();
+		}
 
 		return result;
 	}
 
+	void Container::set_signal_group_policy(int signal_group_fd, SlowConsumerPolicy policy, unsigned capacity) {
+		if (policy != SlowConsumerPolicy::DROP_NEWEST && policy != SlowConsumerPolicy::DROP_OLDEST && policy != SlowConsumerPolicy::DISCONNECT) {
+			throw saftbus::Error(saftbus::Error::INVALID_ARGS, "unknown slow consumer policy");
+		}
+		bool found = false;
+		for (auto &client: d->connection->get_client_info()) {
+			if (client.client_fd == get_calling_client_id() && client.signal_fds.find(signal_group_fd) != client.signal_fds.end()) {
+				found = true;
+			}
+		}
+		if (!found) {
+			throw saftbus::Error(saftbus::Error::INVALID_ARGS, "signal group does not belong to the calling client");
+		}
+		auto &backlog = Service::Impl::signal_backlogs[signal_group_fd];
+		backlog.policy   = policy;
+		backlog.capacity = capacity;
+		while (backlog.queue.size() > capacity) {
+			backlog.queue.pop_front();
+			++backlog.dropped;
+		}
+	}
+
+	std::string Container::get_trace() {
+		return Trace::dump_json();
+	}
 
 }
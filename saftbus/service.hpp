@@ -116,6 +116,12 @@ namespace saftbus {
 		///        It will be send back to the client that initiated the remote function call.
 		virtual void call(unsigned interface_no, unsigned function_no, int client_fd, Deserializer &received, Serializer &send) = 0;
 
+		/// @brief the name of a function, used in the call statistics (see Container::get_status)
+		///
+		/// Services generated by saftbus-gen override this function. The default returns an empty string,
+		/// in this case the function number is shown instead of the name.
+		virtual std::string get_function_name(unsigned interface_no, unsigned function_no);
+
 
 		/// @brief Send some serialized data to all clients (i.e. the SignalGroups connected to this Service).
 		///
@@ -169,6 +175,17 @@ namespace saftbus {
 		///         The object_id if the Service object was successfully inserted into the Container
 		unsigned create_object(const std::string &object_path, std::unique_ptr<Service> service);
 
+		/// @brief Insert a Service object that is only created when it is needed
+		///
+		/// If the environment variable SAFTBUS_LAZY_OBJECTS is set when the Container is created,
+		/// the factory is stored and called on the first register_proxy or get_object for object_path.
+		/// Otherwise the factory is called immediately and the result is inserted with create_object.
+		/// The driver object must remove object_path (remove_object) before the factory becomes invalid.
+		/// @param object_path the object path under which the Service object will be available to Proxy objects.
+		/// @param factory creates the Service object
+		/// @return false in case the object_path is already used by another Service object.
+		bool create_object_lazy(const std::string &object_path, std::function<std::unique_ptr<Service>()> factory);
+
 		Service* get_object(const std::string &object_path);
 
 		/// @brief this function can be used by a Service to destroy itself
@@ -233,6 +250,14 @@ namespace saftbus {
 
 		// @saftbus-export
 		SaftbusInfo get_status();
+
+		/// @brief the hot-path trace of all threads of saftbusd in Chrome trace event format (see Trace)
+		// @saftbus-export
+		std::string get_trace();
+
+		/// @brief set the slow consumer policy and backlog capacity of one signal fd (see SignalGroup::set_slow_consumer_policy)
+		// @saftbus-export
+		void set_signal_group_policy(int signal_group_fd, SlowConsumerPolicy policy, unsigned capacity);
 	};
 
 	/// @brief created by saftbus-gen from class Container and copied here
@@ -245,6 +270,7 @@ namespace saftbus {
 		Container_Service();
 		~Container_Service();
 		void call(unsigned interface_no, unsigned function_no, int client_fd, saftbus::Deserializer &received, saftbus::Serializer &send);
+		std::string get_function_name(unsigned interface_no, unsigned function_no);
 	};
 
 }
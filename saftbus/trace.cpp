@@ -0,0 +1,166 @@
+/*  Copyright (C) 2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#include "trace.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+
+namespace saftbus {
+
+	namespace {
+
+		// One ring per thread. Only the owning thread writes, any thread may read.
+		//
+		// The writer first announces the index it is about to overwrite (claimed), then writes
+		// the entry, then publishes it (written). A reader copies the entries below written and
+		// afterwards discards all copied entries that may have been overwritten in the meantime,
+		// i.e. all entries older than claimed-size. This is the sequence lock pattern with one
+		// sequence number per ring instead of one per entry.
+		struct Ring {
+			enum { size = 8192 }; // must be a power of 2
+			struct Entry {
+				std::atomic<const char*> name;
+				std::atomic<uint64_t>    time_ns;
+				std::atomic<int64_t>     arg;
+				std::atomic<char>        phase;
+			};
+			Entry entries[size];
+			std::atomic<uint64_t> claimed;
+			std::atomic<uint64_t> written;
+			long tid;
+			std::string thread_name;
+			Ring() : claimed(0), written(0) {
+				tid = syscall(SYS_gettid);
+				char name[16] = {0};
+				pthread_getname_np(pthread_self(), name, sizeof(name));
+				thread_name = name;
+			}
+		};
+
+		struct Copy {
+			const char *name;
+			uint64_t time_ns;
+			int64_t arg;
+			char phase;
+		};
+
+		// Rings are never deleted, the history of a thread remains available after the thread ended.
+		std::mutex         rings_mutex;
+		std::vector<Ring*> rings;
+		thread_local Ring *thread_ring = nullptr;
+
+		uint64_t now_ns() {
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+		}
+
+		void json_string(std::ostream &out, const std::string &str) {
+			out << '"';
+			for (auto c: str) {
+				if (c == '"' || c == '\\') out << '\\' << c;
+				else if ((unsigned char)c < 0x20) out << ' ';
+				else out << c;
+			}
+			out << '"';
+		}
+	}
+
+	void Trace::record(const char *name, char phase, int64_t arg)
+	{
+		Ring *ring = thread_ring;
+		if (ring == nullptr) {
+			ring = thread_ring = new Ring;
+			std::lock_guard<std::mutex> lock(rings_mutex);
+			rings.push_back(ring);
+		}
+		uint64_t index = ring->written.load(std::memory_order_relaxed);
+		ring->claimed.store(index + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		Ring::Entry &entry = ring->entries[index & (Ring::size-1)];
+		entry.name.store(name, std::memory_order_relaxed);
+		entry.time_ns.store(now_ns(), std::memory_order_relaxed);
+		entry.arg.store(arg, std::memory_order_relaxed);
+		entry.phase.store(phase, std::memory_order_relaxed);
+		ring->written.store(index + 1, std::memory_order_release);
+	}
+
+	std::string Trace::dump_json()
+	{
+		std::vector<Ring*> all_rings;
+		{
+			std::lock_guard<std::mutex> lock(rings_mutex);
+			all_rings = rings;
+		}
+		int pid = getpid();
+		std::ostringstream out;
+		out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+		bool first = true;
+		for (auto ring: all_rings) {
+			uint64_t end   = ring->written.load(std::memory_order_acquire);
+			uint64_t begin = end > Ring::size ? end - Ring::size : 0;
+			std::vector<Copy> copies;
+			copies.reserve(end - begin);
+			for (uint64_t index = begin; index < end; ++index) {
+				Ring::Entry &entry = ring->entries[index & (Ring::size-1)];
+				copies.push_back(Copy{entry.name.load(std::memory_order_relaxed),
+				                      entry.time_ns.load(std::memory_order_relaxed),
+				                      entry.arg.load(std::memory_order_relaxed),
+				                      entry.phase.load(std::memory_order_relaxed)});
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+			uint64_t claimed = ring->claimed.load(std::memory_order_relaxed);
+			uint64_t valid_begin = claimed > Ring::size ? claimed - Ring::size : 0;
+			if (valid_begin < begin) valid_begin = begin;
+
+			out << (first?"":",") << std::endl;
+			first = false;
+			out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << ring->tid << ",\"args\":{\"name\":";
+			json_string(out, ring->thread_name);
+			out << "}}";
+			for (uint64_t index = valid_begin; index < end; ++index) {
+				const Copy &copy = copies[index - begin];
+				out << "," << std::endl;
+				out << "{\"name\":";
+				json_string(out, copy.name);
+				out << ",\"ph\":\"" << copy.phase << "\""
+				    << ",\"ts\":" << copy.time_ns/1000 << "." << std::setw(3) << std::setfill('0') << copy.time_ns%1000
+				    << ",\"pid\":" << pid << ",\"tid\":" << ring->tid;
+				if (copy.phase == 'i') {
+					out << ",\"s\":\"t\"";
+				}
+				if (copy.arg >= 0) {
+					out << ",\"args\":{\"arg\":" << copy.arg << "}";
+				}
+				out << "}";
+			}
+		}
+		out << std::endl << "]}" << std::endl;
+		return out.str();
+	}
+
+}
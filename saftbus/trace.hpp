@@ -0,0 +1,70 @@
+/*  Copyright (C) 2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#ifndef SAFTBUS_TRACE_HPP_
+#define SAFTBUS_TRACE_HPP_
+
+#include <string>
+#include <cstdint>
+
+namespace saftbus {
+
+	/// @brief Timestamps of points on the hot path of saftbusd (MSI handling, signal emission, socket writes).
+	///
+	/// Every thread records into its own ring buffer of fixed size. Recording takes no lock and
+	/// does not allocate (except for the first record of a thread, which creates the ring).
+	/// When a ring is full, the oldest entries are overwritten, so the rings always hold the
+	/// most recent history of each thread.
+	///
+	/// The trace points are placed with the macros SAFTBUS_TRACE_SCOPE and SAFTBUS_TRACE_INSTANT.
+	/// They compile to nothing unless SAFTBUS_TRACE is defined to a non-zero value
+	/// (configure --enable-trace, which is the default). The trace can be obtained with
+	/// "saftbus-ctl --trace <file>" and viewed with chrome://tracing or https://ui.perfetto.dev
+	class Trace {
+	public:
+		/// @brief record one entry for the calling thread
+		/// @param name must be a string literal (only the pointer is stored)
+		/// @param phase 'B' (begin of a scope), 'E' (end of a scope), or 'i' (instant)
+		/// @param arg is shown in the trace viewer if it is not negative
+		static void record(const char *name, char phase, int64_t arg = -1);
+
+		/// @brief the content of all rings in Chrome trace event format (JSON)
+		static std::string dump_json();
+
+		/// @brief records 'B' when constructed and 'E' when destroyed
+		class Scope {
+			const char *name;
+		public:
+			Scope(const char *scope_name, int64_t arg = -1) : name(scope_name) { record(name, 'B', arg); }
+			~Scope() { record(name, 'E'); }
+		};
+	};
+
+}
+
+#if SAFTBUS_TRACE
+#define SAFTBUS_TRACE_CONCAT_(a, b) a##b
+#define SAFTBUS_TRACE_CONCAT(a, b) SAFTBUS_TRACE_CONCAT_(a, b)
+#define SAFTBUS_TRACE_SCOPE(name, ...) saftbus::Trace::Scope SAFTBUS_TRACE_CONCAT(saftbus_trace_scope_, __LINE__)(name, ##__VA_ARGS__)
+#define SAFTBUS_TRACE_INSTANT(name, ...) saftbus::Trace::record(name, 'i', ##__VA_ARGS__)
+#else
+#define SAFTBUS_TRACE_SCOPE(name, ...)
+#define SAFTBUS_TRACE_INSTANT(name, ...)
+#endif
+
+#endif
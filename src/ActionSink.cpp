@@ -49,7 +49,8 @@ ActionSink::ActionSink(ECA &eca_
 	eca(eca_), name(name_), channel(channel_), num(num_),
 	minOffset(-1000000000L),  maxOffset(1000000000L), signalRate(std::chrono::nanoseconds(100000000L)),
 	overflowCount(0), actionCount(0), lateCount(0), earlyCount(0), conflictCount(0), delayedCount(0),
-	container(container_)
+	container(container_),
+	async_guard(AsyncCycle::make_guard())
 {
 
 	overflowUpdate = actionUpdate = lateUpdate = earlyUpdate = conflictUpdate = delayedUpdate = std::chrono::steady_clock::now();
@@ -200,37 +201,37 @@ uint64_t ActionSink::getSignalRate() const
 
 uint64_t ActionSink::getOverflowCount() const
 {
-	updateOverflow();
+	countOverflow(readCount(ECA_CHANNEL_OVERFLOW_COUNT_GET));
 	return overflowCount;
 }
 
 uint64_t ActionSink::getActionCount() const
 {
-	updateAction();
+	countAction(readCount(ECA_CHANNEL_VALID_COUNT_GET));
 	return actionCount;
 }
 
 uint64_t ActionSink::getLateCount() const
 {
-	updateLate();
+	countLate(readError(ECA_LATE).count);
 	return lateCount;
 }
 
 uint64_t ActionSink::getEarlyCount() const
 {
-	updateEarly();
+	countEarly(readError(ECA_EARLY).count);
 	return earlyCount;
 }
 
 uint64_t ActionSink::getConflictCount() const
 {
-	updateConflict();
+	countConflict(readError(ECA_CONFLICT).count);
 	return conflictCount;
 }
 
 uint64_t ActionSink::getDelayedCount() const
 {
-	updateDelayed();
+	countDelayed(readError(ECA_DELAYED).count);
 	return delayedCount;
 }
 
@@ -366,20 +367,14 @@ void ActionSink::receiveMSI(uint8_t code)
 bool ActionSink::updateOverflow() const
 {
 	//DRIVER_LOG("start",-1,-1);
-	eb_data_t overflow;
-
-	etherbone::Cycle cycle;
-	cycle.open(eca.get_device());
+	AsyncCycle cycle(eca.get_device());
 	cycle.write(eca.get_base_address() + ECA_CHANNEL_SELECT_RW,          EB_DATA32, channel);
 	cycle.write(eca.get_base_address() + ECA_CHANNEL_NUM_SELECT_RW,      EB_DATA32, num);
 	// reading OVERFLOW_COUNT clears the count and rearms the MSI
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_OVERFLOW_COUNT_GET, EB_DATA32, &overflow);
-	cycle.close();
-
-	overflowCount += overflow;
-	OverflowCount(overflowCount);
-
-	overflowUpdate = std::chrono::steady_clock::now();
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_OVERFLOW_COUNT_GET, EB_DATA32);
+	cycle.submit(async_guard, [this](bool ok, const std::vector<eb_data_t> &overflow) {
+		if (ok) countOverflow(overflow[0]);
+	});
 	
 	//DRIVER_LOG("done",-1, -1);
 	return false;
@@ -389,68 +384,102 @@ bool ActionSink::updateAction() const
 {
 	// std::cout << "ActionSink::updateAction" << std::endl;
 	//DRIVER_LOGT("start",name.c_str(),-1,channel);
-	eb_data_t valid;
-
-	etherbone::Cycle cycle;
-	cycle.open(eca.get_device());
+	AsyncCycle cycle(eca.get_device());
 	cycle.write(eca.get_base_address() + ECA_CHANNEL_SELECT_RW,       EB_DATA32, channel);
 	cycle.write(eca.get_base_address() + ECA_CHANNEL_NUM_SELECT_RW,   EB_DATA32, num);
 	// reading VALID_COUNT clears the count and rearms the MSI
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_VALID_COUNT_GET, EB_DATA32, &valid);
-	cycle.close();
-
-	actionCount += valid;
-	ActionCount(actionCount);
-
-	actionUpdate = std::chrono::steady_clock::now();
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_VALID_COUNT_GET, EB_DATA32);
+	cycle.submit(async_guard, [this](bool ok, const std::vector<eb_data_t> &valid) {
+		if (ok) countAction(valid[0]);
+	});
 	//DRIVER_LOG("done",-1,channel);
 	return false;
 }
 
-ActionSink::Record ActionSink::fetchError(uint8_t code) const
+ActionSink::Record ActionSink::makeRecord(const std::vector<eb_data_t> &data)
 {
-	//DRIVER_LOG("start",-1,-1);
-	eb_data_t event_hi, event_lo, param_hi, param_lo, tag, tef,
-						deadline_hi, deadline_lo, executed_hi, executed_lo, failed;
+	// data: event_hi, event_lo, param_hi, param_lo, tag, tef, deadline_hi, deadline_lo, executed_hi, executed_lo, failed
+	ActionSink::Record out;
+	out.event    = uint64_t(data[0]) << 32 | data[1];
+	out.param    = uint64_t(data[2]) << 32 | data[3];
+	out.deadline = uint64_t(data[6]) << 32 | data[7];
+	out.executed = uint64_t(data[8]) << 32 | data[9];
+	out.count    = data[10];
+	return out;
+}
+
+eb_data_t ActionSink::readCount(eb_address_t count_reg) const
+{
+	eb_data_t count;
+
+	etherbone::Cycle cycle;
+	cycle.open(eca.get_device());
+	cycle.write(eca.get_base_address() + ECA_CHANNEL_SELECT_RW,     EB_DATA32, channel);
+	cycle.write(eca.get_base_address() + ECA_CHANNEL_NUM_SELECT_RW, EB_DATA32, num);
+	// reading the count clears it and rearms the MSI
+	cycle.read (eca.get_base_address() + count_reg,                 EB_DATA32, &count);
+	cycle.close();
+
+	return count;
+}
+
+ActionSink::Record ActionSink::readError(uint8_t code) const
+{
+	std::vector<eb_data_t> data(11);
 
 	etherbone::Cycle cycle;
 	cycle.open(eca.get_device());
 	cycle.write(eca.get_base_address() + ECA_CHANNEL_SELECT_RW,       EB_DATA32, channel);
 	cycle.write(eca.get_base_address() + ECA_CHANNEL_NUM_SELECT_RW,   EB_DATA32, num);
 	cycle.write(eca.get_base_address() + ECA_CHANNEL_CODE_SELECT_RW,  EB_DATA32, code);
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_EVENT_ID_HI_GET, EB_DATA32, &event_hi);
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_EVENT_ID_LO_GET, EB_DATA32, &event_lo);
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_PARAM_HI_GET,    EB_DATA32, &param_hi);
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_PARAM_LO_GET,    EB_DATA32, &param_lo);
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_TAG_GET,         EB_DATA32, &tag);
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_TEF_GET,         EB_DATA32, &tef);
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_DEADLINE_HI_GET, EB_DATA32, &deadline_hi);
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_DEADLINE_LO_GET, EB_DATA32, &deadline_lo);
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_EXECUTED_HI_GET, EB_DATA32, &executed_hi);
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_EXECUTED_LO_GET, EB_DATA32, &executed_lo);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_EVENT_ID_HI_GET, EB_DATA32, &data[0]);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_EVENT_ID_LO_GET, EB_DATA32, &data[1]);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_PARAM_HI_GET,    EB_DATA32, &data[2]);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_PARAM_LO_GET,    EB_DATA32, &data[3]);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_TAG_GET,         EB_DATA32, &data[4]);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_TEF_GET,         EB_DATA32, &data[5]);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_DEADLINE_HI_GET, EB_DATA32, &data[6]);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_DEADLINE_LO_GET, EB_DATA32, &data[7]);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_EXECUTED_HI_GET, EB_DATA32, &data[8]);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_EXECUTED_LO_GET, EB_DATA32, &data[9]);
 	// reading FAILED_COUNT clears the count, releases the record, and rearms the MSI
-	cycle.read (eca.get_base_address() + ECA_CHANNEL_FAILED_COUNT_GET, EB_DATA32, &failed);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_FAILED_COUNT_GET, EB_DATA32, &data[10]);
 	cycle.close();
 
-	ActionSink::Record out;
-	out.event    = uint64_t(event_hi)    << 32 | event_lo;
-	out.param    = uint64_t(param_hi)    << 32 | param_lo;
-	out.deadline = uint64_t(deadline_hi) << 32 | deadline_lo;
-	out.executed = uint64_t(executed_hi) << 32 | executed_lo;
-	out.count    = failed;
+	return makeRecord(data);
+}
 
-	//DRIVER_LOG("done",-1,failed);
-	return out;
+void ActionSink::fetchError(uint8_t code, std::function<void(const Record &record)> handler) const
+{
+	//DRIVER_LOG("start",-1,-1);
+	AsyncCycle cycle(eca.get_device());
+	cycle.write(eca.get_base_address() + ECA_CHANNEL_SELECT_RW,       EB_DATA32, channel);
+	cycle.write(eca.get_base_address() + ECA_CHANNEL_NUM_SELECT_RW,   EB_DATA32, num);
+	cycle.write(eca.get_base_address() + ECA_CHANNEL_CODE_SELECT_RW,  EB_DATA32, code);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_EVENT_ID_HI_GET, EB_DATA32);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_EVENT_ID_LO_GET, EB_DATA32);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_PARAM_HI_GET,    EB_DATA32);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_PARAM_LO_GET,    EB_DATA32);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_TAG_GET,         EB_DATA32);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_TEF_GET,         EB_DATA32);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_DEADLINE_HI_GET, EB_DATA32);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_DEADLINE_LO_GET, EB_DATA32);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_EXECUTED_HI_GET, EB_DATA32);
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_EXECUTED_LO_GET, EB_DATA32);
+	// reading FAILED_COUNT clears the count, releases the record, and rearms the MSI
+	cycle.read (eca.get_base_address() + ECA_CHANNEL_FAILED_COUNT_GET, EB_DATA32);
+	cycle.submit(async_guard, [handler](bool ok, const std::vector<eb_data_t> &data) {
+		if (ok) handler(makeRecord(data));
+	});
+	//DRIVER_LOG("done",-1,-1);
 }
 
 bool ActionSink::updateLate() const
 {
 	//DRIVER_LOG("start",-1, -1);
-	Record r = fetchError(ECA_LATE);
-	lateCount += r.count;
-	LateCount(lateCount);
-
-	lateUpdate = std::chrono::steady_clock::now();
+	fetchError(ECA_LATE, [this](const Record &r) {
+		countLate(r.count);
+	});
 	//DRIVER_LOG("done",-1, -1);
 	return false;
 }
@@ -458,11 +487,9 @@ bool ActionSink::updateLate() const
 bool ActionSink::updateEarly() const
 {
 	//DRIVER_LOG("start",-1, -1);
-	Record r = fetchError(ECA_EARLY);
-	earlyCount += r.count;
-	EarlyCount(earlyCount);
-
-	earlyUpdate = std::chrono::steady_clock::now();
+	fetchError(ECA_EARLY, [this](const Record &r) {
+		countEarly(r.count);
+	});
 	//DRIVER_LOG("done",-1, -1);
 	return false;
 }
@@ -470,11 +497,9 @@ bool ActionSink::updateEarly() const
 bool ActionSink::updateConflict() const
 {
 	//DRIVER_LOG("start",-1, -1);
-	Record r = fetchError(ECA_CONFLICT);
-	conflictCount += r.count;
-	ConflictCount(conflictCount);
-
-	conflictUpdate = std::chrono::steady_clock::now();
+	fetchError(ECA_CONFLICT, [this](const Record &r) {
+		countConflict(r.count);
+	});
 	//DRIVER_LOG("done",-1, -1);
 	return false;
 }
@@ -482,13 +507,59 @@ bool ActionSink::updateConflict() const
 bool ActionSink::updateDelayed() const
 {
 	//DRIVER_LOG("start",-1, -1);
-	Record r = fetchError(ECA_DELAYED);
-	delayedCount += r.count;
+	fetchError(ECA_DELAYED, [this](const Record &r) {
+		countDelayed(r.count);
+	});
+	//DRIVER_LOG("done",-1, -1);
+	return false;
+}
+
+void ActionSink::countOverflow(uint64_t n) const
+{
+	overflowCount += n;
+	OverflowCount(overflowCount);
+
+	overflowUpdate = std::chrono::steady_clock::now();
+}
+
+void ActionSink::countAction(uint64_t n) const
+{
+	actionCount += n;
+	ActionCount(actionCount);
+
+	actionUpdate = std::chrono::steady_clock::now();
+}
+
+void ActionSink::countLate(uint64_t n) const
+{
+	lateCount += n;
+	LateCount(lateCount);
+
+	lateUpdate = std::chrono::steady_clock::now();
+}
+
+void ActionSink::countEarly(uint64_t n) const
+{
+	earlyCount += n;
+	EarlyCount(earlyCount);
+
+	earlyUpdate = std::chrono::steady_clock::now();
+}
+
+void ActionSink::countConflict(uint64_t n) const
+{
+	conflictCount += n;
+	ConflictCount(conflictCount);
+
+	conflictUpdate = std::chrono::steady_clock::now();
+}
+
+void ActionSink::countDelayed(uint64_t n) const
+{
+	delayedCount += n;
 	DelayedCount(delayedCount);
 
 	delayedUpdate = std::chrono::steady_clock::now();
-	//DRIVER_LOG("done",-1, -1);
-	return false;
 }
 
 void ActionSink::removeCondition(Condition *condition)
@@ -27,6 +27,7 @@
 #include <chrono>
 #include <vector>
 #include <string>
+#include <functional>
 
 #include <saftbus/loop.hpp>
 #include <saftbus/service.hpp>
@@ -39,6 +40,7 @@
 #include "Condition.hpp"
 #include "Owned.hpp"
 #include "ECA.hpp"
+#include "eb-async-cycle.hpp"
 
 namespace saftlib {
 
@@ -552,8 +554,19 @@ class ActionSink : public Owned
 			uint64_t executed;
 			uint64_t count;
 		};
-		Record fetchError(uint8_t code) const;
-		
+		static Record makeRecord(const std::vector<eb_data_t> &data);
+		// the getters read the counters synchronously, the MSI handlers with AsyncCycles
+		eb_data_t readCount(eb_address_t count_reg) const;
+		Record readError(uint8_t code) const;
+		void fetchError(uint8_t code, std::function<void(const Record &record)> handler) const;
+
+		void countOverflow(uint64_t n) const;
+		void countAction(uint64_t n) const;
+		void countLate(uint64_t n) const;
+		void countEarly(uint64_t n) const;
+		void countConflict(uint64_t n) const;
+		void countDelayed(uint64_t n) const;
+
 		bool updateOverflow() const;
 		bool updateAction() const;
 		bool updateLate() const;
@@ -566,6 +579,10 @@ class ActionSink : public Owned
 		
 
 		saftbus::Container *container;
+
+	protected:
+		// counters and queues are read with AsyncCycles, their callbacks are dropped when the ActionSink is destroyed
+		AsyncCycle::Guard async_guard;
 };
 
 }
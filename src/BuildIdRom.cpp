@@ -27,9 +27,6 @@
 
 namespace saftlib {
 
-#define BUILD_ID_ROM_VENDOR_ID 0x00000651
-#define BUILD_ID_ROM_DEVICE_ID 0x2d39fa8b
-
 BuildIdRom::BuildIdRom(etherbone::Device &device) 
 	: SdbDevice(device, BUILD_ID_ROM_VENDOR_ID, BUILD_ID_ROM_DEVICE_ID)
 {
@@ -36,6 +36,9 @@
 
 namespace saftlib {
 
+#define BUILD_ID_ROM_VENDOR_ID 0x00000651
+#define BUILD_ID_ROM_DEVICE_ID 0x2d39fa8b
+
 /// @brief Representation of the SDB device with build id information.
 /// It can be used to obtain strings with gateware info and version numbers.
 class BuildIdRom : public SdbDevice {
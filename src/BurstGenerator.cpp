@@ -1,6 +1,7 @@
 #define ETHERBONE_THROWS 1
 
 #include <unistd.h>
+#include <algorithm>
 
 //#include "RegisteredObject.h"
 #include "BurstGenerator.hpp"
@@ -10,6 +11,7 @@
 // #include <Output.hpp>
 #include <TimingReceiver.hpp>
 #include <SAFTd.hpp>
+#include <saftbus/error.hpp>
 
 using namespace etherbone;
 
@@ -21,14 +23,24 @@ namespace saftlib {
     , saftd(saft_daemon)
     , tr(timing_receiver)
     , device(tr->OpenDevice::get_device())
+    , bg_slot(0)
+    , response(0)
+    , found_bg_fw(false)
+    , ram_base(0)
+    , detect_cpu(0)
+    , detect_state(DETECT_RESET)
+    , detect_timeout(0)
+    , detect_fw_id_backup(0)
+    , instruction_active(false)
   {
     Mailbox *mbox = static_cast<Mailbox*>(tr); 
     my_msi = saftd->request_irq(*mbox, std::bind(&BurstGenerator::msi_handler,this, std::placeholders::_1));
     // For some reason it doesn't work if slot index is 0 (maybe slot index 0 has a special meaning in the firmware).
-    // Fix it simply by reconfiguring the mailbox if the assigned slot index was 0.
-    do { 
-      my_slot = mbox->ConfigureSlot(my_msi->address());
-    } while (my_slot->getIndex() == 0);
+    // Therefore slot index 0 is excluded from the search.
+    my_slot = mbox->ConfigureSlot(my_msi->address(), 1);
+    if (!my_slot) {
+      throw saftbus::Error(saftbus::Error::FAILED, "BurstGenerator: no free mailbox slot");
+    }
 
     std::cerr << "BurstGenerator: subscribed mailbox" << std::hex <<
       " slot: " << my_slot->getIndex() << " addr: " << my_slot->getAddress() <<
@@ -36,220 +48,275 @@ namespace saftlib {
 
     std::cerr << "BurstGenerator: detecting the burst generator" << std::endl;
 
-    eb_data_t bg_id = 0;
-    int cpu_idx = -1;
+    // Resetting the LM32 cores and waiting for the firmware ID takes up to 2 seconds per core.
+    // This is done step by step from the event loop, instructions are queued until it is finished.
+    detect_source = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
+      std::bind(&BurstGenerator::detectFirmware, this), 
+      std::chrono::milliseconds(100), std::chrono::milliseconds(0));
+  }
+
+  BurstGenerator::~BurstGenerator()
+  {
+    saftbus::Loop::get_default().remove(detect_source);
+    saftbus::Loop::get_default().remove(instruction_timeout);
+    // write the invalid slot number to a reserved location in the shared memory
+    if (ram_base != 0) 
+      device.write(ram_base + SHM_MB_SLOT_HOST, EB_DATA32, MB_SLOT_CFG_FREE);
+  }
+
 
-    for (unsigned i = 0; i < tr->LM32Cluster::getCpuCount(); ++i)
+  std::string BurstGenerator::getObjectPath() 
+  {
+    return objectPath;
+  }
+
+  std::map<std::string, std::map<std::string, std::string> > BurstGenerator::getObjects() {
+    std::map<std::string, std::map<std::string, std::string> > result;
+    result["BurstGenerator"]["bg_firmware"] = objectPath;
+    return result;
+  }
+
+  bool BurstGenerator::detectFirmware()
+  {
+    try
     {
-      ram_base = timing_receiver->LM32Cluster::dpram_lm32_adr_first[i];
+      if (detect_state == DETECT_RESET)
+      {
+        if (detect_cpu >= tr->LM32Cluster::getCpuCount())
+        {
+          finishDetection();
+          return false;
+        }
+        ram_base = tr->LM32Cluster::dpram_lm32_adr_first[detect_cpu];
 
-      // write own slot number to a reserved location (shared memory)
-      device.write(ram_base + SHM_MB_SLOT_HOST, EB_DATA32, (eb_data_t)my_slot->getIndex());
+        // write own slot number to a reserved location (shared memory)
+        device.write(ram_base + SHM_MB_SLOT_HOST, EB_DATA32, (eb_data_t)my_slot->getIndex());
 
+        std::cerr << "BurstGenerator: resetting lm32 core." << detect_cpu << std::endl;
 
-      std::cerr << "BurstGenerator: resetting lm32 core." << i << std::endl;
+        // clear a buffer for the FW ID (in the shared memory) before reset
+        device.read(ram_base + SHM_FW_ID, EB_DATA32, &detect_fw_id_backup);     // back up buffer value
+        device.write(ram_base + SHM_FW_ID, EB_DATA32, 0);
 
-      // clear a buffer for the FW ID (in the shared memory) before reset
-      eb_data_t data;
-      device.read(ram_base + SHM_FW_ID, EB_DATA32, &data);     // back up buffer value
-      device.write(ram_base + SHM_FW_ID, EB_DATA32, 0);
-
-      // use the first reset controller (register offsets: SET = +0x8, CLR = +0xc)
-      tr->Reset::CpuHalt(i);
-      usleep(10);
-      tr->Reset::CpuReset(i);
-
-      // read the buffer for the FW ID until wait time expires (2 seconds)
-      int timeout = 20;
-      while ((static_cast<uint32_t>(bg_id) != BG_FW_ID) && (timeout != 0)) {
-        usleep(100000);
-        --timeout;
-        device.read(ram_base + SHM_FW_ID, EB_DATA32, &bg_id);
-      }
+        // use the first reset controller (register offsets: SET = +0x8, CLR = +0xc)
+        // the core must see the halt for a few clock cycles before it is released again
+        tr->Reset::CpuHalt(detect_cpu);
+        usleep(10);
+        tr->Reset::CpuReset(detect_cpu);
 
-      std::cerr << "BurstGenerator: LM32 reset complete." << std::endl;
+        // read the buffer for the FW ID until wait time expires (2 seconds)
+        detect_timeout = 20;
+        detect_state = DETECT_WAIT_ID;
+        return true;
+      }
 
-      if (static_cast<uint32_t>(bg_id) != BG_FW_ID)
+      // DETECT_WAIT_ID
+      eb_data_t bg_id = 0;
+      device.read(ram_base + SHM_FW_ID, EB_DATA32, &bg_id);
+      if (static_cast<uint32_t>(bg_id) != BG_FW_ID && --detect_timeout > 0)
       {
-        device.write(ram_base + SHM_FW_ID, EB_DATA32, data);   // restore the buffer value
-        continue;
+        return true; // try again in 100 ms
       }
 
-      // get a mailbox slot subscribed by the burst generator
-      device.read(ram_base + SHM_MB_SLOT, EB_DATA32, &data);
-      if (data < 0 || data >= MB_SLOT_RANGE)
+      std::cerr << "BurstGenerator: LM32 reset complete." << std::endl;
+      detect_state = DETECT_RESET;
+
+      if (static_cast<uint32_t>(bg_id) != BG_FW_ID || !setupFirmware())
       {
-        continue;
-      }
-      bg_slot = data;
-      cpu_idx = i;
-
-      // get the common buffer addresses
-      unsigned offset = SHM_COMMON_BEGIN;
-      for (unsigned j = 0; j < SHM_BUF_IDX::CMD_ARGS; ++j) {
-        device.read(ram_base + offset, EB_DATA32, &data);
-        shm_buffer.push_back(data);
-        offset += 4;
+        if (static_cast<uint32_t>(bg_id) != BG_FW_ID)
+          device.write(ram_base + SHM_FW_ID, EB_DATA32, detect_fw_id_backup);   // restore the buffer value
+        ++detect_cpu;
+        return true; // next cpu
       }
 
-      shm_buffer.push_back(ram_base + SHM_CMD_ARGS);
+      std::cerr << "BurstGenerator: the burst generator id: " << bg_id << std::endl;
+      found_bg_fw = true;
+      finishDetection();
+      return false;
+    }
+    catch (etherbone::exception_t e)
+    {
+      std::cerr << "BurstGenerator: firmware detection failed in " << e.method << " with status: " << e.status << std::endl;
+      finishDetection();
+      return false;
+    }
+  }
 
-      // check the section borders in shared memory (common-lib vs. app)
-      // notice: if common-lib section overlaps with app-specific section, then control will not reach here!
-      if (shm_buffer.at(SHM_BUF_IDX::COMMON_END) > (ram_base + SHM_BASE)) {
-        std::cerr << "BurstGenerator: failure in shared memory layout (common-lib overlaps app-spec section): " <<
-          std::hex << shm_buffer.at(SHM_BUF_IDX::COMMON_END) << " > " <<
-          std::hex << (ram_base + SHM_BASE) << std::endl;
-        shm_buffer.clear();
-        continue;
-      }
+  bool BurstGenerator::setupFirmware()
+  {
+    // get a mailbox slot subscribed by the burst generator
+    eb_data_t data;
+    device.read(ram_base + SHM_MB_SLOT, EB_DATA32, &data);
+    if (data < 0 || data >= MB_SLOT_RANGE)
+    {
+      return false;
+    }
+    bg_slot = data;
 
-      std::cerr << "BurstGenerator: LM32 ram base = 0x" << std::hex << ram_base <<
-        ", my mailbox slot = " << my_slot->getIndex() <<
-        " is stored at 0x" << std::hex << (uint32_t)(ram_base + SHM_MB_SLOT_HOST) << " in the shared memory for LM32."  << std::endl;
+    // get the common buffer addresses
+    for (auto address: readBlock(ram_base + SHM_COMMON_BEGIN, SHM_BUF_IDX::CMD_ARGS)) {
+      shm_buffer.push_back(address);
+    }
 
-      std::cerr << "BurstGenerator: LM32 COMMON_BEGIN = 0x" << std::hex << shm_buffer.at(SHM_BUF_IDX::COMMON_BEGIN) <<
-        ", COMMON_END = 0x" << std::hex << shm_buffer.at(SHM_BUF_IDX::COMMON_END) <<
-        ", COMMON_CMD = 0x" << std::hex << shm_buffer.at(SHM_BUF_IDX::COMMON_CMD) <<
-        ", COMMON_STATE = 0x" << std::hex << shm_buffer.at(SHM_BUF_IDX::COMMON_STATE) <<
-        ", CMD_ARGS at 0x" << std::hex << shm_buffer.at(SHM_BUF_IDX::CMD_ARGS) << std::endl;
+    shm_buffer.push_back(ram_base + SHM_CMD_ARGS);
 
-      std::cerr << "BurstGenerator: firmware is running." << std::endl;
-      break;
+    // check the section borders in shared memory (common-lib vs. app)
+    // notice: if common-lib section overlaps with app-specific section, then control will not reach here!
+    if (shm_buffer.at(SHM_BUF_IDX::COMMON_END) > (ram_base + SHM_BASE)) {
+      std::cerr << "BurstGenerator: failure in shared memory layout (common-lib overlaps app-spec section): " <<
+        std::hex << shm_buffer.at(SHM_BUF_IDX::COMMON_END) << " > " <<
+        std::hex << (ram_base + SHM_BASE) << std::endl;
+      shm_buffer.clear();
+      return false;
     }
 
-    if (shm_buffer.empty())
-      std::cerr << "BurstGenerator: firmware is not found or communication failed!" << std::endl;
+    std::cerr << "BurstGenerator: LM32 ram base = 0x" << std::hex << ram_base <<
+      ", my mailbox slot = " << my_slot->getIndex() <<
+      " is stored at 0x" << std::hex << (uint32_t)(ram_base + SHM_MB_SLOT_HOST) << " in the shared memory for LM32."  << std::endl;
 
-    std::cerr << "BurstGenerator: the burst generator id: " << bg_id << std::endl;
-    std::cerr << "BurstGenerator: bg mailbox addr = " << bg_slot << ", lm32 cpu index = " << cpu_idx <<
-      ", ram base = 0x" << std::hex << ram_base << std::endl;
+    std::cerr << "BurstGenerator: LM32 COMMON_BEGIN = 0x" << std::hex << shm_buffer.at(SHM_BUF_IDX::COMMON_BEGIN) <<
+      ", COMMON_END = 0x" << std::hex << shm_buffer.at(SHM_BUF_IDX::COMMON_END) <<
+      ", COMMON_CMD = 0x" << std::hex << shm_buffer.at(SHM_BUF_IDX::COMMON_CMD) <<
+      ", COMMON_STATE = 0x" << std::hex << shm_buffer.at(SHM_BUF_IDX::COMMON_STATE) <<
+      ", CMD_ARGS at 0x" << std::hex << shm_buffer.at(SHM_BUF_IDX::CMD_ARGS) << std::endl;
 
+    std::cerr << "BurstGenerator: firmware is running." << std::endl;
+    return true;
   }
 
-  BurstGenerator::~BurstGenerator()
+  void BurstGenerator::finishDetection()
   {
-    // write the invalid slot number to a reserved location in the shared memory
-    device.write(ram_base + SHM_MB_SLOT_HOST, EB_DATA32, MB_SLOT_CFG_FREE);
-  }
+    detect_state = DETECT_DONE;
 
+    if (!found_bg_fw)
+    {
+      std::cerr << "BurstGenerator: firmware is not found or communication failed!" << std::endl;
+      if (!instructions.empty())
+        std::cerr << "BurstGenerator: dropping " << std::dec << instructions.size() << " queued instructions" << std::endl;
+      instructions.clear();
+      return;
+    }
 
-  std::string BurstGenerator::getObjectPath() 
-  {
-    return objectPath;
-  }
+    std::cerr << "BurstGenerator: bg mailbox addr = " << bg_slot << ", lm32 cpu index = " << detect_cpu <<
+      ", ram base = 0x" << std::hex << ram_base << std::endl;
 
-  std::map<std::string, std::map<std::string, std::string> > BurstGenerator::getObjects() {
-    std::map<std::string, std::map<std::string, std::string> > result;
-    result["BurstGenerator"]["bg_firmware"] = objectPath;
-    return result;
+    // instructions that were queued during detection
+    sendInstruction();
   }
 
-  bool BurstGenerator::firmwareRunning(uint32_t id)
+  int32_t BurstGenerator::instruct(uint32_t code, const std::vector< uint32_t >& args)
   {
-    if (ram_base == 0)
-      return false;
+    int32_t failed = -20;
 
-    if (bg_slot == 0)
-      return false;
+    if (detect_state == DETECT_DONE && (!found_bg_fw || bg_slot == 0))
+      return failed;
 
-    // send an user command to get the firmware ID (wait 100 ms for the firmware response)
-    int timeout = 10;
-    eb_data_t data = 0;
+    instructions.push_back(Instruction{code, args});
+    if (detect_state == DETECT_DONE && !instruction_active && instructions.size() == 1)
+    {
+      // the instruction is sent right away, report a failure to the caller
+      try
+      {
+        dispatchInstruction();
+      }
+      catch (etherbone::exception_t e)
+      {
+        std::cerr << "BurstGenerator: method call " << e.method << " failed with status: " << e.status << std::endl;
+        instructions.pop_front();
+        return e.status;
+      }
+    }
 
-    device.write(shm_buffer.at(SHM_BUF_IDX::CMD_ARGS), EB_DATA32, data);
-    device.write(shm_buffer.at(SHM_BUF_IDX::COMMON_CMD), EB_DATA32, CMD_LS_FW_ID);
+    std::cerr << "BurstGenerator: method call instruct(0x" << std::hex << code << std::dec << ") succeeded." << std::endl;
+    return EB_OK;
+  }
 
-    while (( data == 0) || (timeout != 0)) {
-      usleep(10000);
-      --timeout;
-      device.read(shm_buffer.at(SHM_BUF_IDX::CMD_ARGS), EB_DATA32, &data);
-    }
+  uint32_t BurstGenerator::getPendingInstructions() const
+  {
+    return instructions.size();
+  }
 
-    return (id == (uint32_t)data);
+  void BurstGenerator::sendInstruction()
+  {
+    while (!instruction_active && !instructions.empty())
+    {
+      try
+      {
+        dispatchInstruction();
+      }
+      catch (etherbone::exception_t e)
+      {
+        std::cerr << "BurstGenerator: instruction 0x" << std::hex << instructions.front().code << std::dec << " failed in " << e.method << " with status: " << e.status << std::endl;
+        instructions.pop_front();
+      }
+    }
   }
 
-  int32_t BurstGenerator::instruct(uint32_t code, const std::vector< uint32_t >& args)
+  void BurstGenerator::dispatchInstruction()
   {
-    int32_t failed = -20;
+    const Instruction &instruction = instructions.front();
 
-    if (ram_base == 0)
-      return failed;
+    // keep the results of the previous instruction, the arguments will overwrite them
+    last_result = readBlock(shm_buffer.at(SHM_BUF_IDX::CMD_ARGS), N_BURST_INFO);
 
-    if (bg_slot == 0)
-      return failed;
+    // write the instruction arguments into the shared memory
+    etherbone::Cycle cycle;
+    cycle.open(device);
 
-    try
-    {
-      // write the instruction arguments into the shared memory
-      etherbone::Cycle cycle;
-      cycle.open(device);
+    cycle.write(shm_buffer.at(SHM_BUF_IDX::COMMON_CMD), EB_DATA32, 0); // clear cmd register
 
-      cycle.write(shm_buffer.at(SHM_BUF_IDX::COMMON_CMD), EB_DATA32, 0); // clear cmd register
+    for (uint32_t i = 0; i < instruction.args.size(); ++i)
+      cycle.write(shm_buffer.at(SHM_BUF_IDX::CMD_ARGS) + (i << 2), EB_DATA32, instruction.args.at(i));
 
-      for (uint32_t i = 0; i < args.size(); ++i)
-        cycle.write(shm_buffer.at(SHM_BUF_IDX::CMD_ARGS) + (i << 2), EB_DATA32, args.at(i));
+    cycle.close();
 
-      cycle.close();
+    // send the instruction code to LM32
+    device.write(shm_buffer.at(SHM_BUF_IDX::COMMON_CMD), EB_DATA32, instruction.code);
 
-      // send the instruction code to LM32
-      device.write(shm_buffer.at(SHM_BUF_IDX::COMMON_CMD), EB_DATA32, code);
+    // response keeps the last value reported by msi_handler, 
+    // it is not cleared here because this may run right after sigInstComplete of the previous instruction
+    instruction_active = true;
 
-      // reset response (it must be updated with non-zero value by msi_handler)
-      response = 0;
+    // the firmware checks its command buffer every second
+    instruction_timeout = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
+      std::bind(&BurstGenerator::instructionTimeout, this), 
+      std::chrono::milliseconds(3000));
+  }
 
-      std::cerr << "BurstGenerator: method call instruct(0x" << std::hex << code << std::dec << ") succeeded." << std::endl;
-      return EB_OK;
-    }
-    catch (etherbone::exception_t e)
-    {
-      std::cerr << "BurstGenerator: method call " << e.method << " failed with status: " << e.status << std::endl;
-      return e.status;
-    }
+  void BurstGenerator::completeInstruction()
+  {
+    saftbus::Loop::get_default().remove(instruction_timeout);
+    instruction_active = false;
+    instructions.pop_front();
+    sendInstruction();
+  }
+
+  bool BurstGenerator::instructionTimeout()
+  {
+    std::cerr << "BurstGenerator: no response for instruction 0x" << std::hex << instructions.front().code << std::dec << std::endl;
+    instruction_active = false;
+    instructions.pop_front();
+    sendInstruction();
+    return false;
   }
 
   std::vector< uint32_t > BurstGenerator::readBurstInfo(uint32_t id)
   {
     std::vector<uint32_t> info;
 
-    if (ram_base == 0)
+    if (!found_bg_fw)
       return info;
 
     try
     {
       // common-libs deletes the command buffer in the shared memory
-      eb_data_t data;
-
-      // read burst info from the shared memory
-      /*TODO: cycle read failed! Find out the reason!
-      Cycle cycle;
-      cycle.open(device);
-
-      for (int i = 0; i < N_BURST_INFO; ++i)
-      {
-        cycle.read(ram_base + SHM_CMD_ARGS + (i << 2), EB_DATA32, &data);
-        std::cerr << ' ' << static_cast<uint32_t>(data) << std::endl;
-        info.push_back(static_cast<uint32_t>(data));
-      }
-
-      cycle.close();
-
-      info.clear();*/
-
       if (id == 0)
       {
-        device.read(shm_buffer.at(SHM_BUF_IDX::CMD_ARGS), EB_DATA32, &data); // created bursts
-        info.push_back(static_cast<uint32_t>(data));
-        device.read(shm_buffer.at(SHM_BUF_IDX::CMD_ARGS) + 4, EB_DATA32, &data); // cycled bursts
-        info.push_back(static_cast<uint32_t>(data));
+        info = readCmdArgs(2); // created bursts, cycled bursts
       }
       else if (id <= N_BURSTS)
       {
-        for (int i = 0; i < N_BURST_INFO; ++i)
-        {
-          device.read(shm_buffer.at(SHM_BUF_IDX::CMD_ARGS) + (i << 2), EB_DATA32, &data);
-          info.push_back(static_cast<uint32_t>(data));
-        }
+        info = readCmdArgs(N_BURST_INFO);
       }
 
       std::cerr << "BurstGenerator: method call readBurstInfo(" << info.size() << ") succeeded."<< std::endl;
@@ -266,19 +333,13 @@ namespace saftlib {
   {
     std::vector<uint32_t> content;
 
-    if (ram_base == 0)
+    if (!found_bg_fw)
       return std::vector<uint32_t>();
 
     try
     {
-      eb_data_t data;
-
       // read the shared memory
-      for (unsigned int i = 0; i < size; ++i)
-      {
-        device.read(shm_buffer.at(SHM_BUF_IDX::CMD_ARGS) + (i << 2), EB_DATA32, &data);
-        content.push_back(static_cast<uint32_t>(data));
-      }
+      content = readCmdArgs(size);
 
       std::cerr << "BurstGenerator: method call readSharedBuffer(" << content.size() << ") succeeded." << std::endl;
 
@@ -291,9 +352,38 @@ namespace saftlib {
     }
   }
 
+  std::vector< uint32_t > BurstGenerator::readBlock(eb_address_t address, unsigned count)
+  {
+    // The results of a cycle read are only valid after cycle.close(),
+    // therefore each word needs its own location in the buffer.
+    std::vector<eb_data_t> buffer(count);
+
+    etherbone::Cycle cycle;
+    cycle.open(device);
+    for (unsigned i = 0; i < count; ++i)
+      cycle.read(address + (i << 2), EB_DATA32, &buffer[i]);
+    cycle.close();
+
+    return std::vector<uint32_t>(buffer.begin(), buffer.end());
+  }
+
+  std::vector< uint32_t > BurstGenerator::readCmdArgs(unsigned count)
+  {
+    if (!instruction_active)
+      return readBlock(shm_buffer.at(SHM_BUF_IDX::CMD_ARGS), count);
+
+    // the buffer contains the arguments of the active instruction, use the results of the previous one
+    std::vector<uint32_t> result(last_result.begin(), last_result.begin() + std::min<std::size_t>(count, last_result.size()));
+    if (count > result.size()) {
+      std::vector<uint32_t> rest = readBlock(shm_buffer.at(SHM_BUF_IDX::CMD_ARGS) + (result.size() << 2), count - result.size());
+      result.insert(result.end(), rest.begin(), rest.end());
+    }
+    return result;
+  }
+
   uint32_t BurstGenerator::readState()
   {
-    if (ram_base == 0)
+    if (!found_bg_fw)
       return ((uint32_t)-1);
 
     try
@@ -327,6 +417,9 @@ namespace saftlib {
       response = (uint32_t)msg;
       sigInstComplete(response);
       std::cerr << "BurstGenerator: signal sigInstComplete(" << response << ") emitted." << std::endl;
+      // lower 16 bits are the instruction code
+      if (instruction_active && (response & 0xFFFF) == instructions.front().code)
+        completeInstruction();
     }
   }
 
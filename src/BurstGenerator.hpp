@@ -8,10 +8,12 @@
 #include <Mailbox.hpp>
 
 #include <saftbus/service.hpp> // for saftbus::Container
+#include <saftbus/loop.hpp>
 
 #include <sigc++/sigc++.h>
 
 #include <memory>
+#include <deque>
 
 namespace saftlib {
 
@@ -36,13 +38,24 @@ namespace saftlib {
       ///
       /// It is a common method to communicate with the burst generator.
       /// The method contains an instruction code and corresponding arguments.
+      /// Instructions are queued and sent to the LM32 one after the other,
+      /// each as soon as the previous one was completed (sigInstComplete) 
+      /// or timed out. Instructions given while the firmware is still being
+      /// detected are sent once it was found.
       /// @param code   User instruction code for LM32
       /// @param args   Instruction arguments (vector of u32 integers)
-      /// @param result Return result. 0 on success.
+      /// @param result Return result. 0 on success (instruction was queued), 
+      ///               the etherbone status if sending the instruction right away failed.
+      ///               Failures of instructions sent later from the queue are only logged.
       ///  
       // @saftbus-export
       int32_t instruct(uint32_t code, const std::vector< uint32_t >& args);
 
+      /// @brief Number of instructions that are queued or waiting for completion.
+      ///
+      // @saftbus-export
+      uint32_t getPendingInstructions() const;
+
       /// @brief Get burst info.
       ///
       /// The info includes the type and index of IO port, IDs of trigger and toggling events.
@@ -68,7 +81,10 @@ namespace saftlib {
       uint32_t readState();
 
 
-      /// @brief The burst generator response sent via mailbox.
+      /// @brief The last burst generator response sent via mailbox.
+      ///
+      /// Instructions are queued, the value may already belong to a later instruction.
+      /// Use the argument of sigInstComplete to get the response of a given instruction.
       /// @param code User instruction code
       // @saftbus-export
       uint32_t getResponse() const;
@@ -82,7 +98,15 @@ namespace saftlib {
       sigc::signal<void, uint32_t> sigInstComplete;
 
     protected:
-      bool firmwareRunning(uint32_t id);
+      bool detectFirmware();  // TimeoutSource callback, one step of the firmware detection per call
+      bool setupFirmware();   // read firmware settings after the firmware ID was found
+      void finishDetection();
+      void sendInstruction(); // send the next queued instruction if none is active
+      void dispatchInstruction(); // send the front instruction, throws etherbone::exception_t
+      void completeInstruction();
+      bool instructionTimeout();
+      std::vector< uint32_t > readBlock(eb_address_t address, unsigned count); // one etherbone cycle
+      std::vector< uint32_t > readCmdArgs(unsigned count);
       void msi_handler(eb_data_t msg);
 
       std::string                objectPath;
@@ -103,6 +127,24 @@ namespace saftlib {
       eb_address_t               ram_base;      // start of lm32 user ram
       std::vector<eb_address_t>  shm_buffer;    // app specific buffers in shared memory (for embedded lm32 communication)
 
+      // firmware detection state
+      enum DetectState { DETECT_RESET, DETECT_WAIT_ID, DETECT_DONE };
+      unsigned                   detect_cpu;    // index of the lm32 core being checked
+      DetectState                detect_state;
+      int                        detect_timeout;
+      eb_data_t                  detect_fw_id_backup;
+      saftbus::SourceHandle      detect_source;
+
+      // instruction queue, the front instruction is active if instruction_active is true
+      struct Instruction {
+        uint32_t code;
+        std::vector<uint32_t> args;
+      };
+      std::deque<Instruction>    instructions;
+      bool                       instruction_active;
+      saftbus::SourceHandle      instruction_timeout;
+      std::vector<uint32_t>      last_result;   // CMD_ARGS content before the active instruction was sent
+
   };
 
 }
@@ -23,6 +23,13 @@
 
 #include <saftbus/client.hpp>
 
+#include <stdexcept>
+#include <endian.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 using namespace std;
 
 /* Format mask for action sink */
@@ -191,4 +198,33 @@ namespace saftlib {
         return saftbus::SignalGroup::get_global().wait_for_signal(timeout_ms);
     }
 
+    std::vector<uint32_t> read_firmware_image(const std::string &filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        struct stat firmware_stat;
+        if (fd == -1 || fstat(fd, &firmware_stat) == -1) {
+            if (fd != -1) close(fd);
+            throw std::runtime_error("cannot open firmware binary file " + filename);
+        }
+        size_t file_size = firmware_stat.st_size;
+        size_t words     = file_size/4; // a trailing incomplete word is ignored
+
+        // the firmware binary is big endian (like the lm32). The conversion is done in 
+        // one simple loop over the mapped file, which the compiler vectorizes.
+        std::vector<uint32_t> image(words);
+        if (words > 0) {
+            void *map = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("cannot map firmware binary file " + filename);
+            }
+            const uint32_t *instr = static_cast<const uint32_t*>(map);
+            for (size_t i = 0; i < words; ++i) {
+                image[i] = be32toh(instr[i]);
+            }
+            munmap(map, file_size);
+        }
+        close(fd);
+        return image;
+    }
+
 }
@@ -34,6 +34,8 @@
 #include <string.h>
 #include <sstream>
 #include <inttypes.h>
+#include <string>
+#include <vector>
 
 // modes for printing to cout
 const uint32_t PMODE_NONE     = 0x0;
@@ -79,6 +81,14 @@ namespace saftlib {
     int wait_for_signal(int timeout_ms = -1);
 
     typedef saftbus::SignalGroup SignalGroup;
+
+    /// @brief read a firmware binary file (.bin) for an lm32 cpu
+    /// @param filename the file to read
+    /// @return the words of the file in host byte order, a trailing incomplete word is ignored
+    ///
+    /// The file is mapped and converted from big endian in one loop, not read word by word.
+    /// Throws std::runtime_error if the file cannot be read.
+    std::vector<uint32_t> read_firmware_image(const std::string &filename);
 }
 
 
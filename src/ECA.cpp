@@ -21,6 +21,7 @@
 
 #include "ECA.hpp"
 #include "SAFTd.hpp"
+#include "SdbCache.hpp"
 
 #include <stdlib.h>
 #include <string.h>
@@ -33,6 +34,7 @@
 
 #include <saftbus/error.hpp>
 #include <saftbus/service.hpp>
+#include <saftbus/trace.hpp>
 
 #include "SoftwareActionSink.hpp"
 #include "SoftwareActionSink_Service.hpp"
@@ -138,7 +140,7 @@ void ECA::prepareChannels()
 
 	// Locate all queue interfaces
 	std::vector<sdb_device> queues;
-	device.sdb_find_by_identity(ECA_QUEUE_SDB_VENDOR_ID, ECA_QUEUE_SDB_DEVICE_ID, queues);
+	SdbCache::find_by_identity(device, ECA_QUEUE_SDB_VENDOR_ID, ECA_QUEUE_SDB_DEVICE_ID, queues);
 
 	// Figure out which queues correspond to which channels
 	for (unsigned i = 0; i < queues.size(); ++i) {
@@ -194,15 +196,18 @@ void ECA::prepareChannels()
 			case ECA_WBM: {
 				// std::cerr << "============== FOUND WBM ACTION SINK object_path = " << object_path << std::endl;
 				std::vector<sdb_device> acwbm;
-				device.sdb_find_by_identity(ECA_SDB_VENDOR_ID, 0x18415778, acwbm);
+				SdbCache::find_by_identity(device, ECA_SDB_VENDOR_ID, 0x18415778, acwbm);
 				if (acwbm.size() == 1) {
 					std::string path = object_path + "/acwbm";
 
 					std::unique_ptr<WbmActionSink> wbm_sink(new WbmActionSink( device, *this, path, "acwbm", channel_idx, (eb_address_t)acwbm[0].sdb_component.addr_first, container  ));
 					if (container) {
-						std::unique_ptr<WbmActionSink_Service> service(new WbmActionSink_Service(wbm_sink.get()));
-						wbm_sink->set_service(service.get()); // for Owned interface
-						container->create_object(path, std::move(service));
+						WbmActionSink *sink_ptr = wbm_sink.get();
+						container->create_object_lazy(path, [sink_ptr]() {
+							std::unique_ptr<WbmActionSink_Service> service(new WbmActionSink_Service(sink_ptr));
+							sink_ptr->set_service(service.get()); // for Owned interface
+							return std::unique_ptr<saftbus::Service>(std::move(service));
+						});
 					}
 					ECAchannels[channel_idx].push_back(std::move(wbm_sink));
 					wbm_action_sinks["acwbm"] = path;
@@ -211,15 +216,18 @@ void ECA::prepareChannels()
 			case ECA_SCUBUS: {
 				// std::cerr << "============== FOUND SCU_BUS ACTION SINK object_path = " << object_path << std::endl;
 				std::vector<sdb_device> scubus;
-				device.sdb_find_by_identity(ECA_SDB_VENDOR_ID, 0x9602eb6f, scubus);
+				SdbCache::find_by_identity(device, ECA_SDB_VENDOR_ID, 0x9602eb6f, scubus);
 				if (scubus.size() == 1) {
 					std::string path = object_path + "/scubus";
 
 					std::unique_ptr<SCUbusActionSink> scubus_sink(new SCUbusActionSink( device, *this, path, "scubus", channel_idx, (eb_address_t)scubus[0].sdb_component.addr_first, container  ));
 					if (container) {
-						std::unique_ptr<SCUbusActionSink_Service> service(new SCUbusActionSink_Service(scubus_sink.get()));
-						scubus_sink->set_service(service.get()); // for Owned interface
-						container->create_object(path, std::move(service));
+						SCUbusActionSink *sink_ptr = scubus_sink.get();
+						container->create_object_lazy(path, [sink_ptr]() {
+							std::unique_ptr<SCUbusActionSink_Service> service(new SCUbusActionSink_Service(sink_ptr));
+							sink_ptr->set_service(service.get()); // for Owned interface
+							return std::unique_ptr<saftbus::Service>(std::move(service));
+						});
 					}
 					ECAchannels[channel_idx].push_back(std::move(scubus_sink));
 					scubus_action_sinks["scubus"] = path;
@@ -240,9 +248,12 @@ void ECA::prepareChannels()
 
 						std::unique_ptr<EmbeddedCPUActionSink> ecpu_sink(new EmbeddedCPUActionSink(*this, path, "embedded_cpu", channel_idx, container));
 						if (container) {
-							std::unique_ptr<EmbeddedCPUActionSink_Service> service(new EmbeddedCPUActionSink_Service(ecpu_sink.get()));
-							ecpu_sink->set_service(service.get()); // for Owned interface
-							container->create_object(path, std::move(service));
+							EmbeddedCPUActionSink *sink_ptr = ecpu_sink.get();
+							container->create_object_lazy(path, [sink_ptr]() {
+								std::unique_ptr<EmbeddedCPUActionSink_Service> service(new EmbeddedCPUActionSink_Service(sink_ptr));
+								sink_ptr->set_service(service.get()); // for Owned interface
+								return std::unique_ptr<saftbus::Service>(std::move(service));
+							});
 						}
 						ECAchannels[channel_idx].push_back(std::move(ecpu_sink));
 						ecpu_action_sinks["embedded_cpu"] = path;
@@ -259,6 +270,7 @@ void ECA::prepareChannels()
 
 void ECA::msiHandler(eb_data_t msi, unsigned channel)
 {
+	SAFTBUS_TRACE_SCOPE("ECA::msiHandler", channel);
 	// std::cerr << "TimingReceiver::msiHandler " << msi << " " << channel << std::endl;
 	unsigned code = msi >> 16;
 	unsigned num  = msi & 0xFFFF;
@@ -340,6 +352,44 @@ struct WalkEntry {
 	offset(oc.offset), tag(oc.tag), flags(oc.flags), channel(oc.channel), num(oc.num) { }
 };
 
+// Write search and walk table into the inactive tables of the ECA and make them active
+static void write_tables(etherbone::Device &device, eb_address_t adr_first, unsigned search_size, 
+                         const std::vector<SearchEntry> &search, const std::vector<WalkEntry> &walk)
+{
+	etherbone::Cycle cycle;
+	for (unsigned i = 0; i < search_size; ++i) {
+		/* Duplicate last entry to fill out the table */
+		const SearchEntry& se = (i<search.size())?search[i]:search.back();
+		
+		cycle.open(device);
+		cycle.write(adr_first + ECA_SEARCH_SELECT_RW,      EB_DATA32, i);
+		cycle.write(adr_first + ECA_SEARCH_RW_FIRST_RW,    EB_DATA32, (uint16_t)se.index);
+		cycle.write(adr_first + ECA_SEARCH_RW_EVENT_HI_RW, EB_DATA32, se.event >> 32);
+		cycle.write(adr_first + ECA_SEARCH_RW_EVENT_LO_RW, EB_DATA32, (uint32_t)se.event);
+		cycle.write(adr_first + ECA_SEARCH_WRITE_OWR,      EB_DATA32, 1);
+		cycle.close();
+	}
+	
+	for (unsigned i = 0; i < walk.size(); ++i) {
+		const WalkEntry& we = walk[i];
+		
+		cycle.open(device);
+		cycle.write(adr_first + ECA_WALKER_SELECT_RW,       EB_DATA32, i);
+		cycle.write(adr_first + ECA_WALKER_RW_NEXT_RW,      EB_DATA32, (uint16_t)we.next);
+		cycle.write(adr_first + ECA_WALKER_RW_OFFSET_HI_RW, EB_DATA32, (uint64_t)we.offset >> 32); // don't sign-extend on shift
+		cycle.write(adr_first + ECA_WALKER_RW_OFFSET_LO_RW, EB_DATA32, (uint32_t)we.offset);
+		cycle.write(adr_first + ECA_WALKER_RW_TAG_RW,       EB_DATA32, we.tag);
+		cycle.write(adr_first + ECA_WALKER_RW_FLAGS_RW,     EB_DATA32, we.flags);
+		cycle.write(adr_first + ECA_WALKER_RW_CHANNEL_RW,   EB_DATA32, we.channel);
+		cycle.write(adr_first + ECA_WALKER_RW_NUM_RW,       EB_DATA32, we.num);
+		cycle.write(adr_first + ECA_WALKER_WRITE_OWR,       EB_DATA32, 1);
+		cycle.close();
+	}
+	
+	// Flip the tables
+	device.write(adr_first + ECA_FLIP_ACTIVE_OWR, EB_DATA32, 1);
+}
+
 void ECA::ToggleActive()
 {
 	std::string caller;
@@ -510,42 +560,28 @@ void ECA::compile()
 // 		clog << kLogDebug << "W: " << walk[i].next << " " << walk[i].offset << " " << walk[i].tag << " " << walk[i].flags << " " << (int)walk[i].channel << " " << (int)walk[i].num << std::endl;
 // #endif
 
-	etherbone::Cycle cycle;
-	for (unsigned i = 0; i < search_size; ++i) {
-		/* Duplicate last entry to fill out the table */
-		const SearchEntry& se = (i<search.size())?search[i]:search.back();
-		
-		cycle.open(device);
-		cycle.write(adr_first + ECA_SEARCH_SELECT_RW,      EB_DATA32, i);
-		cycle.write(adr_first + ECA_SEARCH_RW_FIRST_RW,    EB_DATA32, (uint16_t)se.index);
-		cycle.write(adr_first + ECA_SEARCH_RW_EVENT_HI_RW, EB_DATA32, se.event >> 32);
-		cycle.write(adr_first + ECA_SEARCH_RW_EVENT_LO_RW, EB_DATA32, (uint32_t)se.event);
-		cycle.write(adr_first + ECA_SEARCH_WRITE_OWR,      EB_DATA32, 1);
-		cycle.close();
-	}
-	
-	for (unsigned i = 0; i < walk.size(); ++i) {
-		const WalkEntry& we = walk[i];
-		
-		cycle.open(device);
-		cycle.write(adr_first + ECA_WALKER_SELECT_RW,       EB_DATA32, i);
-		cycle.write(adr_first + ECA_WALKER_RW_NEXT_RW,      EB_DATA32, (uint16_t)we.next);
-		cycle.write(adr_first + ECA_WALKER_RW_OFFSET_HI_RW, EB_DATA32, (uint64_t)we.offset >> 32); // don't sign-extend on shift
-		cycle.write(adr_first + ECA_WALKER_RW_OFFSET_LO_RW, EB_DATA32, (uint32_t)we.offset);
-		cycle.write(adr_first + ECA_WALKER_RW_TAG_RW,       EB_DATA32, we.tag);
-		cycle.write(adr_first + ECA_WALKER_RW_FLAGS_RW,     EB_DATA32, we.flags);
-		cycle.write(adr_first + ECA_WALKER_RW_CHANNEL_RW,   EB_DATA32, we.channel);
-		cycle.write(adr_first + ECA_WALKER_RW_NUM_RW,       EB_DATA32, we.num);
-		cycle.write(adr_first + ECA_WALKER_WRITE_OWR,       EB_DATA32, 1);
-		cycle.close();
-	}
-	
-	// Flip the tables
-	device.write(adr_first + ECA_FLIP_ACTIVE_OWR, EB_DATA32, 1);
-	
+	write_tables(device, adr_first, search_size, search, walk);
+
 	used_conditions = id_space.size()/2;
 }
 
+bool ECA::prefetch(etherbone::Device &device, std::vector<eb_data_t> &data)
+{
+	std::vector<sdb_device> ecas;
+	SdbCache::find_by_identity(device, ECA_SDB_VENDOR_ID, ECA_SDB_DEVICE_ID, ecas);
+	if (ecas.empty()) {
+		return false;
+	}
+	eb_address_t adr_first = ecas[0].sdb_component.addr_first;
+	eb_data_t raw_search;
+	device.read(adr_first + ECA_SEARCH_CAPACITY_GET, EB_DATA32, &raw_search);
+
+	// the same tables as compile() writes without active conditions
+	std::vector<SearchEntry> search(1, SearchEntry(0, -1));
+	write_tables(device, adr_first, raw_search, search, std::vector<WalkEntry>());
+	return true;
+}
+
 
 
 ////////////////////////////////////////////////////////////////
@@ -580,7 +616,12 @@ ECA::ECA(SAFTd &saftd, etherbone::Device &dev, const std::string &obj_path, saft
 {
 	// std::cerr << "ECA::ECA() object_path " << object_path << std::endl;
 	probeConfiguration();
-	compile(); // remove old rules
+	std::vector<eb_data_t> cleared;
+	if (SdbCache::take_prefetched(device, "ECA", cleared)) {
+		used_conditions = 0; // old rules were removed by ECA::prefetch
+	} else {
+		compile(); // remove old rules
+	}
 	prepareChannels();
 
 	for (unsigned channel_idx = 0; channel_idx < channels; ++channel_idx) {
@@ -799,6 +840,17 @@ std::map< std::string, std::string > ECA::getOutputs() const
 	return out;
 }
 
+void ECA::outputsOwnerOnly(const std::vector<std::string> &names) const
+{
+	assert(ECAchannels.size() > 0);
+	for (auto &action_sink: ECAchannels[0]) {
+		Output* output = dynamic_cast<Output*>(action_sink.get());
+		if (output && std::find(names.begin(), names.end(), output->getObjectName()) != names.end()) {
+			output->checkWriteOutput();
+		}
+	}
+}
+
 uint32_t ECA::getFree() const 
 {
 	return max_conditions - used_conditions;
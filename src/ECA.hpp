@@ -100,6 +100,8 @@ public:
 	const std::string &get_object_path();
 	etherbone::Device &get_device();
 	void compile();
+	/// @brief remove old rules in a prefetch worker (see SdbCache::PrefetchStep), the ECA constructor then skips compile()
+	static bool prefetch(etherbone::Device &device, std::vector<eb_data_t> &data);
 	// typedef std::pair<unsigned, unsigned> SinkKey; // (channel, num)
 
 
@@ -114,6 +116,9 @@ public:
 
 	void removeSowftwareActionSink(SoftwareActionSink *sas);
 
+	/// @brief throws if the calling client is not allowed to drive one of the named Outputs (see Owned::ownerOnly)
+	void outputsOwnerOnly(const std::vector<std::string> &names) const;
+
 	/// @brief The current time of the timingreceiver.
 	/// @return     the current time of the timingreceiver
 	///
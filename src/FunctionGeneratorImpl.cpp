@@ -23,6 +23,7 @@
 #include <functional>
 #include <assert.h>
 #include <iostream>
+#include <algorithm>
 #include <sstream>
 
 #include <saftbus/error.hpp>
@@ -74,7 +75,9 @@ FunctionGeneratorImpl::FunctionGeneratorImpl(SAFTd *saft_daemon
    fifo(16384), // a fifo entry is 12 bytes long. 
                 // Make the circular buffer large enough so that re-alloction is hopefully not needed 
                 // (initial size is 192 KiB for buffer size of 16384)
-   fg_fifo_max_size(0)
+   fg_fifo_max_size(0),
+   channel_generation(0), refill_pending(false), refill_again(false),
+   async_guard(AsyncCycle::make_guard())
 {
   // DRIVER_LOG("",-1, -1);
 
@@ -160,6 +163,35 @@ void FunctionGeneratorImpl::fifo_push_back(const ParameterTuple& tuple)
   }  
 }
 
+void FunctionGeneratorImpl::fifo_append(const ParameterTuple *begin, const ParameterTuple *end)
+{
+  std::size_t n = end - begin;
+  if (fifo.capacity() - fifo.size() < n) {
+    std::size_t new_capacity = fifo.capacity();
+    while (new_capacity - fifo.size() < n) {
+      new_capacity = std::max<std::size_t>(2*new_capacity, 1);
+    }
+    std::cerr << "FunctionGeneratorImpl: change fifo capacity from " << std::dec << fifo.capacity() << " to " << new_capacity << std::endl;
+    fifo.set_capacity(new_capacity);
+  }
+  fifo.insert(fifo.end(), begin, end);
+  if (fg_fifo_max_size < fifo.size()) {
+    fg_fifo_max_size = fifo.size();
+  }
+}
+
+void FunctionGeneratorImpl::fifo_drop_back(unsigned n)
+{
+  assert(fifo.size() >= filled + n); // never drop tuples that are already on the LM32
+  fifo.erase_end(n);
+}
+
+bool FunctionGeneratorImpl::fifo_commit(uint64_t duration)
+{
+  fillLevel += duration;
+  if (channel != -1) refill(false);
+  return lowFill();
+}
 
 bool FunctionGeneratorImpl::lowFill() const
 {
@@ -169,21 +201,48 @@ bool FunctionGeneratorImpl::lowFill() const
 
 void FunctionGeneratorImpl::refill(bool first)
 {
-  etherbone::Cycle cycle;
-  eb_data_t write_offset_d = 0, read_offset_d = 0;
-  
   assert (channel != -1);
   
-  eb_address_t regs = shm + FG_REGS_BASE(channel, num_channels);
-  
-  // if refill is called for the first time, there is no need for checking the offsets. they are 0 
-  if (first == false) {
-    cycle.open(device);
-    cycle.read(regs + FG_WPTR, EB_DATA32, &write_offset_d);
-    cycle.read(regs + FG_RPTR, EB_DATA32, &read_offset_d);
-    cycle.close();
+  // if refill is called for the first time, there is no need for checking the offsets. they are 0.
+  // This is done synchronously, because arm has to send the enable SWI after the data is written.
+  if (first) {
+    fill(0, 0, true);
+    return;
   }
-  
+
+  // Otherwise the offsets are read without waiting for the device. 
+  // Only one refill is in flight, a refill requested meanwhile is done after it.
+  if (refill_pending) {
+    refill_again = true;
+    return;
+  }
+  refill_pending = true;
+  unsigned generation = channel_generation;
+  eb_address_t regs = shm + FG_REGS_BASE(channel, num_channels);
+  AsyncCycle cycle(device);
+  cycle.read(regs + FG_WPTR, EB_DATA32);
+  cycle.read(regs + FG_RPTR, EB_DATA32);
+  cycle.submit(async_guard, [this, generation](bool ok, const std::vector<eb_data_t> &offsets) {
+    if (generation != channel_generation) {
+      return; // the channel was released (and maybe acquired again) meanwhile, filled is no longer valid 
+    }
+    refill_pending = false;
+    if (!ok) {
+      std::cerr << "FunctionGenerator: failed to read buffer offsets on channel " << std::dec << channel << " for index " << index << std::endl;
+      return;
+    }
+    fill(offsets[0], offsets[1], false);
+    if (refill_again) {
+      refill_again = false;
+      refill(false);
+    }
+  });
+}
+
+void FunctionGeneratorImpl::fill(eb_data_t write_offset_d, eb_data_t read_offset_d, bool wait)
+{
+  eb_address_t regs = shm + FG_REGS_BASE(channel, num_channels);
+
   unsigned write_offset = write_offset_d % buffer_size;
   unsigned read_offset  = read_offset_d  % buffer_size;
   
@@ -210,7 +269,8 @@ void FunctionGeneratorImpl::refill(bool first)
   unsigned space = buffer_size-1 - filled;  // free space on LM32
   unsigned refill = std::min(todo, space); // add this many records
   
-  cycle.open(device);
+  std::vector<std::pair<eb_address_t, eb_data_t> > writes;
+  writes.reserve(3*refill+1);
   for (unsigned i = 0; i < refill; ++i) {
     ParameterTuple& tuple = fifo[filled+i];
     uint32_t coeff_a, coeff_b, coeff_ab, coeff_c, control;
@@ -231,14 +291,29 @@ void FunctionGeneratorImpl::refill(bool first)
     
     unsigned offset = wrapping_add(write_offset, i, buffer_size);
     eb_address_t buff = shm + FG_BUFF_BASE(channel, offset, num_channels, buffer_size);
-    cycle.write(buff + PARAM_COEFF_AB, EB_DATA32, coeff_ab);
-    cycle.write(buff + PARAM_COEFF_C,  EB_DATA32, coeff_c);
-    cycle.write(buff + PARAM_CONTROL,  EB_DATA32, control);
+    writes.push_back(std::make_pair(buff + PARAM_COEFF_AB, coeff_ab));
+    writes.push_back(std::make_pair(buff + PARAM_COEFF_C,  coeff_c));
+    writes.push_back(std::make_pair(buff + PARAM_CONTROL,  control));
   }
   // update write pointer
   unsigned offset = wrapping_add(write_offset, refill, buffer_size);
-  cycle.write(regs + FG_WPTR, EB_DATA32, offset);
-  cycle.close();
+  writes.push_back(std::make_pair(regs + FG_WPTR, offset));
+
+  if (wait) {
+    etherbone::Cycle cycle;
+    cycle.open(device);
+    for (auto &write: writes) {
+      cycle.write(write.first, EB_DATA32, write.second);
+    }
+    cycle.close();
+  } else {
+    // the next refill reads the offsets after this cycle, so it sees the new write pointer
+    AsyncCycle cycle(device);
+    for (auto &write: writes) {
+      cycle.write(write.first, EB_DATA32, write.second);
+    }
+    cycle.submit();
+  }
   
   filled += refill;
 }
@@ -349,7 +424,7 @@ bool FunctionGeneratorImpl::appendParameterTuples(std::vector<ParameterTuple> pa
 }
 
 
-bool FunctionGeneratorImpl::appendParameterSet(
+std::vector<ParameterTuple> FunctionGeneratorImpl::makeParameterTuples(
   const std::vector< int16_t >& coeff_a,
   const std::vector< int16_t >& coeff_b,
   const std::vector< int32_t >& coeff_c,
@@ -357,10 +432,7 @@ bool FunctionGeneratorImpl::appendParameterSet(
   const std::vector< unsigned char >& freq,
   const std::vector< unsigned char >& shift_a,
   const std::vector< unsigned char >& shift_b )
-
 {
-  // DRIVER_LOG("coeff.size()",-1, coeff_a.size());
-
   // confirm lengths match
   unsigned len = coeff_a.size();
   
@@ -380,22 +452,32 @@ bool FunctionGeneratorImpl::appendParameterSet(
   }
   
   // import the data
+  std::vector<ParameterTuple> tuples(len);
   for (unsigned i = 0; i < len; ++i) {
-    ParameterTuple tuple;
-    tuple.coeff_a = coeff_a[i];
-    tuple.coeff_b = coeff_b[i];
-    tuple.coeff_c = coeff_c[i];
-    tuple.step    = step[i];
-    tuple.freq    = freq[i];
-    tuple.shift_a = shift_a[i];
-    tuple.shift_b = shift_b[i];
-    fifo_push_back(tuple);
-    fillLevel += tuple.duration();
+    tuples[i].coeff_a = coeff_a[i];
+    tuples[i].coeff_b = coeff_b[i];
+    tuples[i].coeff_c = coeff_c[i];
+    tuples[i].step    = step[i];
+    tuples[i].freq    = freq[i];
+    tuples[i].shift_a = shift_a[i];
+    tuples[i].shift_b = shift_b[i];
   }
-  
-  if (channel != -1) refill(false);
-  return lowFill();
+  return tuples;
+}
+
+bool FunctionGeneratorImpl::appendParameterSet(
+  const std::vector< int16_t >& coeff_a,
+  const std::vector< int16_t >& coeff_b,
+  const std::vector< int32_t >& coeff_c,
+  const std::vector< unsigned char >& step,
+  const std::vector< unsigned char >& freq,
+  const std::vector< unsigned char >& shift_a,
+  const std::vector< unsigned char >& shift_b )
 
+{
+  // DRIVER_LOG("coeff.size()",-1, coeff_a.size());
+  std::vector<ParameterTuple> tuples = makeParameterTuples(coeff_a, coeff_b, coeff_c, step, freq, shift_a, shift_b);
+  return appendParameterTuples(tuples.cbegin(), tuples.cend());
 }
 
 void FunctionGeneratorImpl::flush()
@@ -520,6 +602,9 @@ void FunctionGeneratorImpl::acquireChannel()
  
   allocation->operator[](i) = index;
   channel = i;
+  ++channel_generation;
+  refill_pending = false;
+  refill_again   = false;
   enabled = true;
   // DRIVER_LOG("got_channel",-1,channel);
   signal_enabled.emit(enabled);
@@ -538,6 +623,7 @@ void FunctionGeneratorImpl::releaseChannel()
   }
   allocation->operator[](channel) = -1;
   channel = -1;
+  ++channel_generation;
   filled = 0;
   enabled = false;
   signal_enabled.emit(enabled);
@@ -32,6 +32,7 @@
 #include <sigc++/sigc++.h>
 #include "Time.hpp"
 #include "Mailbox.hpp"
+#include "eb-async-cycle.hpp"
 
 #include <saftbus/loop.hpp>
 
@@ -113,6 +114,8 @@ class FunctionGeneratorImpl //: public Glib::Object
     void Arm();
     void Abort();
     uint64_t ReadFillLevel();
+    // validate a parameter set and convert it into parameter tuples (throws saftbus::Error)
+    static std::vector<ParameterTuple> makeParameterTuples(const std::vector< int16_t >& coeff_a, const std::vector< int16_t >& coeff_b, const std::vector< int32_t >& coeff_c, const std::vector< unsigned char >& step, const std::vector< unsigned char >& freq, const std::vector< unsigned char >& shift_a, const std::vector< unsigned char >& shift_b);
     bool appendParameterSet(const std::vector< int16_t >& coeff_a, const std::vector< int16_t >& coeff_b, const std::vector< int32_t >& coeff_c, const std::vector< unsigned char >& step, const std::vector< unsigned char >& freq, const std::vector< unsigned char >& shift_a, const std::vector< unsigned char >& shift_b);
     void Flush();
     uint32_t getVersion() const;
@@ -145,6 +148,8 @@ class FunctionGeneratorImpl //: public Glib::Object
     bool lowFill() const;
     void irq_handler(eb_data_t msi);
     void refill(bool);
+    // send fifo entries to the LM32 buffer, wait for the device only if wait is true
+    void fill(eb_data_t write_offset_d, eb_data_t read_offset_d, bool wait);
     void releaseChannel();
     void acquireChannel();
 
@@ -152,6 +157,11 @@ class FunctionGeneratorImpl //: public Glib::Object
     void ownerQuit();
 
     void fifo_push_back(const ParameterTuple& tuple);
+    // bulk append/removal at the end of the fifo, fillLevel is not touched
+    void fifo_append(const ParameterTuple *begin, const ParameterTuple *end);
+    void fifo_drop_back(unsigned n);
+    // account for tuples added with fifo_append and send them to the LM32 if running
+    bool fifo_commit(uint64_t duration);
 
             
             
@@ -195,6 +205,12 @@ class FunctionGeneratorImpl //: public Glib::Object
     boost::circular_buffer<ParameterTuple> fifo;
 
     unsigned fg_fifo_max_size;
+
+    // asynchronous refill (see refill)
+    unsigned channel_generation; // incremented whenever channel changes
+    bool refill_pending;
+    bool refill_again;
+    AsyncCycle::Guard async_guard;
 };
 
 }
@@ -43,6 +43,7 @@ Io::Io(etherbone::Device &dev
 	 , bool spec_out_available
 	 , bool spec_in_available
 	 , eb_address_t control_addr
+	 , RegisterShadow &shadow
 	 , SerdesClockGen &clkgen )
 	: device(dev)
 	, io_name(name)
@@ -58,6 +59,7 @@ Io::Io(etherbone::Device &dev
 	, io_spec_out_available(spec_out_available)
 	, io_spec_in_available(spec_in_available)
 	, io_control_addr(control_addr)
+	, io_shadow(shadow)
 	, io_clkgen(clkgen)
 {}
 
@@ -70,6 +72,10 @@ unsigned Io::getDirection() const {
 	return io_direction;
 }
 
+unsigned Io::getChannel() const {
+	return io_channel;
+}
+
 uint32_t Io::getIndexOut() const
 {
 	return io_index;
@@ -139,11 +145,9 @@ bool Io::ReadCombinedOutput()
 	unsigned inputRegOffset = 0;
 	unsigned totalInputs = 0;
 
-	cycle.open(device);
-	if      (io_channel == IO_CFG_CHANNEL_GPIO) { cycle.read(io_control_addr+eGPIO_Info, EB_DATA32, &inputOffset); }
-	else if (io_channel == IO_CFG_CHANNEL_LVDS) { cycle.read(io_control_addr+eLVDS_Info, EB_DATA32, &inputOffset); }
+	if      (io_channel == IO_CFG_CHANNEL_GPIO) { inputOffset = io_shadow.read(io_control_addr+eGPIO_Info); }
+	else if (io_channel == IO_CFG_CHANNEL_LVDS) { inputOffset = io_shadow.read(io_control_addr+eLVDS_Info); }
 	else                                   { throw saftbus::Error(saftbus::Error::INVALID_ARGS, "IO channel unknown!"); }
-	cycle.close();
 	totalInputs = (unsigned) inputOffset;
 	totalInputs = ((totalInputs&IO_INFO_IN_COUNT_MASK) >> IO_INFO_IN_SHIFT) + ((totalInputs&IO_INFO_INOUT_COUNT_MASK) >> IO_INFO_INOUT_SHIFT);
 	inputRegOffset = totalInputs*4;
@@ -160,33 +164,23 @@ bool Io::ReadCombinedOutput()
 
 bool Io::getOutputEnable() const
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 	eb_data_t readOutputEnable;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eGPIO_Oe_Set_low,  EB_DATA32, &readOutputEnable); }
-		else                      { cycle.read(io_control_addr+eGPIO_Oe_Set_high, EB_DATA32, &readOutputEnable); }
+		if (access_position == 0) { readOutputEnable = io_shadow.read(io_control_addr+eGPIO_Oe_Set_low); }
+		else                      { readOutputEnable = io_shadow.read(io_control_addr+eGPIO_Oe_Set_high); }
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eLVDS_Oe_Set_low,  EB_DATA32, &readOutputEnable); }
-		else                      { cycle.read(io_control_addr+eLVDS_Oe_Set_high, EB_DATA32, &readOutputEnable); }
+		if (access_position == 0) { readOutputEnable = io_shadow.read(io_control_addr+eLVDS_Oe_Set_low); }
+		else                      { readOutputEnable = io_shadow.read(io_control_addr+eLVDS_Oe_Set_high); }
 	}
 	else                        { throw saftbus::Error(saftbus::Error::INVALID_ARGS, "IO channel unknown!"); }
-	cycle.close();
 
-	readOutputEnable = readOutputEnable&(1<<internal_id);
+	readOutputEnable = readOutputEnable&(eb_data_t(1)<<internal_id);
 	readOutputEnable = readOutputEnable>>internal_id;
 
 	if(readOutputEnable) { return true; }
@@ -195,22 +189,22 @@ bool Io::getOutputEnable() const
 
 void Io::setOutputEnable(bool val)
 {
-	etherbone::Cycle cycle;
-
-	unsigned id_low  = io_index % 32;
-	unsigned id_high = io_index / 32;
+	unsigned id_low  = config_bit(io_index);
+	unsigned id_high = config_word(io_index);
 	eb_data_t id_mask = eb_data_t(1) << id_low;
 
-	eb_address_t reg;
+	eb_address_t reg, set_reg;
 	if (io_channel == IO_CFG_CHANNEL_GPIO) {
 		reg = val?eGPIO_Oe_Set_low:eGPIO_Oe_Reset_low;
+		set_reg = eGPIO_Oe_Set_low;
 	} else if (io_channel == IO_CFG_CHANNEL_LVDS) {
 		reg = val?eLVDS_Oe_Set_low:eLVDS_Oe_Reset_low;
+		set_reg = eLVDS_Oe_Set_low;
 	} else {
 		throw saftbus::Error(saftbus::Error::INVALID_ARGS, "IO channel unknown!");
 	}
 
-	device.write(io_control_addr + reg + 4*id_high, EB_DATA32, id_mask);
+	io_shadow.modify(io_control_addr + set_reg + 4*id_high, io_control_addr + reg + 4*id_high, id_mask, val);
 	if (OutputEnable) {
 		OutputEnable(val);
 	}
@@ -233,33 +227,23 @@ bool Io::ReadInput()
 
 bool Io::getInputTermination() const
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 	eb_data_t readInputTermination;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eGPIO_Term_Set_low,  EB_DATA32, &readInputTermination); }
-		else                      { cycle.read(io_control_addr+eGPIO_Term_Set_high, EB_DATA32, &readInputTermination); }
+		if (access_position == 0) { readInputTermination = io_shadow.read(io_control_addr+eGPIO_Term_Set_low); }
+		else                      { readInputTermination = io_shadow.read(io_control_addr+eGPIO_Term_Set_high); }
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eLVDS_Term_Set_low,  EB_DATA32, &readInputTermination); }
-		else                      { cycle.read(io_control_addr+eLVDS_Term_Set_high, EB_DATA32, &readInputTermination); }
+		if (access_position == 0) { readInputTermination = io_shadow.read(io_control_addr+eLVDS_Term_Set_low); }
+		else                      { readInputTermination = io_shadow.read(io_control_addr+eLVDS_Term_Set_high); }
 	}
 	else                        { throw saftbus::Error(saftbus::Error::INVALID_ARGS, "IO channel unknown!"); }
-	cycle.close();
 
-	readInputTermination = readInputTermination&(1<<internal_id);
+	readInputTermination = readInputTermination&(eb_data_t(1)<<internal_id);
 	readInputTermination = readInputTermination>>internal_id;
 
 	if (readInputTermination) { return true; }
@@ -268,45 +252,35 @@ bool Io::getInputTermination() const
 
 void Io::setInputTermination(bool val)
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Term_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Term_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Term_Set_low, io_control_addr+eGPIO_Term_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Term_Set_high, io_control_addr+eGPIO_Term_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Term_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Term_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Term_Set_low, io_control_addr+eGPIO_Term_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Term_Set_high, io_control_addr+eGPIO_Term_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Term_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Term_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Term_Set_low, io_control_addr+eLVDS_Term_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Term_Set_high, io_control_addr+eLVDS_Term_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Term_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Term_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Term_Set_low, io_control_addr+eLVDS_Term_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Term_Set_high, io_control_addr+eLVDS_Term_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
-	cycle.close();
 	if (InputTermination) {
 		InputTermination(val);
 	}
@@ -334,33 +308,23 @@ bool Io::getSpecialPurposeInAvailable() const
 
 bool Io::getSpecialPurposeOut() const
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 	eb_data_t readSpecialPurposeOut;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eGPIO_Spec_Out_Set_low,  EB_DATA32, &readSpecialPurposeOut); }
-		else                      { cycle.read(io_control_addr+eGPIO_Spec_Out_Set_high, EB_DATA32, &readSpecialPurposeOut); }
+		if (access_position == 0) { readSpecialPurposeOut = io_shadow.read(io_control_addr+eGPIO_Spec_Out_Set_low); }
+		else                      { readSpecialPurposeOut = io_shadow.read(io_control_addr+eGPIO_Spec_Out_Set_high); }
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eLVDS_Spec_Out_Set_low,  EB_DATA32, &readSpecialPurposeOut); }
-		else                      { cycle.read(io_control_addr+eLVDS_Spec_Out_Set_high, EB_DATA32, &readSpecialPurposeOut); }
+		if (access_position == 0) { readSpecialPurposeOut = io_shadow.read(io_control_addr+eLVDS_Spec_Out_Set_low); }
+		else                      { readSpecialPurposeOut = io_shadow.read(io_control_addr+eLVDS_Spec_Out_Set_high); }
 	}
 	else                        { throw saftbus::Error(saftbus::Error::INVALID_ARGS, "IO channel unknown!"); }
-	cycle.close();
 
-	readSpecialPurposeOut = readSpecialPurposeOut&(1<<internal_id);
+	readSpecialPurposeOut = readSpecialPurposeOut&(eb_data_t(1)<<internal_id);
 	readSpecialPurposeOut = readSpecialPurposeOut>>internal_id;
 
 	if (readSpecialPurposeOut) { return true; }
@@ -369,45 +333,35 @@ bool Io::getSpecialPurposeOut() const
 
 void Io::setSpecialPurposeOut(bool val)
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Spec_Out_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Spec_Out_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Spec_Out_Set_low, io_control_addr+eGPIO_Spec_Out_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Spec_Out_Set_high, io_control_addr+eGPIO_Spec_Out_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Spec_Out_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Spec_Out_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Spec_Out_Set_low, io_control_addr+eGPIO_Spec_Out_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Spec_Out_Set_high, io_control_addr+eGPIO_Spec_Out_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Spec_Out_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Spec_Out_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Spec_Out_Set_low, io_control_addr+eLVDS_Spec_Out_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Spec_Out_Set_high, io_control_addr+eLVDS_Spec_Out_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Spec_Out_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Spec_Out_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Spec_Out_Set_low, io_control_addr+eLVDS_Spec_Out_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Spec_Out_Set_high, io_control_addr+eLVDS_Spec_Out_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
-	cycle.close();
 	if (SpecialPurposeOut) {
 		SpecialPurposeOut(val);
 	}
@@ -415,33 +369,23 @@ void Io::setSpecialPurposeOut(bool val)
 
 bool Io::getGateOut() const
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 	eb_data_t readGateOut;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eGPIO_Gate_Out_Set_low,  EB_DATA32, &readGateOut); }
-		else                      { cycle.read(io_control_addr+eGPIO_Gate_Out_Set_high, EB_DATA32, &readGateOut); }
+		if (access_position == 0) { readGateOut = io_shadow.read(io_control_addr+eGPIO_Gate_Out_Set_low); }
+		else                      { readGateOut = io_shadow.read(io_control_addr+eGPIO_Gate_Out_Set_high); }
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eLVDS_Gate_Out_Set_low,  EB_DATA32, &readGateOut); }
-		else                      { cycle.read(io_control_addr+eLVDS_Gate_Out_Set_high, EB_DATA32, &readGateOut); }
+		if (access_position == 0) { readGateOut = io_shadow.read(io_control_addr+eLVDS_Gate_Out_Set_low); }
+		else                      { readGateOut = io_shadow.read(io_control_addr+eLVDS_Gate_Out_Set_high); }
 	}
 	else                        { throw saftbus::Error(saftbus::Error::INVALID_ARGS, "IO channel unknown!"); }
-	cycle.close();
 
-	readGateOut = readGateOut&(1<<internal_id);
+	readGateOut = readGateOut&(eb_data_t(1)<<internal_id);
 	readGateOut = readGateOut>>internal_id;
 
 	if (readGateOut) { return true; }
@@ -450,45 +394,35 @@ bool Io::getGateOut() const
 
 void Io::setGateOut(bool val)
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Gate_Out_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Gate_Out_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Gate_Out_Set_low, io_control_addr+eGPIO_Gate_Out_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Gate_Out_Set_high, io_control_addr+eGPIO_Gate_Out_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Gate_Out_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Gate_Out_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Gate_Out_Set_low, io_control_addr+eGPIO_Gate_Out_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Gate_Out_Set_high, io_control_addr+eGPIO_Gate_Out_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Gate_Out_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Gate_Out_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Gate_Out_Set_low, io_control_addr+eLVDS_Gate_Out_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Gate_Out_Set_high, io_control_addr+eLVDS_Gate_Out_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Gate_Out_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Gate_Out_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Gate_Out_Set_low, io_control_addr+eLVDS_Gate_Out_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Gate_Out_Set_high, io_control_addr+eLVDS_Gate_Out_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
-	cycle.close();
 	//if (GateOut) {
 	//	GateOut(val);
 	//}
@@ -496,33 +430,23 @@ void Io::setGateOut(bool val)
 
 bool Io::getSpecialPurposeIn() const
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 	eb_data_t readSpecialPurposeIn;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eGPIO_Spec_In_Set_low,  EB_DATA32, &readSpecialPurposeIn); }
-		else                      { cycle.read(io_control_addr+eGPIO_Spec_In_Set_high, EB_DATA32, &readSpecialPurposeIn); }
+		if (access_position == 0) { readSpecialPurposeIn = io_shadow.read(io_control_addr+eGPIO_Spec_In_Set_low); }
+		else                      { readSpecialPurposeIn = io_shadow.read(io_control_addr+eGPIO_Spec_In_Set_high); }
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eLVDS_Spec_In_Set_low,  EB_DATA32, &readSpecialPurposeIn); }
-		else                      { cycle.read(io_control_addr+eLVDS_Spec_In_Set_high, EB_DATA32, &readSpecialPurposeIn); }
+		if (access_position == 0) { readSpecialPurposeIn = io_shadow.read(io_control_addr+eLVDS_Spec_In_Set_low); }
+		else                      { readSpecialPurposeIn = io_shadow.read(io_control_addr+eLVDS_Spec_In_Set_high); }
 	}
 	else                        { throw saftbus::Error(saftbus::Error::INVALID_ARGS, "IO channel unknown!"); }
-	cycle.close();
 
-	readSpecialPurposeIn = readSpecialPurposeIn&(1<<internal_id);
+	readSpecialPurposeIn = readSpecialPurposeIn&(eb_data_t(1)<<internal_id);
 	readSpecialPurposeIn = readSpecialPurposeIn>>internal_id;
 
 	if (readSpecialPurposeIn) { return true; }
@@ -531,45 +455,35 @@ bool Io::getSpecialPurposeIn() const
 
 void Io::setSpecialPurposeIn(bool val)
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Spec_In_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Spec_In_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Spec_In_Set_low, io_control_addr+eGPIO_Spec_In_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Spec_In_Set_high, io_control_addr+eGPIO_Spec_In_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Spec_In_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Spec_In_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Spec_In_Set_low, io_control_addr+eGPIO_Spec_In_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Spec_In_Set_high, io_control_addr+eGPIO_Spec_In_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Spec_In_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Spec_In_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Spec_In_Set_low, io_control_addr+eLVDS_Spec_In_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Spec_In_Set_high, io_control_addr+eLVDS_Spec_In_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Spec_In_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Spec_In_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Spec_In_Set_low, io_control_addr+eLVDS_Spec_In_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Spec_In_Set_high, io_control_addr+eLVDS_Spec_In_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
-	cycle.close();
 	if (SpecialPurposeIn) {
 		SpecialPurposeIn(val);
 	}
@@ -577,33 +491,23 @@ void Io::setSpecialPurposeIn(bool val)
 
 bool Io::getGateIn() const
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 	eb_data_t readGateIn;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eGPIO_Gate_In_Set_low,  EB_DATA32, &readGateIn); }
-		else                      { cycle.read(io_control_addr+eGPIO_Gate_In_Set_high, EB_DATA32, &readGateIn); }
+		if (access_position == 0) { readGateIn = io_shadow.read(io_control_addr+eGPIO_Gate_In_Set_low); }
+		else                      { readGateIn = io_shadow.read(io_control_addr+eGPIO_Gate_In_Set_high); }
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eLVDS_Gate_In_Set_low,  EB_DATA32, &readGateIn); }
-		else                      { cycle.read(io_control_addr+eLVDS_Gate_In_Set_high, EB_DATA32, &readGateIn); }
+		if (access_position == 0) { readGateIn = io_shadow.read(io_control_addr+eLVDS_Gate_In_Set_low); }
+		else                      { readGateIn = io_shadow.read(io_control_addr+eLVDS_Gate_In_Set_high); }
 	}
 	else                        { throw saftbus::Error(saftbus::Error::INVALID_ARGS, "IO channel unknown!"); }
-	cycle.close();
 
-	readGateIn = readGateIn&(1<<internal_id);
+	readGateIn = readGateIn&(eb_data_t(1)<<internal_id);
 	readGateIn = readGateIn>>internal_id;
 
 	if (readGateIn) { return true; }
@@ -612,45 +516,35 @@ bool Io::getGateIn() const
 
 void Io::setGateIn(bool val)
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Gate_In_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Gate_In_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Gate_In_Set_low, io_control_addr+eGPIO_Gate_In_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Gate_In_Set_high, io_control_addr+eGPIO_Gate_In_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Gate_In_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Gate_In_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Gate_In_Set_low, io_control_addr+eGPIO_Gate_In_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Gate_In_Set_high, io_control_addr+eGPIO_Gate_In_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Gate_In_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Gate_In_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Gate_In_Set_low, io_control_addr+eLVDS_Gate_In_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Gate_In_Set_high, io_control_addr+eLVDS_Gate_In_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Gate_In_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Gate_In_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Gate_In_Set_low, io_control_addr+eLVDS_Gate_In_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Gate_In_Set_high, io_control_addr+eLVDS_Gate_In_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
-	cycle.close();
 	if (GateIn) {
 		GateIn(val);
 	}
@@ -660,33 +554,23 @@ void Io::setGateIn(bool val)
 
 bool Io::getBuTiSMultiplexer() const
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 	eb_data_t readBuTiSMultiplexer;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eGPIO_Mux_Set_low,  EB_DATA32, &readBuTiSMultiplexer); }
-		else                      { cycle.read(io_control_addr+eGPIO_Mux_Set_high, EB_DATA32, &readBuTiSMultiplexer); }
+		if (access_position == 0) { readBuTiSMultiplexer = io_shadow.read(io_control_addr+eGPIO_Mux_Set_low); }
+		else                      { readBuTiSMultiplexer = io_shadow.read(io_control_addr+eGPIO_Mux_Set_high); }
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eLVDS_Mux_Set_low,  EB_DATA32, &readBuTiSMultiplexer); }
-		else                      { cycle.read(io_control_addr+eLVDS_Mux_Set_high, EB_DATA32, &readBuTiSMultiplexer); }
+		if (access_position == 0) { readBuTiSMultiplexer = io_shadow.read(io_control_addr+eLVDS_Mux_Set_low); }
+		else                      { readBuTiSMultiplexer = io_shadow.read(io_control_addr+eLVDS_Mux_Set_high); }
 	}
 	else                        { throw saftbus::Error(saftbus::Error::INVALID_ARGS, "IO channel unknown!"); }
-	cycle.close();
 
-	readBuTiSMultiplexer = readBuTiSMultiplexer&(1<<internal_id);
+	readBuTiSMultiplexer = readBuTiSMultiplexer&(eb_data_t(1)<<internal_id);
 	readBuTiSMultiplexer = readBuTiSMultiplexer>>internal_id;
 
 	if (readBuTiSMultiplexer) { return true; }
@@ -695,45 +579,35 @@ bool Io::getBuTiSMultiplexer() const
 
 void Io::setBuTiSMultiplexer(bool val)
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Mux_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Mux_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Mux_Set_low, io_control_addr+eGPIO_Mux_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Mux_Set_high, io_control_addr+eGPIO_Mux_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_Mux_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_Mux_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_Mux_Set_low, io_control_addr+eGPIO_Mux_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_Mux_Set_high, io_control_addr+eGPIO_Mux_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Mux_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Mux_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Mux_Set_low, io_control_addr+eLVDS_Mux_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Mux_Set_high, io_control_addr+eLVDS_Mux_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_Mux_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_Mux_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_Mux_Set_low, io_control_addr+eLVDS_Mux_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_Mux_Set_high, io_control_addr+eLVDS_Mux_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
-	cycle.close();
 	if (BuTiSMultiplexer) {
 		BuTiSMultiplexer(val);
 	}
@@ -741,33 +615,23 @@ void Io::setBuTiSMultiplexer(bool val)
 
 bool Io::getPPSMultiplexer() const
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 	eb_data_t readPPSMultiplexer;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eGPIO_PPS_Mux_Set_low,  EB_DATA32, &readPPSMultiplexer); }
-		else                      { cycle.read(io_control_addr+eGPIO_PPS_Mux_Set_high, EB_DATA32, &readPPSMultiplexer); }
+		if (access_position == 0) { readPPSMultiplexer = io_shadow.read(io_control_addr+eGPIO_PPS_Mux_Set_low); }
+		else                      { readPPSMultiplexer = io_shadow.read(io_control_addr+eGPIO_PPS_Mux_Set_high); }
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
-		if (access_position == 0) { cycle.read(io_control_addr+eLVDS_PPS_Mux_Set_low,  EB_DATA32, &readPPSMultiplexer); }
-		else                      { cycle.read(io_control_addr+eLVDS_PPS_Mux_Set_high, EB_DATA32, &readPPSMultiplexer); }
+		if (access_position == 0) { readPPSMultiplexer = io_shadow.read(io_control_addr+eLVDS_PPS_Mux_Set_low); }
+		else                      { readPPSMultiplexer = io_shadow.read(io_control_addr+eLVDS_PPS_Mux_Set_high); }
 	}
 	else                        { throw saftbus::Error(saftbus::Error::INVALID_ARGS, "IO channel unknown!"); }
-	cycle.close();
 
-	readPPSMultiplexer = readPPSMultiplexer&(1<<internal_id);
+	readPPSMultiplexer = readPPSMultiplexer&(eb_data_t(1)<<internal_id);
 	readPPSMultiplexer = readPPSMultiplexer>>internal_id;
 
 	if (readPPSMultiplexer) { return true; }
@@ -776,45 +640,35 @@ bool Io::getPPSMultiplexer() const
 
 void Io::setPPSMultiplexer(bool val)
 {
-	unsigned access_position = 0;
-	unsigned internal_id = io_index;
-	etherbone::Cycle cycle;
-
-	/* Calculate access position (32bit access to 64bit register)*/
-	if (io_index>31)
-	{
-		internal_id = io_index-31;
-		access_position = 1;
-	}
+	unsigned access_position = config_word(io_index);
+	unsigned internal_id     = config_bit(io_index);
 
-	cycle.open(device);
 	if (io_channel == IO_CFG_CHANNEL_GPIO)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_PPS_Mux_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_PPS_Mux_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_PPS_Mux_Set_low, io_control_addr+eGPIO_PPS_Mux_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_PPS_Mux_Set_high, io_control_addr+eGPIO_PPS_Mux_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eGPIO_PPS_Mux_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eGPIO_PPS_Mux_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eGPIO_PPS_Mux_Set_low, io_control_addr+eGPIO_PPS_Mux_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eGPIO_PPS_Mux_Set_high, io_control_addr+eGPIO_PPS_Mux_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
 	else if (io_channel == IO_CFG_CHANNEL_LVDS)
 	{
 		if (val)
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_PPS_Mux_Set_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_PPS_Mux_Set_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_PPS_Mux_Set_low, io_control_addr+eLVDS_PPS_Mux_Set_low, (eb_data_t(1)<<internal_id), true); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_PPS_Mux_Set_high, io_control_addr+eLVDS_PPS_Mux_Set_high, (eb_data_t(1)<<internal_id), true); }
 		}
 		else
 		{
-			if (access_position == 0) { cycle.write(io_control_addr+eLVDS_PPS_Mux_Reset_low,  EB_DATA32, (1<<internal_id)); }
-			else                      { cycle.write(io_control_addr+eLVDS_PPS_Mux_Reset_high, EB_DATA32, (1<<internal_id)); }
+			if (access_position == 0) { io_shadow.modify(io_control_addr+eLVDS_PPS_Mux_Set_low, io_control_addr+eLVDS_PPS_Mux_Reset_low, (eb_data_t(1)<<internal_id), false); }
+			else                      { io_shadow.modify(io_control_addr+eLVDS_PPS_Mux_Set_high, io_control_addr+eLVDS_PPS_Mux_Reset_high, (eb_data_t(1)<<internal_id), false); }
 		}
 	}
-	cycle.close();
 	if (PPSMultiplexer) {
 		PPSMultiplexer(val);
 	}
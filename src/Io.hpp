@@ -35,6 +35,7 @@
 namespace saftlib {
 
 class SerdesClockGen;
+class RegisterShadow;
 
 /// @brief representaion of a single IO on a TimingReceiver
 ///
@@ -58,6 +59,7 @@ class Io {
 	bool io_spec_out_available;
 	bool io_spec_in_available;
 	eb_address_t io_control_addr;
+	RegisterShadow &io_shadow; // shadow registers of IoControl
 	SerdesClockGen &io_clkgen;
 public:
 	Io(etherbone::Device &device
@@ -74,11 +76,20 @@ public:
 	   , bool io_spec_out_available
 	   , bool io_spec_in_available
 	   , eb_address_t io_control_addr
+	   , RegisterShadow &shadow
 	   , SerdesClockGen &clkgen
 	);
 
+	/// @brief position of an IO in the 64-bit IO configuration registers (OE, termination, special purpose, gate, ...)
+	///
+	/// Each of these registers is accessed as two 32-bit words, the _low word holds the IOs 0..31, the _high word the IOs 32..63.
+	/// config_word is 0 for the _low and 1 for the _high word, config_bit is the bit position in that word.
+	static unsigned config_word(unsigned index) { return index / 32; }
+	static unsigned config_bit(unsigned index)  { return index % 32; }
+
 	const std::string &getName() const;
 	unsigned getDirection() const;
+	unsigned getChannel() const;
 	// iOutputActionSink
 	uint32_t getIndexOut() const;
 	uint32_t getIndexIn() const;
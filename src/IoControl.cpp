@@ -24,14 +24,88 @@
 #include "io_control_regs.h"
 
 #include "Io.hpp"
+#include "SdbCache.hpp"
 
 #include <saftbus/error.hpp>
 
 #include <vector>
 #include <iostream>
+#include <algorithm>
 
 namespace saftlib {
 
+// number of IO map table words that are read in one etherbone cycle
+const unsigned IO_TABLE_WORDS_PER_CYCLE = 256;
+
+// properties in the IO state snapshot that are stored as bitmask (one bit per IO) in the IO_CONTROL device. 
+// The registers are given for GPIO and LVDS channels (IO_CFG_CHANNEL_GPIO, IO_CFG_CHANNEL_LVDS),
+// the register for IOs with index > 31 follows the _low register.
+struct IoStateRegister {
+	const char *name;
+	unsigned    set_low[2];
+};
+static const IoStateRegister io_state_registers[] = {
+	{"OutputEnable",      {eGPIO_Oe_Set_low,       eLVDS_Oe_Set_low      }},
+	{"InputTermination",  {eGPIO_Term_Set_low,     eLVDS_Term_Set_low    }},
+	{"SpecialPurposeIn",  {eGPIO_Spec_In_Set_low,  eLVDS_Spec_In_Set_low }},
+	{"SpecialPurposeOut", {eGPIO_Spec_Out_Set_low, eLVDS_Spec_Out_Set_low}},
+	{"BuTiSMultiplexer",  {eGPIO_Mux_Set_low,      eLVDS_Mux_Set_low     }},
+	{"PPSMultiplexer",    {eGPIO_PPS_Mux_Set_low,  eLVDS_PPS_Mux_Set_low }},
+	{"GateIn",            {eGPIO_Gate_In_Set_low,  eLVDS_Gate_In_Set_low }},
+	{"GateOut",           {eGPIO_Gate_Out_Set_low, eLVDS_Gate_Out_Set_low}},
+};
+static const unsigned io_state_registers_size = sizeof(io_state_registers)/sizeof(io_state_registers[0]);
+
+// data: gpio_info, lvds_info, fixed count, IO map table
+void IoControl::read_io_table(etherbone::Device &device, eb_address_t adr_first, std::vector<eb_data_t> &data)
+{
+	eb_data_t gpio_info, lvds_info, fixed_count_reg;
+	etherbone::Cycle cycle;
+
+	/* Get number of IOs */
+	cycle.open(device);
+	cycle.read(adr_first+eGPIO_Info, EB_DATA32, &gpio_info);
+	cycle.read(adr_first+eLVDS_Info, EB_DATA32, &lvds_info);
+	cycle.read(adr_first+eFIXED_Info, EB_DATA32, &fixed_count_reg);
+	cycle.close();
+	unsigned io_GPIOTotal  = (gpio_info&IO_INFO_TOTAL_COUNT_MASK) >> IO_INFO_TOTAL_SHIFT;
+	unsigned io_LVDSTotal  = (lvds_info&IO_INFO_TOTAL_COUNT_MASK) >> IO_INFO_TOTAL_SHIFT;
+	unsigned io_FixedTotal = fixed_count_reg;
+
+	if (io_GPIOTotal > IO_GPIO_MAX || io_LVDSTotal > IO_LVDS_MAX || io_FixedTotal > IO_FIXED_MAX) {
+		throw saftbus::Error(saftbus::Error::FAILED, "IO map table has more entries than supported");
+	}
+
+	/* Read the whole IO map table into memory, many words per cycle */
+	unsigned io_table_words = io_GPIOTotal*4 + io_LVDSTotal*4 + io_FixedTotal*4;
+	data.resize(3 + io_table_words);
+	data[0] = gpio_info;
+	data[1] = lvds_info;
+	data[2] = fixed_count_reg;
+	for (unsigned block_start = 0; block_start < io_table_words; block_start += IO_TABLE_WORDS_PER_CYCLE)
+	{
+		unsigned block_end = std::min(block_start + IO_TABLE_WORDS_PER_CYCLE, io_table_words);
+		cycle.open(device);
+		for (unsigned io_table_iterator = block_start; io_table_iterator < block_end; io_table_iterator++)
+		{
+			unsigned io_table_addr = eIO_Map_Table_Begin + io_table_iterator*4;
+			cycle.read(adr_first+io_table_addr, EB_DATA32, &data[3+io_table_iterator]);
+		}
+		cycle.close();
+	}
+}
+
+bool IoControl::prefetch(etherbone::Device &device, std::vector<eb_data_t> &data)
+{
+	std::vector<sdb_device> ioctl;
+	SdbCache::find_by_identity(device, IO_CONTROL_VENDOR_ID, IO_CONTROL_PRODUCT_ID, ioctl);
+	if (ioctl.empty()) {
+		return false;
+	}
+	read_io_table(device, ioctl[0].sdb_component.addr_first, data);
+	return true;
+}
+
 IoControl::IoControl(etherbone::Device &device)
 	: SdbDevice(device, IO_CONTROL_VENDOR_ID,     IO_CONTROL_PRODUCT_ID)
 	, clkgen(device)
@@ -41,39 +115,30 @@ IoControl::IoControl(etherbone::Device &device)
 	unsigned io_table_iterator       = 0;
 	unsigned io_table_entry_iterator = 0;
 	unsigned io_table_data_raw       = 0;
-	unsigned io_table_addr           = 0;
 	unsigned io_GPIOTotal            = 0;
 	unsigned io_LVDSTotal            = 0;
 	unsigned io_FixedTotal           = 0;
+	unsigned io_table_words          = 0;
 	s_IOCONTROL_SetupField s_aIOCONTROL_SetupField[IO_GPIO_MAX+IO_LVDS_MAX+IO_FIXED_MAX];
-	eb_data_t gpio_count_reg;
-	eb_data_t lvds_count_reg;
-	eb_data_t fixed_count_reg;
-	eb_data_t get_param;
-	etherbone::Cycle cycle;
 	std::vector<sdb_device> ioctl, tlus;
 
-	/* Get number of IOs */
-	cycle.open(device);
-	cycle.read(adr_first+eGPIO_Info, EB_DATA32, &gpio_count_reg);
-	cycle.read(adr_first+eLVDS_Info, EB_DATA32, &lvds_count_reg);
-	cycle.read(adr_first+eFIXED_Info, EB_DATA32, &fixed_count_reg);
-	cycle.close();
-	io_GPIOTotal  = (gpio_count_reg&IO_INFO_TOTAL_COUNT_MASK) >> IO_INFO_TOTAL_SHIFT;
-	io_LVDSTotal  = (lvds_count_reg&IO_INFO_TOTAL_COUNT_MASK) >> IO_INFO_TOTAL_SHIFT;
-	io_FixedTotal = fixed_count_reg;
+	/* Get number of IOs and the IO map table, unless a prefetch worker has read them already */
+	std::vector<eb_data_t> data;
+	if (!SdbCache::take_prefetched(device, "IoControl", data)) {
+		read_io_table(device, adr_first, data);
+	}
+	gpio_info = data[0];
+	lvds_info = data[1];
+	io_GPIOTotal  = (gpio_info&IO_INFO_TOTAL_COUNT_MASK) >> IO_INFO_TOTAL_SHIFT;
+	io_LVDSTotal  = (lvds_info&IO_INFO_TOTAL_COUNT_MASK) >> IO_INFO_TOTAL_SHIFT;
+	io_FixedTotal = data[2];
+	io_table_words = io_GPIOTotal*4 + io_LVDSTotal*4 + io_FixedTotal*4;
+	const eb_data_t *io_table = data.data() + 3;
 
-	/* Read IO information */
-	for (io_table_iterator = 0; io_table_iterator < (io_GPIOTotal*4 + io_LVDSTotal*4 + io_FixedTotal*4); io_table_iterator++)
+	/* Decode IO information */
+	for (io_table_iterator = 0; io_table_iterator < io_table_words; io_table_iterator++)
 	{
-		/* Read memory region */
-		io_table_addr = eIO_Map_Table_Begin + io_table_iterator*4;
-
-		/* Open a new cycle and get the parameter */
-		cycle.open(device);
-		cycle.read(adr_first+io_table_addr, EB_DATA32, &get_param);
-		cycle.close();
-		io_table_data_raw = (unsigned) get_param;
+		io_table_data_raw = (unsigned) io_table[io_table_iterator];
 
 		if(io_table_entry_iterator < 3) /* Get the IO name */
 		{
@@ -96,6 +161,16 @@ IoControl::IoControl(etherbone::Device &device)
 		}
 	}
 
+	/* Only saftlib changes the IO configuration bits, they can be read from the shadow registers */
+	shadow.setPolicy(adr_first+eGPIO_Info, RegisterShadow::CACHEABLE);
+	shadow.setPolicy(adr_first+eLVDS_Info, RegisterShadow::CACHEABLE);
+	for (unsigned reg = 0; reg < io_state_registers_size; ++reg) {
+		for (unsigned channel = IO_CFG_CHANNEL_GPIO; channel <= IO_CFG_CHANNEL_LVDS; ++channel) {
+			shadow.setPolicy(adr_first+io_state_registers[reg].set_low[channel],   RegisterShadow::CACHEABLE);
+			shadow.setPolicy(adr_first+io_state_registers[reg].set_low[channel]+4, RegisterShadow::CACHEABLE);
+		}
+	}
+
 	// std::cerr << "************** NUM IOS " << (io_GPIOTotal + io_LVDSTotal) << std::endl;
 	// /* Create an action sink for each IO */
 	unsigned eca_in = 0, eca_out = 0;
@@ -137,7 +212,7 @@ IoControl::IoControl(etherbone::Device &device)
 
 		/* Create the IO controller object */
 		ios.push_back(Io(device, IOName, direction, channel, eca_in, eca_out, internal_id, special, logic_level, oe_available,
-	 		term_available, spec_out_available, spec_in_available, adr_first, clkgen));
+	 		term_available, spec_out_available, spec_in_available, adr_first, shadow, clkgen));
 
 		if (direction == IO_CFG_FIELD_DIR_OUTPUT || direction == IO_CFG_FIELD_DIR_INOUT) ++eca_out;
 		if (direction == IO_CFG_FIELD_DIR_INPUT  || direction == IO_CFG_FIELD_DIR_INOUT) ++eca_in;
@@ -149,6 +224,100 @@ std::vector<Io> & IoControl::get_ios()
 	return ios;
 }
 
+std::vector<std::string> IoControl::CheckRegisterShadow()
+{
+	return shadow.check();
+}
+
+void IoControl::InvalidateRegisterShadow()
+{
+	shadow.invalidate();
+}
+
+std::map< std::string, std::vector<uint8_t> > IoControl::ReadAllIoStates(std::vector< std::string > &names)
+{
+	eb_data_t bits[io_state_registers_size][2][2]; // [property][channel][low/high]
+	std::vector<eb_data_t> input(ios.size(), 0);
+	std::vector<eb_data_t> output(ios.size(), 0);
+	std::vector<eb_data_t> combined_output(ios.size(), 0);
+
+	etherbone::Cycle cycle;
+	cycle.open(device);
+	for (unsigned reg = 0; reg < io_state_registers_size; ++reg) {
+		for (unsigned channel = IO_CFG_CHANNEL_GPIO; channel <= IO_CFG_CHANNEL_LVDS; ++channel) {
+			cycle.read(adr_first+io_state_registers[reg].set_low[channel],   EB_DATA32, &bits[reg][channel][0]);
+			cycle.read(adr_first+io_state_registers[reg].set_low[channel]+4, EB_DATA32, &bits[reg][channel][1]);
+		}
+	}
+	for (unsigned i = 0; i < ios.size(); ++i) {
+		eb_address_t out_begin, in_begin;
+		eb_data_t info;
+		if      (ios[i].getChannel() == IO_CFG_CHANNEL_GPIO) { out_begin = eSet_GPIO_Out_Begin; in_begin = eGet_GPIO_In_Begin; info = gpio_info; }
+		else if (ios[i].getChannel() == IO_CFG_CHANNEL_LVDS) { out_begin = eSet_LVDS_Out_Begin; in_begin = eGet_LVDS_In_Begin; info = lvds_info; }
+		else                                                 { continue; }
+		// the combined output registers follow the input registers (same as in Io::ReadCombinedOutput)
+		unsigned total_inputs = ((info&IO_INFO_IN_COUNT_MASK) >> IO_INFO_IN_SHIFT) + ((info&IO_INFO_INOUT_COUNT_MASK) >> IO_INFO_INOUT_SHIFT);
+		unsigned index = ios[i].getIndexOut();
+		if (ios[i].getDirection() != IO_CFG_FIELD_DIR_INPUT) {
+			cycle.read(adr_first+out_begin+index*4,                  EB_DATA32, &output[i]);
+			cycle.read(adr_first+in_begin+total_inputs*4+index*4,    EB_DATA32, &combined_output[i]);
+		}
+		if (ios[i].getDirection() != IO_CFG_FIELD_DIR_OUTPUT) {
+			cycle.read(adr_first+in_begin+index*4,                   EB_DATA32, &input[i]);
+		}
+	}
+	cycle.close();
+
+	names.clear();
+	std::map< std::string, std::vector<uint8_t> > states;
+	for (unsigned i = 0; i < ios.size(); ++i) {
+		names.push_back(ios[i].getName());
+		states["Direction"].push_back(ios[i].getDirection());
+		states["Output"].push_back(output[i] != 0);
+		states["CombinedOutput"].push_back(combined_output[i] != 0);
+		states["Input"].push_back(input[i] != 0);
+		unsigned channel = ios[i].getChannel();
+		unsigned index   = ios[i].getIndexOut();
+		for (unsigned reg = 0; reg < io_state_registers_size; ++reg) {
+			uint8_t bit = 0;
+			if (channel == IO_CFG_CHANNEL_GPIO || channel == IO_CFG_CHANNEL_LVDS) {
+				bit = (bits[reg][channel][Io::config_word(index)] >> Io::config_bit(index)) & 1;
+			}
+			states[io_state_registers[reg].name].push_back(bit);
+		}
+	}
+	return states;
+}
+
+void IoControl::WriteOutputs(const std::vector<uint8_t> &mask, const std::vector<uint8_t> &values)
+{
+	if (mask.size() != ios.size() || values.size() != ios.size()) {
+		throw saftbus::Error(saftbus::Error::INVALID_ARGS, "mask and values need one entry per IO");
+	}
+	// check all IOs before anything is written
+	for (unsigned i = 0; i < ios.size(); ++i) {
+		if (!mask[i]) continue;
+		if (ios[i].getDirection() == IO_CFG_FIELD_DIR_INPUT) {
+			throw saftbus::Error(saftbus::Error::INVALID_ARGS, ios[i].getName() + " is not an output");
+		}
+		if (ios[i].getChannel() != IO_CFG_CHANNEL_GPIO && ios[i].getChannel() != IO_CFG_CHANNEL_LVDS) {
+			throw saftbus::Error(saftbus::Error::INVALID_ARGS, "IO channel unknown!");
+		}
+	}
+	etherbone::Cycle cycle;
+	cycle.open(device);
+	for (unsigned i = 0; i < ios.size(); ++i) {
+		if (!mask[i]) continue;
+		unsigned index = ios[i].getIndexOut();
+		if (ios[i].getChannel() == IO_CFG_CHANNEL_GPIO) {
+			cycle.write(adr_first+eSet_GPIO_Out_Begin+index*4, EB_DATA32, values[i]?0x01:0x00);
+		} else {
+			cycle.write(adr_first+eSet_LVDS_Out_Begin+index*4, EB_DATA32, values[i]?0xff:0x00);
+		}
+	}
+	cycle.close();
+}
+
 
 
 }
@@ -33,6 +33,10 @@
 #include "SerdesClockGen.hpp"
 #include "SdbDevice.hpp"
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace saftlib {
 
 /// 
@@ -40,10 +44,34 @@ class IoControl : public SdbDevice {
 	SerdesClockGen clkgen;
 
 	std::vector<Io> ios;
+	eb_data_t gpio_info;
+	eb_data_t lvds_info;
+
+	static void read_io_table(etherbone::Device &device, eb_address_t adr_first, std::vector<eb_data_t> &data);
 public:
 	IoControl(etherbone::Device &device);
 
+	/// @brief read the IO map table in a prefetch worker (see SdbCache::PrefetchStep), the constructor takes it over
+	static bool prefetch(etherbone::Device &device, std::vector<eb_data_t> &data);
+
 	std::vector<Io> & get_ios();
+
+	/// @brief compare the shadow copies of the IO configuration registers with the hardware
+	/// @return one line per register where shadow and hardware differ
+	std::vector<std::string> CheckRegisterShadow();
+
+	/// @brief the next read of each IO configuration register goes to the hardware
+	void InvalidateRegisterShadow();
+
+	/// @brief read the state of all IOs in one etherbone cycle
+	/// @param names is filled with the IO names
+	/// @return one vector per property, with one entry (0 or 1) per IO in the same order as names
+	std::map< std::string, std::vector<uint8_t> > ReadAllIoStates(std::vector< std::string > &names);
+
+	/// @brief drive many outputs in one etherbone cycle
+	/// @param mask one entry per IO in the order of ReadAllIoStates; only IOs with nonzero mask are written
+	/// @param values the output values, same order as mask
+	void WriteOutputs(const std::vector<uint8_t> &mask, const std::vector<uint8_t> &values);
 };
 
 }
@@ -20,13 +20,16 @@
 
 #include "LM32Cluster.hpp"
 #include "TimingReceiver.hpp"
+#include "SdbCache.hpp"
+#include "CommonFunctions.hpp"
 
 #include <saftbus/error.hpp>
 
 #include <iostream>
 #include <cassert>
 #include <sstream>
-#include <fstream>
+#include <algorithm>
+
 
 #define LM32_RAM_USER_VENDOR      0x0651             // vendor ID
 #define LM32_RAM_USER_PRODUCT     0x54111351         // product ID
@@ -51,7 +54,7 @@ LM32Cluster::LM32Cluster(etherbone::Device &dev, TimingReceiver *timing_receiver
 
 	// look for lm32 dual port ram
 	std::vector<sdb_device> dpram_lm32_devs;
-	device.sdb_find_by_identity(LM32_RAM_USER_VENDOR, LM32_RAM_USER_PRODUCT, dpram_lm32_devs);
+	SdbCache::find_by_identity(device, LM32_RAM_USER_VENDOR, LM32_RAM_USER_PRODUCT, dpram_lm32_devs);
 
 	if (dpram_lm32_devs.size() < 1) {
 		std::cerr << "Warning: no lm32 user ram found on hardware" << std::endl;
@@ -84,6 +87,38 @@ unsigned LM32Cluster::getCpuCount()
 	return dpram_lm32_adr_first.size();
 }
 
+// LM32 RAM is written and read with this many words per etherbone cycle.
+// Etherbone splits long cycles into as many packets as needed, large cycles avoid the round trip per cycle.
+const unsigned LM32_RAM_WORDS_PER_CYCLE = 1024;
+
+static void write_ram(etherbone::Device &device, eb_address_t adr, const std::vector<uint32_t> &words)
+{
+	for (unsigned block = 0; block < words.size(); block += LM32_RAM_WORDS_PER_CYCLE) {
+		unsigned block_end = std::min<size_t>(block + LM32_RAM_WORDS_PER_CYCLE, words.size());
+		etherbone::Cycle cycle;
+		cycle.open(device);
+		for (unsigned i = block; i < block_end; ++i) {
+			cycle.write(adr + 4*i, EB_DATA32, (eb_data_t)words[i]);
+		}
+		cycle.close();
+	}
+}
+
+static std::vector<uint32_t> read_ram(etherbone::Device &device, eb_address_t adr, unsigned size)
+{
+	std::vector<eb_data_t> buffer(size);
+	for (unsigned block = 0; block < size; block += LM32_RAM_WORDS_PER_CYCLE) {
+		unsigned block_end = std::min(block + LM32_RAM_WORDS_PER_CYCLE, size);
+		etherbone::Cycle cycle;
+		cycle.open(device);
+		for (unsigned i = block; i < block_end; ++i) {
+			cycle.read(adr + 4*i, EB_DATA32, &buffer[i]);
+		}
+		cycle.close();
+	}
+	return std::vector<uint32_t>(buffer.begin(), buffer.end());
+}
+
 void LM32Cluster::SafeHaltCpu(unsigned cpu_idx)
 {
 	if (cpu_idx >= num_cores) {
@@ -94,20 +129,12 @@ void LM32Cluster::SafeHaltCpu(unsigned cpu_idx)
 	// overwrite the RAM with trap instructions (a trap instruction is a jump to the address of the flummi instruction)
 	eb_address_t adr = dpram_lm32_adr_first[cpu_idx];
 	eb_address_t last = dpram_lm32_adr_last[cpu_idx];
-	eb_data_t jump_instruction = 0xe0000000;
-	while (adr < last) {
-		etherbone::Cycle cycle;
-		cycle.open(device);
-		for (int i = 0; i < 32 && adr < last; ++i) {
-			cycle.write(adr, EB_DATA32, (eb_data_t)jump_instruction);
-			adr += 4;
-		}
-		cycle.close();
-	}
+	uint32_t jump_instruction = 0xe0000000;
+	write_ram(device, adr, std::vector<uint32_t>((last-adr+1)/4, jump_instruction));
 	tr->CpuHalt(cpu_idx);
 }
 
-void LM32Cluster::WriteFirmware(unsigned cpu_idx, const std::string &filename)
+void LM32Cluster::WriteFirmwareImage(unsigned cpu_idx, const std::vector<uint32_t> &image)
 {
 	if (cpu_idx >= num_cores) {
 		std::ostringstream msg;
@@ -116,36 +143,40 @@ void LM32Cluster::WriteFirmware(unsigned cpu_idx, const std::string &filename)
 	}
 	eb_address_t adr = dpram_lm32_adr_first[cpu_idx];
 	eb_address_t last = dpram_lm32_adr_last[cpu_idx];
-	std::ifstream firmware_bin(filename.c_str());
-	if (!firmware_bin) {
+	if (image.size() > (last-adr+1)/4) {
 		std::ostringstream msg;
-		msg << "cannot open firmware binary file " << filename;
+		msg << "firmware image has " << image.size() << " words, the lm32 ram only " << (last-adr+1)/4;
 		throw std::runtime_error(msg.str());
 	}
 
-	bool end_of_file = false;
-	while (adr < last) {
-		etherbone::Cycle cycle;
-		cycle.open(device);
-		for (int i = 0; i < 32 && adr < last; ++i) {
-			uint32_t instr, cpu_instr = 0;
-			firmware_bin.read((char*)&instr, sizeof(instr));
-			if (!firmware_bin) {
-				end_of_file = true;
-				break;
-			}
-			cpu_instr |= instr >> 24;
-			cpu_instr |= (0xff0000 & instr) >> 8;
-			cpu_instr |= (0x00ff00 & instr) << 8;
-			cpu_instr |= instr << 24;
-			cycle.write(adr, EB_DATA32, (eb_data_t)cpu_instr);
-			adr += 4;
-		}
-		cycle.close();
-		if (end_of_file) {
-			break;
-		}
+	write_ram(device, adr, image);
+
+	// verify by reading back the whole firmware in large cycles
+	std::vector<uint32_t> readback = read_ram(device, adr, image.size());
+	auto mismatch = std::mismatch(image.begin(), image.end(), readback.begin());
+	if (mismatch.first != image.end()) {
+		std::ostringstream msg;
+		msg << "firmware verification failed at address 0x" << std::hex << adr + 4*(mismatch.first-image.begin()) 
+		    << ": wrote 0x" << *mismatch.first << ", read 0x" << *mismatch.second;
+		throw std::runtime_error(msg.str());
+	}
+}
+
+void LM32Cluster::WriteFirmware(unsigned cpu_idx, const std::string &filename)
+{
+	if (cpu_idx >= num_cores) {
+		std::ostringstream msg;
+		msg << "there is no user cpu core with index " << cpu_idx;
+		throw std::runtime_error(msg.str());
+	}
+	eb_address_t adr = dpram_lm32_adr_first[cpu_idx];
+	eb_address_t last = dpram_lm32_adr_last[cpu_idx];
+	std::vector<uint32_t> firmware = read_firmware_image(filename);
+	if (firmware.size() > (last-adr+1)/4) {
+		std::cerr << "firmware binary file " << filename << " is larger than the lm32 ram, it is truncated" << std::endl;
+		firmware.resize((last-adr+1)/4);
 	}
+	WriteFirmwareImage(cpu_idx, firmware);
 }
 
 } // namespace
@@ -70,6 +70,20 @@ public:
 	// @saftbus-export
 	void SafeHaltCpu(unsigned cpu_idx);
 
+	/// @brief load a firmware image into the ram of cpu[cpu_idx] and verify it by reading it back.
+	/// @param cpu_idx identifies the cpu 
+	/// @param image the content of a firmware binary file (.bin), converted from big endian to host byte order
+	///
+	/// The cpu should be halted with SafeHaltCpu before and can be restarted with CpuReset afterwards.
+	/// saft-ecpu-ctl -w reads the file and calls this function.
+	// @saftbus-export
+	void WriteFirmwareImage(unsigned cpu_idx, const std::vector<uint32_t> &image);
+
+	/// @brief same as WriteFirmwareImage, but the image is read from a file.
+	/// @param filename a firmware binary file (.bin) on the host where saftbusd runs
+	///
+	/// This is for firmware drivers that run inside saftbusd. It is not exported because
+	/// saftbusd would open any file a client names.
 	void WriteFirmware(unsigned cpu_idx, const std::string &filename);
 };
 
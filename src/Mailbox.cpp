@@ -33,27 +33,77 @@ namespace saftlib {
 Mailbox::Mailbox(etherbone::Device &dev)
 	: MsiDevice(dev, MAILBOX_VENDOR_ID, MAILBOX_DEVICE_ID) 
 	, device(dev)
+	, occupied_valid(false)
 {
 	mailbox = adr_first;
 	mailbox_msi_first = msi_device.msi_first;
+	for (auto &word: occupied) {
+		word = 0;
+	}
 }
 
-std::unique_ptr<Mailbox::Slot> Mailbox::ConfigureSlot(uint32_t target_address) 
+void Mailbox::ReadSlotTable()
 {
-	const auto num_slots = 128;
-	eb_data_t mb_value;
-	unsigned slot_index = 0;
+	// read the value word of all slots in one cycle
+	eb_data_t mb_values[num_slots];
+	etherbone::Cycle cycle;
+	cycle.open(device);
+	for (unsigned slot_index = 0; slot_index < num_slots; ++slot_index) {
+		cycle.read(mailbox + slot_index * 4 * 2, EB_DATA32, &mb_values[slot_index]);
+	}
+	cycle.close();
 
-	for (slot_index = 0; slot_index < num_slots; ++slot_index) {
-		device.read(mailbox + slot_index * 4 * 2, EB_DATA32, &mb_value);
-		if (mb_value == 0xffffffff) {
-			break;
+	for (auto &word: occupied) {
+		word = 0;
+	}
+	for (unsigned slot_index = 0; slot_index < num_slots; ++slot_index) {
+		if (mb_values[slot_index] != 0xffffffff) {
+			occupied[slot_index/64] |= UINT64_C(1) << (slot_index%64);
 		}
 	}
+	occupied_valid = true;
+}
 
-	if (slot_index < num_slots) {
-		device.write(mailbox + slot_index * 4 * 2 + 4, EB_DATA32, (eb_data_t)target_address);
-		return std::unique_ptr<Mailbox::Slot>(new Mailbox::Slot(this, slot_index));
+int Mailbox::FindFreeSlot(unsigned first_index) const
+{
+	for (unsigned word = first_index/64; word < num_slots/64; ++word) {
+		uint64_t free_bits = ~occupied[word];
+		if (word == first_index/64) {
+			free_bits &= ~UINT64_C(0) << (first_index%64); // ignore slots below first_index
+		}
+		if (free_bits) {
+			return word*64 + __builtin_ctzll(free_bits);
+		}
+	}
+	return -1;
+}
+
+std::unique_ptr<Mailbox::Slot> Mailbox::ConfigureSlot(uint32_t target_address, unsigned first_index) 
+{
+	if (!occupied_valid) {
+		ReadSlotTable();
+	}
+
+	bool table_reread = false;
+	for (;;) {
+		int slot_index = FindFreeSlot(first_index);
+		if (slot_index == -1) {
+			if (table_reread) {
+				break;
+			}
+			// slots may have been freed by others in the meantime
+			ReadSlotTable();
+			table_reread = true;
+			continue;
+		}
+		// revalidate the chosen slot only
+		eb_data_t mb_value;
+		device.read(mailbox + slot_index * 4 * 2, EB_DATA32, &mb_value);
+		occupied[slot_index/64] |= UINT64_C(1) << (slot_index%64);
+		if (mb_value == 0xffffffff) {
+			device.write(mailbox + slot_index * 4 * 2 + 4, EB_DATA32, (eb_data_t)target_address);
+			return std::unique_ptr<Mailbox::Slot>(new Mailbox::Slot(this, slot_index));
+		}
 	}
 	std::cerr << "no free mailbox slots " << std::endl;
 	return std::unique_ptr<Mailbox::Slot>();
@@ -67,6 +117,7 @@ void Mailbox::UseSlot(int slot_index, uint32_t value)
 void Mailbox::FreeSlot(int slot_index)
 {
 	device.write(mailbox + slot_index * 4 * 2 + 4, EB_DATA32, 0xffffffff);
+	occupied[slot_index/64] &= ~(UINT64_C(1) << (slot_index%64));
 }
 
 Mailbox::Slot::Slot(Mailbox *mailbox, int index) 
@@ -41,6 +41,17 @@ class Mailbox : public MsiDevice {
 	eb_address_t mailbox_msi_first;
 	friend class Slot;
 
+	static const unsigned num_slots = 128;
+	// Daemon side view of the slot table, one bit per slot, 1 = occupied.
+	// Filled from the hardware with one cycle when the first slot is configured.
+	// Slots can also be taken by others (e.g. LM32 firmware), therefore a slot 
+	// that appears free is checked again in hardware before it is used.
+	uint64_t occupied[num_slots/64];
+	bool occupied_valid;
+
+	void ReadSlotTable();
+	int FindFreeSlot(unsigned first_index) const;
+
 	/// @brief if a slot is no longer used, it should be marked as free by using this function
 	///
 	/// This is a private method because only Mailbox::Slot object should call it in the destructor
@@ -81,9 +92,10 @@ public:
 	Mailbox(etherbone::Device &device);
 	/// @brief find a free slot in the mailbox and configure it with target_address
 	/// @param target_address specifies to which address the value in UseSlot will be written
-	/// @return the slot number which was used, -1 if no free slot was found
+	/// @param first_index the lowest slot index that may be used
+	/// @return the slot which was configured, an invalid unique_ptr if no free slot was found
 	///
-	std::unique_ptr<Slot> ConfigureSlot(uint32_t target_address);
+	std::unique_ptr<Slot> ConfigureSlot(uint32_t target_address, unsigned first_index = 0);
 };
 
 }
@@ -28,10 +28,13 @@
 #include <assert.h>
 #include <algorithm>
 #include <time.h>
+#include <thread>
 
 // #include "RegisteredObject.h"
 #include "MasterFunctionGenerator.hpp"
 #include <TimingReceiver.hpp>
+#include <SoftwareActionSink.hpp>
+#include <SoftwareCondition.hpp>
 #include "fg_regs.h"
 // #include "clog.h"
 
@@ -56,6 +59,11 @@ MasterFunctionGenerator::MasterFunctionGenerator(saftbus::Container *container,
   , allFunctionGenerators(functionGenerators) 
   , activeFunctionGenerators(functionGenerators)
   , generateIndividualSignals(false)
+  , shm_mutex(nullptr)
+  , shm_format_version(0)
+  , shm_cache(nullptr)
+  , container(container)
+  , segment_sink(nullptr)
 {
   for (auto fg : allFunctionGenerators)
   {
@@ -79,6 +87,11 @@ MasterFunctionGenerator::~MasterFunctionGenerator()
     fg->signal_stopped.clear();
     fg->signal_refill.clear();
   }
+  for (auto &trigger : segment_triggers) {
+    trigger.second.action.disconnect();
+    trigger.second.destroyed.disconnect();
+  }
+  segment_sink_destroyed.disconnect();
   allFunctionGenerators.clear();
   activeFunctionGenerators.clear();
 }
@@ -178,6 +191,8 @@ void MasterFunctionGenerator::on_fg_stopped(std::shared_ptr<FunctionGeneratorImp
 
 void MasterFunctionGenerator::InitializeSharedMemory(const std::string& shared_memory_name)
 {
+  shm_cache = nullptr;
+  shm_mutex = nullptr;
   try 
   {
     shm_params.reset( new boost::interprocess::managed_shared_memory(boost::interprocess::open_only, shared_memory_name.c_str()));
@@ -194,13 +209,6 @@ void MasterFunctionGenerator::InitializeSharedMemory(const std::string& shared_m
     throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Shared memory is insane");
   }
   
-  shm_mutex = (shm_params->find<boost::interprocess::interprocess_mutex>("mutex")).first;
-  
-  if (!shm_mutex)
-  {
-    throw saftbus::Error(saftbus::Error::INVALID_ARGS, "No mutex in shared memory");
-  }
-
   int* version = (shm_params->find<int32_t>("format-version")).first;
   int format_version=0;
   if (version) {
@@ -209,12 +217,43 @@ void MasterFunctionGenerator::InitializeSharedMemory(const std::string& shared_m
   } else {
     //std::cout << "Shared memory format version not found" << std::endl;
   }
-  if (format_version < 0 || format_version > 0)
+  if (format_version < 0 || format_version > FG_PARAMETER_CACHE_FORMAT_VERSION)
   {
     throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Unsupported shared memory format version");
   }
-}
+  shm_format_version = format_version;
 
+  if (format_version == 0) {
+    shm_mutex = (shm_params->find<boost::interprocess::interprocess_mutex>("mutex")).first;
+    if (!shm_mutex)
+    {
+      throw saftbus::Error(saftbus::Error::INVALID_ARGS, "No mutex in shared memory");
+    }
+    return;
+  }
+
+  // format version 1: locate the flat parameter cache once, all later accesses go through shm_cache
+  std::pair<char*, std::size_t> block = shm_params->find<char>(FG_PARAMETER_CACHE_NAME);
+  if (!block.first || block.second < sizeof(FgParameterCacheHeader))
+  {
+    throw saftbus::Error(saftbus::Error::INVALID_ARGS, "No parameter cache in shared memory");
+  }
+  FgParameterCacheHeader *header = reinterpret_cast<FgParameterCacheHeader*>(block.first);
+  if (header->magic != FG_PARAMETER_CACHE_MAGIC || header->version != FG_PARAMETER_CACHE_FORMAT_VERSION)
+  {
+    throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Parameter cache has wrong magic number or version");
+  }
+  uint64_t index_size  = sizeof(FgParameterCacheEntry) * uint64_t(header->num_fgs) * header->num_beam_processes;
+  uint64_t tuples_size = uint64_t(FG_PARAMETER_CACHE_TUPLE_SIZE) * header->tuple_capacity;
+  if (header->index_offset  < sizeof(FgParameterCacheHeader) || 
+      header->index_offset  + index_size  > block.second ||
+      header->tuples_offset + tuples_size > block.second ||
+      header->tuples_offset % alignof(ParameterTuple) != 0)
+  {
+    throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Parameter cache dimensions exceed shared memory block");
+  }
+  shm_cache = header;
+}
 
 void MasterFunctionGenerator::AppendParameterTuplesForBeamProcess(int beam_process)
 {
@@ -224,6 +263,12 @@ void MasterFunctionGenerator::AppendParameterTuplesForBeamProcess(int beam_proce
     throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Shared memory not initialized");
   }
 
+  if (shm_format_version == FG_PARAMETER_CACHE_FORMAT_VERSION)
+  {
+    appendFromParameterCache(beam_process);
+    return;
+  }
+
   if (!shm_mutex)
   {
     throw saftbus::Error(saftbus::Error::INVALID_ARGS, "No mutex in shared memory");
@@ -285,6 +330,95 @@ void MasterFunctionGenerator::AppendParameterTuplesForBeamProcess(int beam_proce
 }
 
 
+// Format version 1: constant time lookup of the (fg,beam_process) range and one bulk copy 
+// into the fifo of each FG. The copy is validated against the sequence counter of the 
+// writer and repeated if the writer modified the cache in the meantime.
+void MasterFunctionGenerator::appendFromParameterCache(int beam_process)
+{
+  static_assert(sizeof(ParameterTuple) == FG_PARAMETER_CACHE_TUPLE_SIZE, "ParameterTuple does not match the shared memory layout");
+  const int max_attempts = 1000;
+
+  if (beam_process < 0 || static_cast<uint32_t>(beam_process) >= shm_cache->num_beam_processes)
+  {
+    throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Beam process not in parameter cache");
+  }
+  const FgParameterCacheEntry *index = fg_parameter_cache_index(shm_cache);
+  const ParameterTuple *tuples = reinterpret_cast<const ParameterTuple*>(fg_parameter_cache_tuples(shm_cache));
+
+  // All FGs are copied and validated first, and only committed when all copies are good.
+  // Otherwise the FGs would hold parameter sets of different beam processes.
+  struct Copied {
+    std::shared_ptr<FunctionGeneratorImpl> fg;
+    uint32_t count;
+    uint64_t duration;
+  };
+  std::vector<Copied> copied;
+  auto rollback = [&copied]() {
+    for (auto &c : copied)
+    {
+      c.fg->fifo_drop_back(c.count);
+    }
+  };
+  uint32_t fg_idx = 0;
+  for (auto fg : activeFunctionGenerators)
+  {
+    if (fg_idx >= shm_cache->num_fgs) 
+    {
+      break; // no data for the remaining FGs
+    }
+    uint32_t count = 0;
+    uint64_t duration = 0;
+    int attempt;
+    for (attempt = 0; attempt < max_attempts; ++attempt)
+    {
+      uint32_t sequence = shm_cache->sequence.load(std::memory_order_acquire);
+      if (sequence & 1) // writer is active
+      {
+        std::this_thread::yield();
+        continue;
+      }
+      FgParameterCacheEntry entry = index[fg_idx * shm_cache->num_beam_processes + beam_process];
+      if (entry.count > shm_cache->tuple_capacity || entry.first > shm_cache->tuple_capacity - entry.count) 
+      {
+        entry.count = 0; // torn read of the entry, the sequence check below will catch it
+      }
+      fg->fifo_append(tuples + entry.first, tuples + entry.first + entry.count);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (shm_cache->sequence.load(std::memory_order_relaxed) != sequence)
+      {
+        fg->fifo_drop_back(entry.count);
+        continue;
+      }
+      count = entry.count;
+      break;
+    }
+    if (attempt == max_attempts)
+    {
+      rollback();
+      throw saftbus::Error(saftbus::Error::FAILED, "Parameter cache is permanently being written");
+    }
+    copied.push_back(Copied{fg, count, 0});
+    // the copy is consistent now, validate it before any FG accounts for it
+    for (auto it = fg->fifo.end() - count; it != fg->fifo.end(); ++it)
+    {
+      if (it->step >= 8 || it->freq >= 8) 
+      {
+        rollback();
+        throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Parameter cache contains invalid step or freq");
+      }
+      duration += it->duration();
+    }
+    copied.back().duration = duration;
+    ++fg_idx;
+  }
+  for (auto &c : copied)
+  {
+    if (c.count > 0) 
+    {
+      c.fg->fifo_commit(c.duration);
+    }
+  }
+}
 	
 bool MasterFunctionGenerator::AppendParameterSets(
 	const std::vector< std::vector< int16_t > >& coeff_a, 
@@ -423,6 +557,8 @@ void MasterFunctionGenerator::ownerQuit()
   // owner quit without Disown? probably a crash => turn off all the function generators
   reset_all();
   activeFunctionGenerators = allFunctionGenerators;
+  // the conditions belonging to the owner are destroyed by the container
+  segments.clear();
 }
 
 void MasterFunctionGenerator::setStartTag(uint32_t val)
@@ -561,6 +697,153 @@ void MasterFunctionGenerator::SetActiveFunctionGenerators(const std::vector<std:
   }
 }
 
+void MasterFunctionGenerator::LoadSegment(const std::string &name,
+	const std::vector< std::vector< int16_t > >& coeff_a, 
+	const std::vector< std::vector< int16_t > >& coeff_b, 
+	const std::vector< std::vector< int32_t > >& coeff_c, 
+	const std::vector< std::vector< unsigned char > >& step, 
+	const std::vector< std::vector< unsigned char > >& freq, 
+	const std::vector< std::vector< unsigned char > >& shift_a, 
+	const std::vector< std::vector< unsigned char > >& shift_b)
+{
+  ownerOnly();
+
+  // confirm equal number of FGs
+  unsigned fgcount = coeff_a.size();
+  if (coeff_b.size() != fgcount) throw saftbus::Error(saftbus::Error::INVALID_ARGS, "coeff_b fgcount mismatch");
+  if (coeff_c.size() != fgcount) throw saftbus::Error(saftbus::Error::INVALID_ARGS, "coeff_c fgcount mismatch");
+  if (step.size()    != fgcount) throw saftbus::Error(saftbus::Error::INVALID_ARGS, "step fgcount mismatch");
+  if (freq.size()    != fgcount) throw saftbus::Error(saftbus::Error::INVALID_ARGS, "freq fgcount mismatch");
+  if (shift_a.size() != fgcount) throw saftbus::Error(saftbus::Error::INVALID_ARGS, "shift_a fgcount mismatch");
+  if (shift_b.size() != fgcount) throw saftbus::Error(saftbus::Error::INVALID_ARGS, "shift_b fgcount mismatch");
+
+  if (fgcount > activeFunctionGenerators.size()) throw saftbus::Error(saftbus::Error::INVALID_ARGS, "More datasets than function generators");	
+
+  Segment segment;
+  for (std::size_t i=0;i<fgcount;++i)
+  {
+    if (coeff_a[i].size()>0)
+    {
+      segment.push_back(std::make_pair(activeFunctionGenerators[i], 
+        FunctionGeneratorImpl::makeParameterTuples(coeff_a[i], coeff_b[i], coeff_c[i], step[i], freq[i], shift_a[i], shift_b[i])));
+    }
+  }
+  if (segment.empty()) throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Segment contains no data");
+  segments[name] = std::move(segment);
+}
+
+void MasterFunctionGenerator::RemoveSegment(const std::string &name)
+{
+  ownerOnly();
+  if (segments.erase(name) == 0) throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Segment not found " + name);
+  std::vector<SoftwareCondition*> conditions;
+  for (auto &trigger : segment_triggers) {
+    if (trigger.second.segment == name) conditions.push_back(trigger.first);
+  }
+  for (auto condition : conditions) {
+    remove_segment_condition(condition);
+  }
+}
+
+std::vector<std::string> MasterFunctionGenerator::ReadSegmentNames()
+{
+  std::vector<std::string> names;
+  for (auto &segment : segments)
+  {
+    names.push_back(segment.first);
+  }
+  return names;
+}
+
+void MasterFunctionGenerator::MapEventToSegment(uint64_t id, uint64_t mask, const std::string &segment)
+{
+  ownerOnly();
+  if (segments.find(segment) == segments.end()) throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Segment not found " + segment);
+  if (allFunctionGenerators.empty()) throw saftbus::Error(saftbus::Error::INVALID_ARGS, "No Function Generators available");
+
+  if (!segment_sink) {
+    // all FGs of this master live on the same timing receiver
+    TimingReceiver *tr = allFunctionGenerators[0]->tr;
+    segment_sink = tr->getSoftwareActionSink(tr->NewSoftwareActionSink(""));
+    segment_sink_destroyed = segment_sink->Destroyed.connect(sigc::mem_fun(*this, &MasterFunctionGenerator::on_segment_sink_destroyed));
+  }
+  SoftwareCondition *condition = segment_sink->getCondition(segment_sink->NewCondition(true, id, mask, 0));
+  SegmentTrigger &trigger = segment_triggers[condition];
+  trigger.segment   = segment;
+  trigger.action    = condition->SigAction.connect(sigc::bind(sigc::mem_fun(*this, &MasterFunctionGenerator::on_segment_event), segment));
+  trigger.destroyed = condition->Destroyed.connect(sigc::bind(sigc::mem_fun(*this, &MasterFunctionGenerator::on_segment_condition_destroyed), condition));
+}
+
+void MasterFunctionGenerator::ClearEventMap()
+{
+  ownerOnly();
+  while (!segment_triggers.empty()) {
+    remove_segment_condition(segment_triggers.begin()->first);
+  }
+}
+
+void MasterFunctionGenerator::remove_segment_condition(SoftwareCondition *condition)
+{
+  on_segment_condition_destroyed(condition);
+  if (container) {
+    condition->Destroy();
+  } else {
+    segment_sink->removeCondition(condition);
+  }
+}
+
+void MasterFunctionGenerator::on_segment_condition_destroyed(SoftwareCondition *condition)
+{
+  auto trigger = segment_triggers.find(condition);
+  if (trigger != segment_triggers.end()) {
+    trigger->second.action.disconnect();
+    trigger->second.destroyed.disconnect();
+    segment_triggers.erase(trigger);
+  }
+}
+
+void MasterFunctionGenerator::on_segment_sink_destroyed()
+{
+  // the conditions are gone together with the sink
+  for (auto &trigger : segment_triggers) {
+    trigger.second.action.disconnect();
+    trigger.second.destroyed.disconnect();
+  }
+  segment_triggers.clear();
+  segment_sink_destroyed.disconnect();
+  segment_sink = nullptr;
+}
+
+// runs in the daemon when a mapped event arrives: load the segment into the FGs and arm them
+void MasterFunctionGenerator::on_segment_event(uint64_t event, uint64_t param, saftlib::Time deadline, saftlib::Time executed, uint16_t flags, std::string name)
+{
+  auto segment = segments.find(name);
+  if (segment == segments.end()) {
+    return; // segment was removed
+  }
+  bool armed = false;
+  try {
+    for (auto &entry : segment->second) {
+      if (entry.first->enabled) {
+        throw saftbus::Error(saftbus::Error::FAILED, entry.first->GetName() + " is still enabled");
+      }
+    }
+    for (auto &entry : segment->second) {
+      entry.first->flush();
+      entry.first->appendParameterTuples(entry.second.cbegin(), entry.second.cend());
+    }
+    for (auto &entry : segment->second) {
+      entry.first->arm();
+    }
+    armed = true;
+  } catch (saftbus::Error &e) {
+    std::cerr << "MasterFunctionGenerator: cannot arm segment " << name << " for event 0x" << std::hex << event << std::dec << ": " << e.what() << std::endl;
+  } catch (etherbone::exception_t &e) {
+    std::cerr << "MasterFunctionGenerator: cannot arm segment " << name << " for event 0x" << std::hex << event << std::dec << ": " << e << std::endl;
+  }
+  SigSegmentTriggered(name, deadline, armed);
+}
+
 
 bool MasterFunctionGenerator::WaitTimeout()
 {
@@ -25,6 +25,7 @@
 //#include "interfaces/MasterFunctionGenerator.h"
 #include "Owned.hpp"
 #include "FunctionGeneratorImpl.hpp"
+#include "fg_parameter_cache.h"
 
 // @saftbus-export
 #include "Time.hpp"
@@ -40,6 +41,8 @@
 namespace saftlib {
 
 class TimingReceiver;
+class SoftwareActionSink;
+class SoftwareCondition;
 
 typedef boost::interprocess::allocator<ParameterTuple, boost::interprocess::managed_shared_memory::segment_manager>  ShmemAllocator;
 typedef boost::interprocess::vector<ParameterTuple, ShmemAllocator> ParameterVector;
@@ -101,9 +104,13 @@ class MasterFunctionGenerator : public Owned
 
     /// @brief Initialze a boost managed_shared_memory region
     ///
-    /// It should contain:
+    /// The int32_t "format-version" selects the layout (0 if not present).
+    /// Format version 0 should contain:
     /// mutex
-    /// ParameterVector
+    /// IndexMap of (fg,beam_process) -> ParameterVector
+    /// Format version 1 should contain:
+    /// a flat char array "ParameterCache" as described in fg_parameter_cache.h.
+    /// It is read without locking the mutex.
     /// 
     // @saftbus-export
     void InitializeSharedMemory(const std::string& shared_memory_name);
@@ -249,6 +256,55 @@ class MasterFunctionGenerator : public Owned
     // @saftbus-export
     void SetActiveFunctionGenerators(const std::vector<std::string> &names);
 
+    /// @brief Store a named waveform segment in the daemon.
+    ///
+    /// The arguments have the same format as in AppendParameterSets: one
+    /// coefficient vector per active FG, empty vectors for FGs without data.
+    /// The segment remembers which FGs were active when it was loaded.
+    /// A segment with the same name is replaced. 
+    /// Loading does not touch the FIFOs of the function generators, the data
+    /// is used when an event mapped with MapEventToSegment arrives.
+    ///
+    /// @param name  Name of the segment.
+    ///
+    // @saftbus-export
+    void LoadSegment(const std::string &name, const std::vector< std::vector< int16_t > >& coeff_a, const std::vector< std::vector< int16_t > >& coeff_b, const std::vector< std::vector< int32_t > >& coeff_c, const std::vector< std::vector< unsigned char > >& step, const std::vector< std::vector< unsigned char > >& freq, const std::vector< std::vector< unsigned char > >& shift_a, const std::vector< std::vector< unsigned char > >& shift_b);
+
+    /// @brief Remove a segment and all event mappings that refer to it.
+    ///
+    /// @param name  Name of the segment.
+    ///
+    // @saftbus-export
+    void RemoveSegment(const std::string &name);
+
+    /// @brief Read the names of all loaded segments.
+    /// @return  Names of all loaded segments.
+    ///
+    // @saftbus-export
+    std::vector<std::string> ReadSegmentNames();
+
+    /// @brief Arm the function generators with a segment when a timing event arrives.
+    ///
+    /// When an event matching id and mask arrives, the daemon flushes the FGs of 
+    /// the segment, fills them with the segment data and arms them, without any 
+    /// action of the client. Refilling while the FGs run is done from the same data.
+    /// The FGs are started as usual by the StartTag on the SCUbus, so the event
+    /// must arrive early enough before the StartTag for arming to complete.
+    /// If one of the FGs is still enabled when the event arrives, the segment is 
+    /// not armed. In both cases SigSegmentTriggered is emitted.
+    ///
+    /// @param id       Event ID to match incoming event IDs against
+    /// @param mask     Set of bits for which the event ID and id must agree
+    /// @param segment  Name of a loaded segment
+    ///
+    // @saftbus-export
+    void MapEventToSegment(uint64_t id, uint64_t mask, const std::string &segment);
+
+    /// @brief Remove all event to segment mappings.
+    ///
+    // @saftbus-export
+    void ClearEventMap();
+
 
     // Signals
 
@@ -319,6 +375,15 @@ class MasterFunctionGenerator : public Owned
     // @saftbus-export
     sigc::signal< void > AllArmed;
 
+    /// @brief An event mapped with MapEventToSegment arrived.
+    ///
+    /// @param segment  Name of the segment
+    /// @param deadline Execution time of the event
+    /// @param armed    true if the FGs were filled and armed, false if that failed
+    /// 
+    // @saftbus-export
+    sigc::signal< void , std::string , saftlib::Time , bool > SigSegmentTriggered;
+
 
     std::string getObjectPath();
 
@@ -338,6 +403,11 @@ class MasterFunctionGenerator : public Owned
     bool all_armed();
     bool all_stopped();
     bool WaitTimeout();
+    void appendFromParameterCache(int beam_process);
+    void on_segment_event(uint64_t event, uint64_t param, saftlib::Time deadline, saftlib::Time executed, uint16_t flags, std::string segment);
+    void on_segment_condition_destroyed(SoftwareCondition *condition);
+    void on_segment_sink_destroyed();
+    void remove_segment_condition(SoftwareCondition *condition);
     void waitForCondition(std::function<bool()> condition, int timeout_ms);
 
     //TimingReceiver *tr;
@@ -351,7 +421,22 @@ class MasterFunctionGenerator : public Owned
     std::map <int,std::vector<ParameterTuple>> parametersForBeamProcess;
     std::unique_ptr<boost::interprocess::managed_shared_memory> shm_params;
     boost::interprocess::interprocess_mutex* shm_mutex;
+    int shm_format_version;
+    FgParameterCacheHeader *shm_cache; // only for format version 1
     std::map<std::string,ParameterVector*> paramVectors;
+
+    // preloaded segments and the conditions that trigger them
+    typedef std::vector<std::pair<std::shared_ptr<FunctionGeneratorImpl>, std::vector<ParameterTuple> > > Segment;
+    struct SegmentTrigger {
+      std::string segment;
+      sigc::connection action;
+      sigc::connection destroyed;
+    };
+    saftbus::Container *container;
+    std::map<std::string, Segment> segments;
+    SoftwareActionSink *segment_sink;
+    sigc::connection segment_sink_destroyed;
+    std::map<SoftwareCondition*, SegmentTrigger> segment_triggers;
 };
 
 }
@@ -20,6 +20,7 @@
  */
 
 #include "MsiDevice.hpp"
+#include "SdbCache.hpp"
 
 #include <saftbus/error.hpp>
 
@@ -33,7 +34,7 @@ namespace saftlib {
         : SdbDevice(device, VENDOR_ID, DEVICE_ID)
     {
 		std::vector<etherbone::sdb_msi_device> msis;
-		device.sdb_find_by_identity_msi(VENDOR_ID, DEVICE_ID, msis);
+		SdbCache::find_by_identity_msi(device, VENDOR_ID, DEVICE_ID, msis);
 		if (msis.size() < 1) {
 			std::ostringstream msg;
 			msg << "no SDB-MSI device with VENDOR_ID=0x" << std::hex << std::setw(8) << std::setfill('0') << VENDOR_ID 
@@ -21,6 +21,7 @@
 
 #include "OpenDevice.hpp"
 #include "Mailbox.hpp"
+#include "SdbCache.hpp"
 #include "SAFTd.hpp"
 #include "eb-forward.hpp"
 
@@ -96,6 +97,7 @@ OpenDevice::OpenDevice(const etherbone::Socket &socket, const std::string& eb_pa
 {
 	std::cerr << "OpenDevice::OpenDevice(\"" << eb_path << "\")" << std::endl;
 	device.open(socket, etherbone_path.c_str());
+	sdb_cache = std::unique_ptr<SdbCache>(new SdbCache(device, etherbone_path));
 	stat(etherbone_path.c_str(), &dev_stat);
 	device.enable_msi(&first, &last);
 	mask = last-first;
@@ -122,7 +124,7 @@ OpenDevice::OpenDevice(const etherbone::Socket &socket, const std::string& eb_pa
 		// assume that only the /dev/ttyUSB<n> devices and /dev/pts/<n> devices need eb-forwarding
 		if (eb_path.find("/ttyUSB") != eb_path.npos || eb_path.find("/pts/") != eb_path.npos ) {
 			// std::cerr << "create forwarding device" << std::endl;
-			eb_forward = std::unique_ptr<EB_Forward>(new EB_Forward(eb_path, device));
+			eb_forward = std::unique_ptr<EB_Forward>(new EB_Forward(device));
 			eb_forward_path = eb_forward->eb_forward_path();
 		} 
 
@@ -136,6 +138,7 @@ OpenDevice::~OpenDevice()
 	saftbus::Loop::get_default().remove(poll_timeout_source);
 	saftbus::Loop::get_default().remove(poll_once);
 	chmod(etherbone_path.c_str(), dev_stat.st_mode);
+	sdb_cache.reset();
 	device.close();
 }
 
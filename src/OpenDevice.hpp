@@ -41,6 +41,7 @@ class SAFTd;
 class IRQ;
 class Mailbox;
 class EB_Forward;
+class SdbCache;
 /// @brief Holds etherbone::Device that is opened on construction and closed on destruction
 ///
 /// It remembers its etherbone path and restores the device settings before destruction.
@@ -58,6 +59,7 @@ protected:
 	std::string etherbone_path;
 	struct stat dev_stat;	
 	etherbone::Device device;
+	std::unique_ptr<SdbCache> sdb_cache; // all SDB lookups on device are served from this table
 
 public:
 	/// @brief open given etherbone_path on given socket. 
@@ -62,6 +62,11 @@ void Output::WriteOutput(bool value)
 	return io.WriteOutput(value);
 }
 
+void Output::checkWriteOutput() const
+{
+	ownerOnly();
+}
+
 bool Output::ReadOutput()
 {
 	return io.ReadOutput();
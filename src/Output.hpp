@@ -77,6 +77,11 @@ class Output : public ActionSink
 		// @saftbus-export
 		void WriteOutput(bool value);
 
+		/// @brief Throw an exception if the caller is not allowed to call WriteOutput.
+		///
+		/// Used by TimingReceiver::WriteOutputs, which drives many outputs at once.
+		void checkWriteOutput() const;
+
 
 		/// @brief Read the output state.
 		/// @return true if the output is enabled
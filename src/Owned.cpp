@@ -28,7 +28,7 @@
 
 namespace saftlib {
 
-	Owned::Owned(saftbus::Container *container) : cont(container), service(nullptr)
+	Owned::Owned(saftbus::Container *container) : cont(container), service(nullptr), service_released(false)
 	{ 
 	}
 
@@ -40,9 +40,17 @@ namespace saftlib {
 	}
 	void Owned::release_service() {
 		service = nullptr;
+		service_released = true;
+	}
+
+	bool Owned::service_pending() const {
+		return cont && !service && !service_released;
 	}
 
 	void Owned::Disown() {
+		if (service_pending()) {
+			return; // there is no owner to release
+		}
 		if (cont && service) {
 			if (service->is_owned() && cont->get_calling_client_id() != service->get_owner()) {
 				throw saftbus::Error(saftbus::Error::INVALID_ARGS, "You are not my Owner");
@@ -61,6 +69,9 @@ namespace saftlib {
 		}
 	}
 	void Owned::ownerOnly() const {
+		if (service_pending()) {
+			return; // not owned, e.g. an Output that is written with TimingReceiver::WriteOutputs before anybody used its Proxy
+		}
 		if (cont && service) {
 			if (service->is_owned() && cont->get_calling_client_id() != service->get_owner()) {
 				throw saftbus::Error(saftbus::Error::INVALID_ARGS, "You are not my Owner");
@@ -71,6 +82,9 @@ namespace saftlib {
 	}
 
 	std::string Owned::getOwner() const {
+		if (service_pending()) {
+			return "";
+		}
 		if (cont && service) {
 			if (service->get_owner() != -1) {
 				std::ostringstream owner_str;
@@ -84,6 +98,9 @@ namespace saftlib {
 	}
 
 	bool Owned::getDestructible() const {
+		if (service_pending()) {
+			return false; // lazily created services have no destruction callback
+		}
 		if (cont && service) {
 			return service->has_destruction_callback();
 		} else {
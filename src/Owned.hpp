@@ -113,8 +113,13 @@ namespace saftlib {
 		/// @brief Throw an exception if the caller is not the owner
 		void ownerOnly() const;
 	private:
+		/// @brief the service will be created by the saftbus::Container on first use (create_object_lazy).
+		/// Until then, no client can own the object.
+		bool service_pending() const;
+
 		saftbus::Container *cont;
 		saftbus::Service *service;
+		bool service_released;
 
 	};
 
@@ -70,6 +70,12 @@ void Reset::CpuHalt(unsigned idx)
 void Reset::CpuReset(unsigned idx) 
 {
 	device.write(adr_first + FPGA_RESET_USERLM32_CLEAR, EB_DATA32, (eb_data_t)(1<<idx));
+	CpuStarted(idx);
+}
+
+void Reset::addWdRetrigger(AsyncCycle &cycle)
+{
+	cycle.write(adr_first + FPGA_RESET_WATCHDOG_TRG, EB_DATA32, (eb_data_t)FPGA_RESET_WATCHDOG_TRG_VALUE);
 }
 
 uint32_t Reset::CpuHaltStatus() 
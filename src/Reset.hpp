@@ -30,6 +30,9 @@
 #include <etherbone.h>
 
 #include "SdbDevice.hpp"
+#include "eb-async-cycle.hpp"
+
+#include <sigc++/sigc++.h>
 
 namespace saftlib {
 
@@ -60,6 +63,12 @@ public:
 	///
 	// @saftbus-export
 	uint32_t CpuHaltStatus();
+
+	/// @brief same as WdRetrigger, but the write is added to a cycle
+	void addWdRetrigger(AsyncCycle &cycle);
+
+	/// @brief emitted by CpuReset with the index of the cpu that starts its program
+	sigc::signal<void, unsigned> CpuStarted;
 };
 
 }
@@ -26,6 +26,7 @@
 
 #include <saftbus/error.hpp>
 #include <saftbus/loop.hpp>
+#include <saftbus/trace.hpp>
 
 #include "eb-source.hpp"
 
@@ -92,6 +93,7 @@ namespace saftlib {
 	}
 
 	eb_status_t SAFTd::write(eb_address_t address, eb_width_t width, eb_data_t data) {
+		SAFTBUS_TRACE_SCOPE("SAFTd::write", data);
 		// std::cerr << "write callback " << std::hex << std::setw(8) << std::setfill('0') << address 
 		//           <<               " " << std::hex << std::setw(8) << std::setfill('0') << data 
 		//           << std::dec 
@@ -0,0 +1,496 @@
+/*  Copyright (C) 2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#include "SdbCache.hpp"
+#include "BuildIdRom.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+
+namespace saftlib {
+
+// the file starts with this magic number and version
+const uint32_t SDB_CACHE_MAGIC   = 0x53444243; // "SDBC"
+const uint32_t SDB_CACHE_VERSION = 3;          // version 1 files contain only the records that were looked up,
+                                               // version 2 file names do not depend on the host interface
+
+std::mutex                                     SdbCache::registry_mutex;
+std::map<etherbone::Device*, SdbCache*>        SdbCache::registry;
+std::map<std::string, SdbCache::Prefetched>    SdbCache::prefetched;
+
+namespace {
+
+const uint32_t SDB_MAGIC = 0x5344422d; // "SDB-"
+
+enum {
+	SDB_RECORD_INTERCONNECT = 0x00,
+	SDB_RECORD_DEVICE       = 0x01,
+	SDB_RECORD_BRIDGE       = 0x02,
+	SDB_RECORD_MSI          = 0x03,
+	SDB_RECORD_WORDS        = 16,    // every SDB record has 64 bytes
+	SDB_MSI_FLAG_OWN        = 0x80000000, // this MSI record is the path to the one who reads the table
+};
+
+// All records of the SDB table at address, as 32-bit words.
+// One etherbone cycle reads the header, one more cycle reads the whole table.
+std::vector<eb_data_t> read_sdb_table(etherbone::Device &device, eb_address_t address)
+{
+	eb_data_t magic, records_version_bustype;
+	etherbone::Cycle cycle;
+	cycle.open(device);
+	cycle.read(address,   EB_DATA32, &magic);
+	cycle.read(address+4, EB_DATA32, &records_version_bustype);
+	cycle.close();
+	if (magic != SDB_MAGIC) {
+		throw etherbone::exception_t("SDB magic number doesn't match", EB_FAIL);
+	}
+	std::vector<eb_data_t> words(SDB_RECORD_WORDS * (records_version_bustype >> 16));
+	cycle.open(device);
+	for (unsigned i = 0; i < words.size(); ++i) {
+		cycle.read(address + 4*i, EB_DATA32, &words[i]);
+	}
+	cycle.close();
+	return words;
+}
+
+uint64_t sdb_word64(const eb_data_t *record, int index)
+{
+	return (static_cast<uint64_t>(record[index] & 0xffffffff) << 32) | (record[index+1] & 0xffffffff);
+}
+
+// decode a device record into the same format as etherbone::Device::sdb_find_by_identity returns it:
+// host byte order, and addresses relative to the root bus
+sdb_device decode_sdb_device(const eb_data_t *record, eb_address_t bus_base)
+{
+	sdb_device dev;
+	dev.abi_class     = record[0] >> 16;
+	dev.abi_ver_major = record[0] >> 8;
+	dev.abi_ver_minor = record[0];
+	dev.bus_specific  = record[1];
+	dev.sdb_component.addr_first        = bus_base + sdb_word64(record, 2);
+	dev.sdb_component.addr_last         = bus_base + sdb_word64(record, 4);
+	dev.sdb_component.product.vendor_id = sdb_word64(record, 6);
+	dev.sdb_component.product.device_id = record[8];
+	dev.sdb_component.product.version   = record[9];
+	dev.sdb_component.product.date      = record[10];
+	for (unsigned i = 0; i < sizeof(dev.sdb_component.product.name); ++i) {
+		dev.sdb_component.product.name[i] = record[11 + i/4] >> (24 - 8*(i%4));
+	}
+	dev.sdb_component.product.record_type = record[15];
+	return dev;
+}
+
+// The MSI range of the host, as it is seen from the bus of the table.
+struct MsiRange {
+	bool valid;
+	eb_address_t first, last;
+};
+
+// The MSI record marked with SDB_MSI_FLAG_OWN is the path from this bus towards the host.
+// MSIs to addresses inside the range of that record are forwarded on that path with the 
+// start of the range removed, so the host range of the parent bus appears shifted by the start of the range.
+MsiRange sdb_msi_range(const std::vector<eb_data_t> &table, const MsiRange &parent)
+{
+	MsiRange result = {false, 0, 0};
+	if (!parent.valid) {
+		return result;
+	}
+	for (unsigned record = 1; record*SDB_RECORD_WORDS < table.size(); ++record) {
+		const eb_data_t *words = &table[record*SDB_RECORD_WORDS];
+		if ((words[15] & 0xff) != SDB_RECORD_MSI || (words[0] & SDB_MSI_FLAG_OWN) == 0) {
+			continue;
+		}
+		eb_address_t first = sdb_word64(words, 2);
+		eb_address_t last  = sdb_word64(words, 4);
+		if (last < first || parent.first > last - first) {
+			return result;
+		}
+		result.valid = true;
+		result.first = first + parent.first;
+		result.last  = (parent.last > last - first) ? last : first + parent.last;
+		return result;
+	}
+	return result;
+}
+
+// Calls visit(device, msi_range) for all device records in the SDB table at address and all tables below it.
+// Stops and returns false as soon as visit returns false.
+template<typename Visit>
+bool walk_sdb(etherbone::Device &device, eb_address_t address, eb_address_t bus_base, const MsiRange &parent_msi, Visit &visit)
+{
+	std::vector<eb_data_t> table = read_sdb_table(device, address);
+	MsiRange msi = sdb_msi_range(table, parent_msi);
+	// record 0 is the interconnect record of the table itself
+	for (unsigned record = 1; record*SDB_RECORD_WORDS < table.size(); ++record) {
+		const eb_data_t *words = &table[record*SDB_RECORD_WORDS];
+		switch (words[15] & 0xff) {
+			case SDB_RECORD_DEVICE:
+				if (!visit(decode_sdb_device(words, bus_base), msi)) {
+					return false;
+				}
+			break;
+			case SDB_RECORD_BRIDGE:
+				// the child table address and the child bus addresses are relative to this bus
+				if (!walk_sdb(device, bus_base + sdb_word64(words, 0), bus_base + sdb_word64(words, 2), msi, visit)) {
+					return false;
+				}
+			break;
+		}
+	}
+	return true;
+}
+
+eb_address_t sdb_root(etherbone::Device &device)
+{
+	eb_data_t root;
+	etherbone::Cycle cycle;
+	cycle.open(device);
+	cycle.read_config(0xc, EB_DATA32, &root);
+	cycle.close();
+	return root;
+}
+
+// the root bus reaches the host in its whole address range
+const MsiRange root_msi = {true, 0, ~eb_address_t(0)};
+
+template<typename Visit>
+void walk_sdb(etherbone::Device &device, Visit visit)
+{
+	walk_sdb(device, sdb_root(device), 0, root_msi, visit);
+}
+
+}
+
+SdbCache::SdbCache(etherbone::Device &dev, const std::string &etherbone_path)
+	: device(dev), dirty(false)
+{
+	bool complete = false; // the tables contain all records of the device
+	bool loaded   = false; // the tables are from the cache file
+	if (!etherbone_path.empty()) {
+		std::lock_guard<std::mutex> lock(registry_mutex);
+		auto entry = prefetched.find(etherbone_path);
+		if (entry != prefetched.end()) {
+			tables    = std::move(entry->second.tables);
+			step_data = std::move(entry->second.step_data);
+			prefetched.erase(entry);
+			complete = true;
+		}
+	}
+	char *cache_dir_env = getenv("SAFTLIB_SDB_CACHE_DIR");
+	if (cache_dir_env != nullptr && cache_dir_env[0] != '\0') {
+		try {
+			cache_file = std::string(cache_dir_env) + "/" + cache_file_name(find_build_id_rom());
+			if (!complete && load()) {
+				std::cerr << "SDB records loaded from " << cache_file << std::endl;
+				complete = loaded = true;
+			}
+		} catch (etherbone::exception_t &e) {
+			std::cerr << "cannot use SDB cache file: " << e << std::endl;
+			cache_file.clear();
+		}
+	}
+	if (!complete) {
+		scan(device, tables);
+	}
+	dirty = !loaded;
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	registry[&device] = this;
+}
+SdbCache::SdbCache(etherbone::Device &dev, Tables &&prefetched_tables)
+	: device(dev), tables(std::move(prefetched_tables)), dirty(false)
+{
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	registry[&device] = this;
+}
+SdbCache::~SdbCache()
+{
+	store();
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	registry.erase(&device);
+}
+
+SdbCache *SdbCache::get(etherbone::Device &device)
+{
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	auto entry = registry.find(&device);
+	if (entry == registry.end()) {
+		return nullptr;
+	}
+	return entry->second;
+}
+
+void SdbCache::find_by_identity(etherbone::Device &device, uint32_t VENDOR_ID, uint32_t DEVICE_ID, std::vector<sdb_device> &result)
+{
+	SdbCache *cache = get(device);
+	if (cache == nullptr) {
+		device.sdb_find_by_identity(VENDOR_ID, DEVICE_ID, result);
+		return;
+	}
+	auto entry = cache->tables.devices.find(Identity(VENDOR_ID, DEVICE_ID));
+	if (entry != cache->tables.devices.end()) {
+		result.insert(result.end(), entry->second.begin(), entry->second.end());
+	}
+}
+
+void SdbCache::find_by_identity_msi(etherbone::Device &device, uint32_t VENDOR_ID, uint32_t DEVICE_ID, std::vector<etherbone::sdb_msi_device> &result)
+{
+	SdbCache *cache = get(device);
+	if (cache == nullptr) {
+		device.sdb_find_by_identity_msi(VENDOR_ID, DEVICE_ID, result);
+		return;
+	}
+	auto entry = cache->tables.msi_devices.find(Identity(VENDOR_ID, DEVICE_ID));
+	if (entry != cache->tables.msi_devices.end()) {
+		result.insert(result.end(), entry->second.begin(), entry->second.end());
+	}
+}
+
+void SdbCache::scan(etherbone::Device &device, Tables &tables)
+{
+	walk_sdb(device, [&tables](const sdb_device &dev, const MsiRange &msi) {
+		Identity id(dev.sdb_component.product.vendor_id, dev.sdb_component.product.device_id);
+		tables.devices[id].push_back(dev);
+		if (msi.valid) {
+			etherbone::sdb_msi_device msi_dev;
+			msi_dev.abi_class     = dev.abi_class;
+			msi_dev.abi_ver_major = dev.abi_ver_major;
+			msi_dev.abi_ver_minor = dev.abi_ver_minor;
+			msi_dev.bus_specific  = dev.bus_specific;
+			msi_dev.sdb_component = dev.sdb_component;
+			msi_dev.msi_first = msi.first;
+			msi_dev.msi_last  = msi.last;
+			tables.msi_devices[id].push_back(msi_dev);
+		}
+		return true;
+	});
+}
+
+void SdbCache::prefetch(const std::string &etherbone_path, const std::map<std::string, PrefetchStep> &steps)
+{
+	Prefetched result;
+	// etherbone sockets must not be shared between threads, the worker uses its own one
+	etherbone::Socket socket;
+	socket.open();
+	try {
+		etherbone::Device prefetch_device;
+		prefetch_device.open(socket, etherbone_path.c_str());
+		try {
+			Tables prefetched_tables;
+			scan(prefetch_device, prefetched_tables);
+			SdbCache cache(prefetch_device, std::move(prefetched_tables));
+			for (auto &step: steps) {
+				std::vector<eb_data_t> data;
+				try {
+					if (step.second(prefetch_device, data)) {
+						result.step_data[step.first] = std::move(data);
+					}
+				} catch (etherbone::exception_t &e) {
+					std::cerr << "prefetch step " << step.first << " for " << etherbone_path << " failed: " << e << std::endl;
+				} catch (std::exception &e) {
+					std::cerr << "prefetch step " << step.first << " for " << etherbone_path << " failed: " << e.what() << std::endl;
+				}
+			}
+			result.tables = std::move(cache.tables); // cache is unregistered right after this
+		} catch (...) {
+			prefetch_device.close();
+			throw;
+		}
+		prefetch_device.close();
+	} catch (...) {
+		socket.close();
+		throw;
+	}
+	socket.close();
+
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	prefetched[etherbone_path] = std::move(result);
+}
+
+bool SdbCache::take_prefetched(etherbone::Device &device, const std::string &step, std::vector<eb_data_t> &data)
+{
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	auto cache = registry.find(&device);
+	if (cache == registry.end()) {
+		return false;
+	}
+	auto entry = cache->second->step_data.find(step);
+	if (entry == cache->second->step_data.end()) {
+		return false;
+	}
+	data = std::move(entry->second);
+	cache->second->step_data.erase(entry);
+	return true;
+}
+
+eb_address_t SdbCache::find_build_id_rom()
+{
+	Identity rom(BUILD_ID_ROM_VENDOR_ID, BUILD_ID_ROM_DEVICE_ID);
+	auto entry = tables.devices.find(rom);
+	if (entry != tables.devices.end() && !entry->second.empty()) {
+		return entry->second[0].sdb_component.addr_first;
+	}
+	// the rest of the SDB tree is only read if the cache file does not exist
+	bool found = false;
+	eb_address_t address = 0;
+	walk_sdb(device, [&](const sdb_device &dev, const MsiRange &) {
+		if (Identity(dev.sdb_component.product.vendor_id, dev.sdb_component.product.device_id) != rom) {
+			return true;
+		}
+		found   = true;
+		address = dev.sdb_component.addr_first;
+		return false;
+	});
+	if (!found) {
+		throw etherbone::exception_t("no build id ROM", EB_FAIL);
+	}
+	return address;
+}
+
+std::string SdbCache::cache_file_name(eb_address_t build_id_rom)
+{
+	// the key is the complete content of the build id ROM (the same 1 KiB that BuildIdRom reads) and the host interface
+	eb_data_t buffer[256];
+	etherbone::Cycle cycle;
+	cycle.open(device);
+	for (unsigned i = 0; i < sizeof(buffer)/sizeof(buffer[0]); ++i) {
+		cycle.read(build_id_rom + i*4, EB_DATA32, &buffer[i]);
+	}
+	cycle.close();
+
+	// The same gateware has different MSI ranges depending on the host interface (e.g. 0x10000 
+	// over PCIe and 0x20000 over USB), so the MSI range of the host on the root bus is part of 
+	// the key. It is given by the MSI record that the root table marks as the path to the reader.
+	MsiRange host = sdb_msi_range(read_sdb_table(device, sdb_root(device)), root_msi);
+	uint64_t key[3] = {host.valid, host.first, host.last};
+
+	// 64 bit FNV-1a hash
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (unsigned i = 0; i < sizeof(buffer)/sizeof(buffer[0]); ++i) {
+		for (int shift = 24; shift >= 0; shift -= 8) {
+			hash ^= (buffer[i] >> shift) & 0xff;
+			hash *= 0x100000001b3ull;
+		}
+	}
+	for (unsigned i = 0; i < sizeof(key)/sizeof(key[0]); ++i) {
+		for (int shift = 56; shift >= 0; shift -= 8) {
+			hash ^= (key[i] >> shift) & 0xff;
+			hash *= 0x100000001b3ull;
+		}
+	}
+	std::ostringstream name;
+	name << "sdb-" << std::hex << std::setw(16) << std::setfill('0') << hash << ".cache";
+	return name.str();
+}
+
+template<typename T>
+static void write_table(std::ostream &out, const std::map<std::pair<uint32_t, uint32_t>, std::vector<T> > &table)
+{
+	uint32_t entries = table.size();
+	out.write(reinterpret_cast<const char*>(&entries), sizeof(entries));
+	for (auto &entry: table) {
+		uint32_t count = entry.second.size();
+		out.write(reinterpret_cast<const char*>(&entry.first.first),  sizeof(entry.first.first));
+		out.write(reinterpret_cast<const char*>(&entry.first.second), sizeof(entry.first.second));
+		out.write(reinterpret_cast<const char*>(&count),              sizeof(count));
+		if (count) {
+			out.write(reinterpret_cast<const char*>(&entry.second[0]), sizeof(T)*count);
+		}
+	}
+}
+
+template<typename T>
+static bool read_table(std::istream &in, std::map<std::pair<uint32_t, uint32_t>, std::vector<T> > &table)
+{
+	uint32_t entries;
+	if (!in.read(reinterpret_cast<char*>(&entries), sizeof(entries))) {
+		return false;
+	}
+	for (uint32_t i = 0; i < entries; ++i) {
+		uint32_t vendor_id, device_id, count;
+		in.read(reinterpret_cast<char*>(&vendor_id), sizeof(vendor_id));
+		in.read(reinterpret_cast<char*>(&device_id), sizeof(device_id));
+		in.read(reinterpret_cast<char*>(&count),     sizeof(count));
+		if (!in || count > 4096) {
+			return false;
+		}
+		std::vector<T> &records = table[std::make_pair(vendor_id, device_id)];
+		records.resize(count);
+		if (count && !in.read(reinterpret_cast<char*>(&records[0]), sizeof(T)*count)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SdbCache::load()
+{
+	std::ifstream in(cache_file.c_str(), std::ios::binary);
+	if (!in) {
+		return false;
+	}
+	uint32_t header[4];
+	if (!in.read(reinterpret_cast<char*>(header), sizeof(header))
+		|| header[0] != SDB_CACHE_MAGIC
+		|| header[1] != SDB_CACHE_VERSION
+		|| header[2] != sizeof(sdb_device)
+		|| header[3] != sizeof(etherbone::sdb_msi_device)) {
+		std::cerr << "ignoring SDB cache file with wrong format: " << cache_file << std::endl;
+		return false;
+	}
+	Tables file_tables;
+	if (!read_table(in, file_tables.devices) || !read_table(in, file_tables.msi_devices)) {
+		std::cerr << "ignoring truncated SDB cache file: " << cache_file << std::endl;
+		return false;
+	}
+	tables = std::move(file_tables);
+	return true;
+}
+
+void SdbCache::store()
+{
+	if (cache_file.empty() || !dirty) {
+		return;
+	}
+	// write into a temporary file and rename it, so that no other process sees a partially written file
+	std::string tmp_file = cache_file + ".tmp";
+	{
+		std::ofstream out(tmp_file.c_str(), std::ios::binary | std::ios::trunc);
+		uint32_t header[4] = {SDB_CACHE_MAGIC, SDB_CACHE_VERSION, sizeof(sdb_device), sizeof(etherbone::sdb_msi_device)};
+		out.write(reinterpret_cast<const char*>(header), sizeof(header));
+		write_table(out, tables.devices);
+		write_table(out, tables.msi_devices);
+		if (!out) {
+			std::cerr << "cannot write SDB cache file " << tmp_file << std::endl;
+			std::remove(tmp_file.c_str());
+			return;
+		}
+	}
+	if (std::rename(tmp_file.c_str(), cache_file.c_str()) != 0) {
+		std::cerr << "cannot rename SDB cache file " << tmp_file << " to " << cache_file << std::endl;
+		std::remove(tmp_file.c_str());
+		return;
+	}
+	std::cerr << "SDB records stored in " << cache_file << std::endl;
+	dirty = false;
+}
+
+}
@@ -0,0 +1,129 @@
+/*  Copyright (C) 2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#ifndef saftlib_SDB_CACHE_HPP_
+#define saftlib_SDB_CACHE_HPP_
+
+#ifndef ETHERBONE_THROWS
+#define ETHERBONE_THROWS 1
+#define __STDC_FORMAT_MACROS
+#define __STDC_CONSTANT_MACROS
+#endif
+#include <etherbone.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace saftlib {
+
+/// @brief Table of all SDB records of one etherbone::Device, indexed by VENDOR_ID and DEVICE_ID.
+///
+/// Every sdb_find_by_identity call walks the whole SDB tree on the hardware. A TimingReceiver
+/// consists of many SdbDevices, and each of them used to do its own walk. The SdbCache is created
+/// by OpenDevice right after the device is opened and registers itself for that etherbone::Device.
+/// It reads the SDB tree once (one etherbone cycle per SDB table) and keeps all device records, 
+/// together with the MSI address range of each device that can reach the host with MSIs.
+/// SdbDevice, MsiDevice and all other lookups go through SdbCache::find_by_identity and 
+/// SdbCache::find_by_identity_msi, which are served from this table without any hardware access.
+/// For devices without SdbCache (e.g. an etherbone::Device opened directly by a tool) the lookup
+/// falls back to the hardware.
+///
+/// If the environment variable SAFTLIB_SDB_CACHE_DIR names a directory, the table is also stored
+/// in a file in that directory. The file name is derived from the content of the build id ROM and
+/// from the MSI range of the host interface, so a device with the same gateware on the same kind of
+/// interface is attached without reading the rest of the SDB tree.
+///
+/// When several devices are attached at once, SdbCache::prefetch can read the SDB tree of one device
+/// in a worker thread while other devices are being attached. The SdbCache that is later created 
+/// for the same etherbone path takes over the prefetched table. Other slow initialization steps 
+/// (e.g. clearing the ECA condition table) can run in the same worker, their results are 
+/// handed to the driver objects with SdbCache::take_prefetched.
+class SdbCache {
+public:
+	SdbCache(etherbone::Device &device, const std::string &etherbone_path = std::string());
+	~SdbCache();
+
+	/// @brief same as etherbone::Device::sdb_find_by_identity, but uses the SdbCache of the device if there is one
+	static void find_by_identity(etherbone::Device &device, uint32_t VENDOR_ID, uint32_t DEVICE_ID, std::vector<sdb_device> &result);
+	/// @brief same as etherbone::Device::sdb_find_by_identity_msi, but uses the SdbCache of the device if there is one
+	static void find_by_identity_msi(etherbone::Device &device, uint32_t VENDOR_ID, uint32_t DEVICE_ID, std::vector<etherbone::sdb_msi_device> &result);
+
+	/// @brief write the table to the cache file if it is not yet in the file
+	void store();
+
+	/// @brief a step of the device initialization that runs in the prefetch worker
+	///
+	/// The step gets the device on the private socket of the worker, SDB lookups on it are served 
+	/// from the prefetched table. It returns false if it has nothing to hand over, e.g. because
+	/// the device has no such SDB device.
+	typedef std::function<bool(etherbone::Device &device, std::vector<eb_data_t> &data)> PrefetchStep;
+
+	/// @brief read the SDB tree of a device and run the given initialization steps.
+	/// @param etherbone_path the device to probe
+	/// @param steps named steps, the data of each step is handed over by take_prefetched under the same name
+	///
+	/// The device is opened on a private etherbone::Socket, so this function can run in a worker thread 
+	/// (one per device). The result is kept until an SdbCache for etherbone_path is created.
+	/// A step that throws is skipped, the driver object then does the work itself.
+	static void prefetch(const std::string &etherbone_path, const std::map<std::string, PrefetchStep> &steps = std::map<std::string, PrefetchStep>());
+
+	/// @brief take the data of a prefetch step of the device
+	/// @return false if the step did not run for this device or its data was already taken
+	static bool take_prefetched(etherbone::Device &device, const std::string &step, std::vector<eb_data_t> &data);
+
+private:
+	typedef std::pair<uint32_t, uint32_t> Identity;
+	typedef std::map<Identity, std::vector<sdb_device> >                DeviceTable;
+	typedef std::map<Identity, std::vector<etherbone::sdb_msi_device> > MsiDeviceTable;
+	struct Tables {
+		DeviceTable    devices;
+		MsiDeviceTable msi_devices;
+	};
+	typedef std::map<std::string, std::vector<eb_data_t> > StepData;
+	struct Prefetched {
+		Tables   tables;
+		StepData step_data;
+	};
+
+	// used by prefetch to serve the lookups of the steps from the tables it has read
+	SdbCache(etherbone::Device &device, Tables &&tables);
+
+	static void scan(etherbone::Device &device, Tables &tables);
+	eb_address_t find_build_id_rom();
+	std::string cache_file_name(eb_address_t build_id_rom);
+	bool load();
+
+	etherbone::Device &device;
+	Tables tables; // not modified after construction
+	StepData step_data; // guarded by registry_mutex
+	std::string cache_file;
+	bool dirty;    // the table is not in the cache file
+
+	static std::mutex                               registry_mutex;
+	static std::map<etherbone::Device*, SdbCache*>  registry;
+	static std::map<std::string, Prefetched>        prefetched; // guarded by registry_mutex
+	static SdbCache *get(etherbone::Device &device);
+};
+
+}
+
+#endif
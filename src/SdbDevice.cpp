@@ -20,6 +20,7 @@
  */
 
 #include "SdbDevice.hpp"
+#include "SdbCache.hpp"
 
 #include <saftbus/error.hpp>
 
@@ -29,11 +30,99 @@
 
 namespace saftlib {
 
-	SdbDevice::SdbDevice(etherbone::Device &dev, uint32_t VENDOR_ID, uint32_t DEVICE_ID, bool throw_if_not_found) 
+	RegisterShadow::RegisterShadow(etherbone::Device &dev)
 		: device(dev)
+	{
+	}
+
+	void RegisterShadow::setPolicy(eb_address_t address, Policy policy)
+	{
+		Register &reg = registers[address];
+		reg.policy = policy;
+		reg.valid  = false;
+		reg.value  = 0;
+	}
+
+	eb_data_t RegisterShadow::read(eb_address_t address)
+	{
+		auto it = registers.find(address);
+		if (it != registers.end() && it->second.policy == CACHEABLE && it->second.valid) {
+			return it->second.value;
+		}
+		eb_data_t value;
+		device.read(address, EB_DATA32, &value);
+		if (it != registers.end() && it->second.policy == CACHEABLE) {
+			it->second.value = value;
+			it->second.valid = true;
+		}
+		return value;
+	}
+
+	void RegisterShadow::write(eb_address_t address, eb_data_t value)
+	{
+		device.write(address, EB_DATA32, value);
+		auto it = registers.find(address);
+		if (it != registers.end() && it->second.policy == CACHEABLE) {
+			it->second.value = value;
+			it->second.valid = true;
+		}
+	}
+
+	void RegisterShadow::modify(eb_address_t address, eb_address_t write_address, eb_data_t mask, bool set)
+	{
+		device.write(write_address, EB_DATA32, mask);
+		auto it = registers.find(address);
+		if (it != registers.end() && it->second.valid) {
+			if (set) it->second.value |=  mask;
+			else     it->second.value &= ~mask;
+		}
+	}
+
+	void RegisterShadow::invalidate()
+	{
+		for (auto &reg: registers) {
+			reg.second.valid = false;
+		}
+	}
+
+	std::vector<std::string> RegisterShadow::check()
+	{
+		std::vector<std::string> result;
+		std::vector<eb_address_t> addresses;
+		for (auto &reg: registers) {
+			if (reg.second.valid) {
+				addresses.push_back(reg.first);
+			}
+		}
+		if (addresses.empty()) {
+			return result;
+		}
+		std::vector<eb_data_t> values(addresses.size());
+		etherbone::Cycle cycle;
+		cycle.open(device);
+		for (unsigned i = 0; i < addresses.size(); ++i) {
+			cycle.read(addresses[i], EB_DATA32, &values[i]);
+		}
+		cycle.close();
+		for (unsigned i = 0; i < addresses.size(); ++i) {
+			Register &reg = registers[addresses[i]];
+			if (reg.value != values[i]) {
+				std::ostringstream msg;
+				msg << "register 0x" << std::hex << std::setw(8) << std::setfill('0') << addresses[i] 
+				    << ": shadow=0x"    << std::hex << std::setw(8) << std::setfill('0') << reg.value
+				    << " hardware=0x"   << std::hex << std::setw(8) << std::setfill('0') << values[i];
+				result.push_back(msg.str());
+				reg.value = values[i];
+			}
+		}
+		return result;
+	}
+
+	SdbDevice::SdbDevice(etherbone::Device &dev, uint32_t VENDOR_ID, uint32_t DEVICE_ID, bool throw_if_not_found) 
+		: device(dev), shadow(dev)
 	{
 		std::vector<sdb_device> devs;
-		device.sdb_find_by_identity(VENDOR_ID, DEVICE_ID, devs);
+		SdbCache::find_by_identity(device, VENDOR_ID, DEVICE_ID, devs);
 
 		if (devs.size() < 1) {
 			std::ostringstream msg;
@@ -29,9 +29,59 @@
 #endif
 #include <etherbone.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace saftlib {
 
+/// @brief Shadow copies of hardware registers that are only changed by saftlib.
+///
+/// Each register has a policy. VOLATILE registers (the default) are always read from hardware. 
+/// The first read of a CACHEABLE register goes to the hardware, all further reads are served 
+/// from the shadow copy. Writes go to the hardware and update the shadow copy (write-through).
+/// The shadow copies become invalid with invalidate(), which must be called whenever the 
+/// hardware may have changed the registers on its own (e.g. after a reset, see TimingReceiver.cpp 
+/// for the events on which the IO configuration shadow is invalidated).
+/// check() compares all valid shadow copies with the hardware.
+class RegisterShadow {
+public:
+	enum Policy { VOLATILE, CACHEABLE };
+
+	RegisterShadow(etherbone::Device &device);
+
+	void setPolicy(eb_address_t address, Policy policy);
+
+	eb_data_t read(eb_address_t address);
+	void write(eb_address_t address, eb_data_t value);
+
+	/// @brief write mask to a set- or clear-register and update the shadow of the register that holds the bits
+	/// @param address the register that holds the bits (the one that is read)
+	/// @param write_address the register that sets the bits (set=true) or clears them (set=false)
+	/// @param mask the bits to set or clear
+	/// @param set true if write_address sets the bits, false if it clears them
+	void modify(eb_address_t address, eb_address_t write_address, eb_data_t mask, bool set);
+
+	void invalidate();
+
+	/// @brief compare all valid shadow copies with the hardware (in one etherbone cycle)
+	/// @return one line for each register where shadow and hardware differ. 
+	///
+	/// The shadow copies are updated with the hardware values.
+	std::vector<std::string> check();
+
+private:
+	struct Register {
+		Policy    policy;
+		bool      valid;
+		eb_data_t value;
+	};
+	etherbone::Device &device;
+	std::map<eb_address_t, Register> registers;
+};
+
 /// @brief SdbDevices calls sdb_find_by_identity and keeps the starting address of the device registers.
+/// The lookup goes through the SdbCache of the device (see SdbCache.hpp).
 /// 
 /// This class is supposed to be a base class of all driver classes that interact with a single SDB device 
 /// on the hardware. Deriving from this class avoids to rewrite the boilerplate code to identify a single 
@@ -48,6 +98,7 @@ class SdbDevice {
 protected:
 	eb_address_t adr_first;
 	etherbone::Device &device;
+	RegisterShadow shadow;
 public:
 	SdbDevice(etherbone::Device &device, uint32_t VENDOR_ID, uint32_t DEVICE_ID, bool throw_if_not_found = true);
 	virtual ~SdbDevice();
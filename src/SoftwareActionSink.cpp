@@ -28,6 +28,7 @@
 #include "SoftwareCondition.hpp"
 #include "SoftwareCondition_Service.hpp"
 
+#include <saftbus/trace.hpp>
 
 #include <cassert>
 #include <sstream>
@@ -52,6 +53,7 @@ SoftwareActionSink::SoftwareActionSink(ECA &eca
 
 void SoftwareActionSink::receiveMSI(uint8_t code)
 {
+	SAFTBUS_TRACE_SCOPE("SoftwareActionSink::receiveMSI", code);
 	// std::cerr << "SoftwareActionSink::receiveMSI " << (int)code << std::endl;
 	// Intercept valid action counter increase
 	if (code == ECA_VALID) {
@@ -59,66 +61,30 @@ void SoftwareActionSink::receiveMSI(uint8_t code)
 		// DRIVER_LOG("MSI-ECA_VALID",-1, code);
 		updateAction(); // increase the counter, rearming the MSI
 		
-		eb_data_t flags, rawNum, event_hi, event_lo, param_hi, param_lo, 
-							tag, tef, deadline_hi, deadline_lo, executed_hi, executed_lo;
-		
 		// std::cerr << "read data" << std::endl;
-		etherbone::Cycle cycle;
-		cycle.open(eca.get_device());
-		cycle.read(queue + ECA_QUEUE_FLAGS_GET,       EB_DATA32, &flags);
-		cycle.read(queue + ECA_QUEUE_NUM_GET,         EB_DATA32, &rawNum);
-		cycle.read(queue + ECA_QUEUE_EVENT_ID_HI_GET, EB_DATA32, &event_hi);
-		cycle.read(queue + ECA_QUEUE_EVENT_ID_LO_GET, EB_DATA32, &event_lo);
-		cycle.read(queue + ECA_QUEUE_PARAM_HI_GET,    EB_DATA32, &param_hi);
-		cycle.read(queue + ECA_QUEUE_PARAM_LO_GET,    EB_DATA32, &param_lo);
-		cycle.read(queue + ECA_QUEUE_TAG_GET,         EB_DATA32, &tag);
-		cycle.read(queue + ECA_QUEUE_TEF_GET,         EB_DATA32, &tef);
-		cycle.read(queue + ECA_QUEUE_DEADLINE_HI_GET, EB_DATA32, &deadline_hi);
-		cycle.read(queue + ECA_QUEUE_DEADLINE_LO_GET, EB_DATA32, &deadline_lo);
-		cycle.read(queue + ECA_QUEUE_EXECUTED_HI_GET, EB_DATA32, &executed_hi);
-		cycle.read(queue + ECA_QUEUE_EXECUTED_LO_GET, EB_DATA32, &executed_lo);
+		// The queue is popped without waiting for the device, the action is emitted when the data arrives.
+		// Cycles complete in order, so actions are emitted in the order of the MSIs.
+		AsyncCycle cycle(eca.get_device());
+		cycle.read(queue + ECA_QUEUE_FLAGS_GET,       EB_DATA32);
+		cycle.read(queue + ECA_QUEUE_NUM_GET,         EB_DATA32);
+		cycle.read(queue + ECA_QUEUE_EVENT_ID_HI_GET, EB_DATA32);
+		cycle.read(queue + ECA_QUEUE_EVENT_ID_LO_GET, EB_DATA32);
+		cycle.read(queue + ECA_QUEUE_PARAM_HI_GET,    EB_DATA32);
+		cycle.read(queue + ECA_QUEUE_PARAM_LO_GET,    EB_DATA32);
+		cycle.read(queue + ECA_QUEUE_TAG_GET,         EB_DATA32);
+		cycle.read(queue + ECA_QUEUE_TEF_GET,         EB_DATA32);
+		cycle.read(queue + ECA_QUEUE_DEADLINE_HI_GET, EB_DATA32);
+		cycle.read(queue + ECA_QUEUE_DEADLINE_LO_GET, EB_DATA32);
+		cycle.read(queue + ECA_QUEUE_EXECUTED_HI_GET, EB_DATA32);
+		cycle.read(queue + ECA_QUEUE_EXECUTED_LO_GET, EB_DATA32);
 		cycle.write(queue + ECA_QUEUE_POP_OWR, EB_DATA32, 1);
-		cycle.close();
-		// std::cerr << "read done" << std::endl;
-		
-		uint64_t id       = uint64_t(event_hi)    << 32 | event_lo;
-		uint64_t param    = uint64_t(param_hi)    << 32 | param_lo;
-		uint64_t deadline = uint64_t(deadline_hi) << 32 | deadline_lo;
-		uint64_t executed = uint64_t(executed_hi) << 32 | executed_lo;
-		
-		if ((flags & (1<<ECA_VALID)) == 0) {
-			std::cerr << "SoftwareActionSink: MSI for increase in VALID_COUNT did not correspond to a valid action in the queue" << std::endl;
-			return;
-		}
-		
-		if (rawNum != num) {
-			std::cerr << "SoftwareActionSink: MSI dispatched to wrong queue" << std::endl;
-			return;
-		}
-		
-		// Emit the Action
-		Conditions::iterator it = conditions.find(tag);
-		if (it == conditions.end()) {
-			// This can happen if the user deletes a condition at the same time a match arrives
-			// => Just silently discard the action on this race condition
-			return;
-		} 
-		
-		if (!it->second) {
-			std::cerr << "SoftwareActionSink: a Condition was not a SoftwareCondition" << std::endl;
-			return;
-		}
-		
-		// DRIVER_LOG("deadline",-1, deadline);
-		// DRIVER_LOG("id",      -1, id);
-		// Inform clients
-		// softwareCondition->Action(id, param, deadline, executed, flags & 0xF);
-		// std::cerr << "cast" << std::endl;
-		Condition* cond = it->second.get();
-		SoftwareCondition* sw_cond = dynamic_cast<SoftwareCondition*>(cond);
-		// std::cerr << "SigAction" << std::endl;
-		sw_cond->SigAction(id, param, saftlib::makeTimeTAI(deadline), saftlib::makeTimeTAI(executed), flags & 0xF);
-		
+		cycle.submit(async_guard, [this](bool ok, const std::vector<eb_data_t> &data) {
+			if (ok) {
+				popped(data);
+			} else {
+				std::cerr << "SoftwareActionSink: failed to read the action queue" << std::endl;
+			}
+		});
 	} else {
 		// std::cerr << "not ECA_VALID" << std::endl;
 		// DRIVER_LOG("MSI-ECA_NOT_VALID",-1, code);
@@ -127,6 +93,62 @@ void SoftwareActionSink::receiveMSI(uint8_t code)
 	}
 }
 
+void SoftwareActionSink::popped(const std::vector<eb_data_t> &data)
+{
+	SAFTBUS_TRACE_SCOPE("SoftwareActionSink::popped");
+	// std::cerr << "read done" << std::endl;
+	eb_data_t flags       = data[0];
+	eb_data_t rawNum      = data[1];
+	eb_data_t event_hi    = data[2];
+	eb_data_t event_lo    = data[3];
+	eb_data_t param_hi    = data[4];
+	eb_data_t param_lo    = data[5];
+	eb_data_t tag         = data[6];
+	// data[7] is tef
+	eb_data_t deadline_hi = data[8];
+	eb_data_t deadline_lo = data[9];
+	eb_data_t executed_hi = data[10];
+	eb_data_t executed_lo = data[11];
+
+	uint64_t id       = uint64_t(event_hi)    << 32 | event_lo;
+	uint64_t param    = uint64_t(param_hi)    << 32 | param_lo;
+	uint64_t deadline = uint64_t(deadline_hi) << 32 | deadline_lo;
+	uint64_t executed = uint64_t(executed_hi) << 32 | executed_lo;
+	
+	if ((flags & (1<<ECA_VALID)) == 0) {
+		std::cerr << "SoftwareActionSink: MSI for increase in VALID_COUNT did not correspond to a valid action in the queue" << std::endl;
+		return;
+	}
+	
+	if (rawNum != num) {
+		std::cerr << "SoftwareActionSink: MSI dispatched to wrong queue" << std::endl;
+		return;
+	}
+	
+	// Emit the Action
+	Conditions::iterator it = conditions.find(tag);
+	if (it == conditions.end()) {
+		// This can happen if the user deletes a condition at the same time a match arrives
+		// => Just silently discard the action on this race condition
+		return;
+	} 
+	
+	if (!it->second) {
+		std::cerr << "SoftwareActionSink: a Condition was not a SoftwareCondition" << std::endl;
+		return;
+	}
+	
+	// DRIVER_LOG("deadline",-1, deadline);
+	// DRIVER_LOG("id",      -1, id);
+	// Inform clients
+	// softwareCondition->Action(id, param, deadline, executed, flags & 0xF);
+	// std::cerr << "cast" << std::endl;
+	Condition* cond = it->second.get();
+	SoftwareCondition* sw_cond = dynamic_cast<SoftwareCondition*>(cond);
+	// std::cerr << "SigAction" << std::endl;
+	sw_cond->SigAction(id, param, saftlib::makeTimeTAI(deadline), saftlib::makeTimeTAI(executed), flags & 0xF);
+}
+
 SoftwareCondition * SoftwareActionSink::getCondition(const std::string object_path) {
 	return dynamic_cast<SoftwareCondition*>(ActionSink::getCondition(object_path));
 }
@@ -80,6 +80,9 @@ namespace saftlib {
 		SoftwareCondition * getCondition(const std::string object_path);
 		
 	protected:
+		// handle the data of one popped queue entry
+		void popped(const std::vector<eb_data_t> &data);
+
 		eb_address_t queue;
 	};
 
@@ -21,6 +21,7 @@
 
 #include "TimingReceiver.hpp"
 #include "SAFTd.hpp"
+#include "SdbCache.hpp"
 #include "SoftwareActionSink.hpp"
 #include "SoftwareActionSink_Service.hpp"
 #include "IoControl.hpp"
@@ -57,6 +58,10 @@ TimingReceiver::TimingReceiver(SAFTd &saftd, const std::string &n, const std::st
 	, LM32Cluster(OpenDevice::device, this)
 	, container(cont)
 	, io_control(OpenDevice::device)
+	, async_guard(AsyncCycle::make_guard())
+	, housekeeping_pending(false)
+	, housekeeping_last(0), housekeeping_min(0), housekeeping_max(0), housekeeping_sum(0)
+	, housekeeping_count(0), housekeeping_failed(0), housekeeping_skipped(0)
 	, object_path(saftd.getObjectPath() + "/" + n)
 	, name(n)
 {
@@ -91,9 +96,12 @@ TimingReceiver::TimingReceiver(SAFTd &saftd, const std::string &n, const std::st
 			std::unique_ptr<Input> input(new Input(*dynamic_cast<ECA_TLU*>(this), input_path, output_path, 
 												   io.getEcaIn(), &io, container));
 			if (container) {
-				std::unique_ptr<Input_Service> service(new Input_Service(input.get()));
-				input->set_service(service.get());
-				container->create_object(input_path, std::move(service));
+				Input *input_ptr = input.get();
+				container->create_object_lazy(input_path, [input_ptr]() {
+					std::unique_ptr<Input_Service> service(new Input_Service(input_ptr));
+					input_ptr->set_service(service.get());
+					return std::unique_ptr<saftbus::Service>(std::move(service));
+				});
 			}
 			ECA_TLU::addInput(std::move(input));
 		}
@@ -103,14 +111,23 @@ TimingReceiver::TimingReceiver(SAFTd &saftd, const std::string &n, const std::st
 			std::unique_ptr<Output> output(new Output(*dynamic_cast<ECA*>(this), io, output_path, input_path, 
 													  eca_channel_for_outputs, container));
 			if (container) {
-				std::unique_ptr<Output_Service> service(new Output_Service(output.get()));
-				output->set_service(service.get());
-				container->create_object(output_path, std::move(service));
+				Output *output_ptr = output.get();
+				container->create_object_lazy(output_path, [output_ptr]() {
+					std::unique_ptr<Output_Service> service(new Output_Service(output_ptr));
+					output_ptr->set_service(service.get());
+					return std::unique_ptr<saftbus::Service>(std::move(service));
+				});
 			}
 			ECA::addActionSink(eca_channel_for_outputs, std::move(output));
 		}
 	}
 
+	WhiteRabbit::Locked.connect(sigc::mem_fun(*this, &TimingReceiver::on_locked));
+	Reset::CpuStarted.connect(sigc::mem_fun(*this, &TimingReceiver::on_cpu_started));
+
+	// all SdbDevices are found now, remember them for the next attach of the same gateware
+	sdb_cache->store();
+
 	poll(); // update locked status ...
 	//    ... and repeat every 1s 
 	poll_timeout_source = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
@@ -123,6 +140,13 @@ TimingReceiver::~TimingReceiver()
 	// std::cerr << "TimingReceiver::~TimingReceiver" << std::endl;
 	// std::cerr << "saftbus::Loop::get_default().remove(poll_timeout_source)" << std::endl;
 	saftbus::Loop::get_default().remove(poll_timeout_source);
+	// A synchronous access completes all outstanding cycles (housekeeping and other AsyncCycles), 
+	// so the device is idle when it is closed. Their callbacks are not called, because async_guard expires.
+	try {
+		WhiteRabbit::getLocked();
+	} catch (etherbone::exception_t &e) {
+		std::cerr << "TimingReceiver::~TimingReceiver: " << e << std::endl;
+	}
 
 	// remove the service objects for all addons
 	if (container != nullptr) {
@@ -152,12 +176,64 @@ TimingReceiver::~TimingReceiver()
 bool TimingReceiver::poll()
 {
 	// std::cerr << "TimingReceiver::poll()" << std::endl;
-	WhiteRabbit::getLocked();
-	Watchdog::update(); 
-	Reset::WdRetrigger();
+	if (housekeeping_pending) {
+		// the device did not yet respond to the previous cycle, don't pile up more cycles
+		++housekeeping_skipped;
+		return true;
+	}
+	// All housekeeping in one cycle. The cycle is not waited for, housekeeping_done is called 
+	// from the event loop when the response arrives. It is never called from within another 
+	// etherbone access that happens to collect the response, so the Locked signal handlers may
+	// use the device (e.g. RegisterShadow::read).
+	housekeeping_start = std::chrono::steady_clock::now();
+	AsyncCycle cycle(OpenDevice::device);
+	WhiteRabbit::addLockedRead(cycle);
+	Watchdog::addUpdate(cycle);
+	Reset::addWdRetrigger(cycle);
+	housekeeping_pending = true;
+	cycle.submit(async_guard, [this](bool ok, const std::vector<eb_data_t> &reads) {
+		housekeeping_done(ok, reads);
+	});
 	return true;
 }
 
+void TimingReceiver::housekeeping_done(bool ok, const std::vector<eb_data_t> &reads)
+{
+	housekeeping_pending = false;
+	if (!ok) {
+		++housekeeping_failed;
+		std::cerr << "TimingReceiver " << name << ": housekeeping cycle failed" << std::endl;
+		invalidate_register_shadow("housekeeping failed");
+		return;
+	}
+	auto duration = std::chrono::steady_clock::now() - housekeeping_start;
+	if (housekeeping_count == 0 || duration < housekeeping_min) housekeeping_min = duration;
+	if (duration > housekeeping_max)                            housekeeping_max = duration;
+	housekeeping_last = duration;
+	housekeeping_sum += duration;
+	++housekeeping_count;
+
+	// the cycle contains only one read: the WhiteRabbit lock state
+	if (!reads.empty()) {
+		WhiteRabbit::setLocked(reads[0]);
+	}
+}
+
+std::map< std::string, uint64_t > TimingReceiver::getHousekeepingStatistics() const
+{
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+	std::map< std::string, uint64_t > result;
+	result["count"]   = housekeeping_count;
+	result["failed"]  = housekeeping_failed;
+	result["skipped"] = housekeeping_skipped;
+	result["last_us"] = duration_cast<microseconds>(housekeeping_last).count();
+	result["min_us"]  = duration_cast<microseconds>(housekeeping_min).count();
+	result["max_us"]  = duration_cast<microseconds>(housekeeping_max).count();
+	result["mean_us"] = housekeeping_count ? duration_cast<microseconds>(housekeeping_sum).count()/housekeeping_count : 0;
+	return result;
+}
+
 
 const std::string &TimingReceiver::getObjectPath() const
 {
@@ -188,6 +264,52 @@ void TimingReceiver::InjectEvent(uint64_t event, uint64_t param, saftlib::Time t
 	ECA_Event::InjectEventRaw(event, param, time.getTAI());
 }
 
+std::vector< std::string > TimingReceiver::CheckRegisterShadow()
+{
+	return io_control.CheckRegisterShadow();
+}
+
+// The IO configuration registers are only changed by saftlib, so IoControl serves their reads from 
+// shadow copies. The copies are dropped whenever something else may have changed the registers:
+//  - the WhiteRabbit lock state changes (a reset of the FPGA also loses the lock)
+//  - a user LM32 is started with CpuReset (its firmware may configure IOs)
+//  - a housekeeping cycle fails (the device may be reset or re-plugged before it answers again)
+// A device that is attached again gets a new TimingReceiver and starts without shadow copies.
+// Changes made with eb-tools behind saftlib's back are not detected, CheckRegisterShadow reports them.
+void TimingReceiver::invalidate_register_shadow(const char *reason)
+{
+	std::cerr << "TimingReceiver " << name << ": IO register shadow invalidated (" << reason << ")" << std::endl;
+	io_control.InvalidateRegisterShadow();
+}
+
+void TimingReceiver::on_locked(bool locked)
+{
+	invalidate_register_shadow("lock state changed");
+}
+
+void TimingReceiver::on_cpu_started(unsigned idx)
+{
+	invalidate_register_shadow("user LM32 started");
+}
+
+std::map< std::string, std::vector< uint8_t > > TimingReceiver::ReadAllIoStates(std::vector< std::string > &names)
+{
+	return io_control.ReadAllIoStates(names);
+}
+
+void TimingReceiver::WriteOutputs(const std::vector< uint8_t > &mask, const std::vector< uint8_t > &values)
+{
+	std::vector<std::string> names;
+	auto &ios = io_control.get_ios();
+	for (unsigned i = 0; i < mask.size() && i < ios.size(); ++i) {
+		if (mask[i]) {
+			names.push_back(ios[i].getName());
+		}
+	}
+	ECA::outputsOwnerOnly(names);
+	io_control.WriteOutputs(mask, values);
+}
+
 std::map< std::string, std::map< std::string, std::string > > TimingReceiver::getInterfaces() const
 {
 	std::map< std::string, std::map< std::string, std::string > > result;
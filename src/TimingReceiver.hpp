@@ -22,6 +22,7 @@
 #ifndef saftlib_TIMING_RECEIVER_HPP_
 #define saftlib_TIMING_RECEIVER_HPP_
 
+#include <chrono>
 #include <deque>
 #include <memory>
 #include <string>
@@ -166,6 +167,53 @@ public:
 	/// @param name and object path of instances of interface
 	// void addInterfaces(const std::string &interface_name, const std::map< std::string, std::string > & objects);
 
+	/// @brief Snapshot of the state of all IOs, read in one etherbone cycle.
+	/// @param names is filled with the names of all IOs.
+	/// @return For each property one vector with one entry per IO, in the same order as names.
+	///         Properties are "Direction" (0=output, 1=input, 2=inout) and 
+	///         "Output", "CombinedOutput", "Input", "OutputEnable", "InputTermination", 
+	///         "SpecialPurposeOut", "SpecialPurposeIn", "GateOut", "GateIn", "BuTiSMultiplexer", 
+	///         "PPSMultiplexer" (0 or 1). Properties that do not apply to an IO are 0.
+	///
+	/// This replaces many calls of the individual Input and Output getters 
+	/// if the state of all IOs is needed, e.g. to display a table.
+	///
+	// @saftbus-export
+	std::map< std::string, std::vector< uint8_t > > ReadAllIoStates(std::vector< std::string > &names);
+
+	/// @brief Drive many outputs in one etherbone cycle.
+	/// @param mask One entry per IO in the order of the names returned by ReadAllIoStates.
+	///             Only IOs with a nonzero entry are written.
+	/// @param values The output values, in the same order as mask.
+	///
+	/// All outputs change at the same time. It is an error if one of the selected IOs
+	/// is not an output, or if the Output is owned by another process. In that case 
+	/// no output is written.
+	///
+	// @saftbus-export
+	void WriteOutputs(const std::vector< uint8_t > &mask, const std::vector< uint8_t > &values);
+
+	/// @brief Compare the shadow copies of hardware registers with the hardware.
+	/// @return One line for each register where shadow copy and hardware differ (empty if all are consistent).
+	///
+	/// Some configuration registers (e.g. IO output enable, termination, gates, multiplexers) 
+	/// are only changed by saftlib. Their values are kept in shadow copies, so reading these properties
+	/// does not access the hardware. This method reads all of them from hardware and reports the ones that 
+	/// differ. Afterwards the shadow copies are in sync with the hardware.
+	///
+	// @saftbus-export
+	std::vector< std::string > CheckRegisterShadow();
+
+	/// @brief Statistics of the periodic housekeeping (lock state, watchdogs) of this device.
+	/// @return "count": number of completed housekeeping cycles, "failed": cycles that completed with an error,
+	///         "skipped": polls that were skipped because the previous cycle was not yet complete,
+	///         "last_us", "min_us", "max_us", "mean_us": time from issuing the cycle to its completion in microseconds.
+	///
+	/// Housekeeping is done once per second in one etherbone cycle that does not block the event loop.
+	///
+	// @saftbus-export
+	std::map< std::string, uint64_t > getHousekeepingStatistics() const;
+
 	void installAddon(const std::string &interface_name, std::unique_ptr<TimingReceiverAddon> addon);
 
 	void removeAddon(const std::string &interface_name);
@@ -176,8 +224,19 @@ private:
 	IoControl io_control;
 
 	bool poll();
+	void on_locked(bool locked);
+	void on_cpu_started(unsigned idx);
+	void invalidate_register_shadow(const char *reason);
 	saftbus::SourceHandle poll_timeout_source;
 
+	// poll submits the housekeeping cycle, housekeeping_done is called from the saftbus::Loop when it is complete
+	void housekeeping_done(bool ok, const std::vector<eb_data_t> &reads);
+	AsyncCycle::Guard async_guard;
+	bool      housekeeping_pending;
+	std::chrono::steady_clock::time_point housekeeping_start;
+	std::chrono::nanoseconds housekeeping_last, housekeeping_min, housekeeping_max, housekeeping_sum;
+	uint64_t  housekeeping_count, housekeeping_failed, housekeeping_skipped;
+
 	
 	eb_address_t ats;
 
@@ -57,4 +57,8 @@ void Watchdog::update() {
 	device.write(adr_first, EB_DATA32, watchdog_value);
 }
 
+void Watchdog::addUpdate(AsyncCycle &cycle) {
+	cycle.write(adr_first, EB_DATA32, watchdog_value);
+}
+
 } // namespace
\ No newline at end of file
@@ -30,6 +30,7 @@
 #include <etherbone.h>
 
 #include "SdbDevice.hpp"
+#include "eb-async-cycle.hpp"
 
 namespace saftlib {
 
@@ -39,6 +40,8 @@ public:
 	Watchdog(etherbone::Device &device);
 	bool aquire();
 	void update();
+	/// @brief same as update, but the write is added to a cycle
+	void addUpdate(AsyncCycle &cycle);
 };
 
 }
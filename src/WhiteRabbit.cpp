@@ -51,7 +51,17 @@ bool WhiteRabbit::getLocked() const
 {
 	eb_data_t data;
 	device.read(adr_first + WR_PPS_GEN_ESCR, EB_DATA32, &data);
-	bool newLocked = (data & WR_PPS_GEN_ESCR_MASK) == WR_PPS_GEN_ESCR_MASK;
+	return setLocked(data);
+}
+
+void WhiteRabbit::addLockedRead(AsyncCycle &cycle) const
+{
+	cycle.read(adr_first + WR_PPS_GEN_ESCR, EB_DATA32);
+}
+
+bool WhiteRabbit::setLocked(eb_data_t escr) const
+{
+	bool newLocked = (escr & WR_PPS_GEN_ESCR_MASK) == WR_PPS_GEN_ESCR_MASK;
 
 	/* Update signal */
 	if (newLocked != locked) {
@@ -33,6 +33,7 @@
 #include <sigc++/sigc++.h>
 
 #include "SdbDevice.hpp"
+#include "eb-async-cycle.hpp"
 
 namespace saftlib {
 
@@ -50,6 +51,11 @@ public:
 	///
 	// @saftbus-export
 	bool getLocked() const;
+
+	/// @brief add the read of the lock state to a cycle, the result is passed to setLocked when the cycle is done
+	void addLockedRead(AsyncCycle &cycle) const;
+	/// @brief update the lock state (and emit Locked if it changed) with a value read by addLockedRead
+	bool setLocked(eb_data_t escr) const;
 	
     // @saftbus-export
     sigc::signal<void, bool> Locked;
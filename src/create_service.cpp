@@ -21,12 +21,20 @@
 
 #include "SAFTd.hpp"
 #include "SAFTd_Service.hpp"
+#include "SdbCache.hpp"
+#include "ECA.hpp"
+#include "IoControl.hpp"
 
 #include <memory>
 #include <vector>
 #include <map>
 #include <string>
 #include <sstream>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 
 #include <saftbus/error.hpp>
 
@@ -40,15 +48,21 @@ void destroy_service() {
 	saftd.reset(); // destructor + release memory
 }
 
+struct DeviceArg {
+	std::string name;
+	std::string etherbone_path;
+	int poll_interval_ms;
+};
+
 /// @brief if the name and etherbone_path have '*' as last charater, the etherbone_path is scanned for matching device files. All matching devices will be attached.
 ///
 /// If no match is found, nothing is attached.
 /// If no '*' is found, the device is attached directly.
-/// @param saftd a pointer to a SAFTd
+/// @param devices the devices to attach are added here
 /// @param name logical saftlib name. For example tr0, tr1 or tr*
 /// @param etherbone_path etherbone path. If name has a '*' as last character, etherbone_path needs '*' as last character, too.
 /// @param poll_interval_ms this is directly passed to AttachDevice function
-void handle_wildcards_and_attach_device(saftlib::SAFTd *saftd, const std::string name, const std::string etherbone_path, int poll_interval_ms) {
+void handle_wildcards(std::vector<DeviceArg> &devices, const std::string name, const std::string etherbone_path, int poll_interval_ms) {
 	if (name.size() && name.back() == '*') {
 		if (etherbone_path.size() && etherbone_path.back() != '*') {
 			throw saftbus::Error(saftbus::Error::INVALID_ARGS, "if name has * wildcard as last char, etherbone_path also needs wildcard as last char");
@@ -74,7 +88,7 @@ void handle_wildcards_and_attach_device(saftlib::SAFTd *saftd, const std::string
 
 						std::cerr << "found name device pair "  << new_name << ":" << new_path << std::endl;
 						found_one = true;
-						saftd->AttachDevice(new_name, new_path, poll_interval_ms);
+						devices.push_back(DeviceArg{new_name, new_path, poll_interval_ms});
 					}
 				}
 				if (!found_one) {
@@ -90,7 +104,67 @@ void handle_wildcards_and_attach_device(saftlib::SAFTd *saftd, const std::string
 			throw saftbus::Error(saftbus::Error::INVALID_ARGS, msg.str());
 		}
 	} else {
-		saftd->AttachDevice(name, etherbone_path, poll_interval_ms);
+		devices.push_back(DeviceArg{name, etherbone_path, poll_interval_ms});
+	}
+}
+
+/// @brief attach all devices, the slow parts of their initialization run in parallel
+///
+/// Every device gets a worker thread, and all workers are started before the first device is attached.
+/// A worker opens the device on its own etherbone socket, reads the SDB tree, removes the old ECA rules 
+/// and reads the IO map table (SdbCache::prefetch). This thread attaches each device as soon as its 
+/// worker is done, in the order in which the workers finish. The SdbCache, ECA and IoControl of the 
+/// device then take over what the worker has read instead of accessing the hardware again.
+/// TimingReceiver construction and service creation stay on this thread, because they use the saftbus::Loop, 
+/// the saftbus::Container and the etherbone socket of SAFTd, which are not thread safe.
+void attach_devices(saftlib::SAFTd *saftd, const std::vector<DeviceArg> &devices) {
+	if (devices.empty()) {
+		return;
+	}
+	std::map<std::string, saftlib::SdbCache::PrefetchStep> steps;
+	steps["ECA"]       = &saftlib::ECA::prefetch;
+	steps["IoControl"] = &saftlib::IoControl::prefetch;
+
+	std::mutex              done_mutex;
+	std::condition_variable done_cv;
+	std::deque<unsigned>    done; // indices of the finished workers, in the order in which they finished
+
+	// the destructors of the futures wait for the workers, so they must be destroyed before the variables above
+	std::vector<std::future<void> > workers;
+	for (unsigned i = 0; i < devices.size(); ++i) {
+		workers.push_back(std::async(std::launch::async, [&, i]() {
+			std::exception_ptr error;
+			try {
+				saftlib::SdbCache::prefetch(devices[i].etherbone_path, steps);
+			} catch (...) {
+				error = std::current_exception();
+			}
+			{
+				std::lock_guard<std::mutex> lock(done_mutex);
+				done.push_back(i);
+			}
+			done_cv.notify_one();
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}));
+	}
+	for (unsigned n_attached = 0; n_attached < devices.size(); ++n_attached) {
+		unsigned i;
+		{
+			std::unique_lock<std::mutex> lock(done_mutex);
+			done_cv.wait(lock, [&done]() { return !done.empty(); });
+			i = done.front();
+			done.pop_front();
+		}
+		const DeviceArg &device = devices[i];
+		try {
+			workers[i].get();
+		} catch (etherbone::exception_t &e) {
+			// the device will do its initialization itself
+			std::cerr << "prefetch for " << device.etherbone_path << " failed: " << e << std::endl;
+		}
+		saftd->AttachDevice(device.name, device.etherbone_path, device.poll_interval_ms);
 	}
 }
 
@@ -113,6 +187,7 @@ void create_services(saftbus::Container *container, const std::vector<std::strin
 	// it destroyes them in reverse order. If SAFTd_Service is destroyed before the attached devices 
 	// then destroying the attached devices will result in segmentation faults (because the destruction_callback
 	// is part of SAFTd_Service which doesnt exist anymore)
+	std::vector<DeviceArg> devices;
 	for (auto &arg: args) {
 		size_t pos = arg.find(':'); // the position of the first colon ':'
 		if (pos == arg.npos || pos+1 == arg.size()) {
@@ -135,8 +210,9 @@ void create_services(saftbus::Container *container, const std::vector<std::strin
 			}
 			path = path.substr(0,pos2);
 		}
-		handle_wildcards_and_attach_device(saftd.get(), name, path, poll_interval_ms);
+		handle_wildcards(devices, name, path, poll_interval_ms);
 	}
+	attach_devices(saftd.get(), devices);
 }
 
 
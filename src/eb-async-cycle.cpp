@@ -0,0 +1,156 @@
+/*  Copyright (C) 2022 GSI Helmholtz Centre for Heavy Ion Research GmbH 
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#include "eb-async-cycle.hpp"
+
+#include <saftbus/loop.hpp>
+
+#include <deque>
+#include <iostream>
+#include <stdexcept>
+
+namespace saftlib {
+
+	struct AsyncCycle::Pending {
+		std::weak_ptr<void>    guard;
+		bool                   has_guard;
+		Callback               callback;
+		bool                   ok;
+		std::vector<eb_data_t> reads;
+	};
+
+	// Completed cycles wait here until the saftbus::Loop calls their callbacks.
+	// The source is connected to the default loop with the first submitted cycle and stays there.
+	class AsyncCycleSource : public saftbus::Source {
+	public:
+		static AsyncCycleSource &get() {
+			static AsyncCycleSource *source = nullptr;
+			if (source == nullptr) {
+				source = new AsyncCycleSource;
+				saftbus::Loop::get_default().connect(std::unique_ptr<saftbus::Source>(source));
+			}
+			return *source;
+		}
+		void push(std::unique_ptr<AsyncCycle::Pending> pending) {
+			completed.push_back(std::move(pending));
+		}
+		bool prepare(std::chrono::milliseconds &timeout_ms) override {
+			if (!completed.empty()) {
+				timeout_ms = std::chrono::milliseconds(0);
+				return true;
+			}
+			return false;
+		}
+		bool check() override {
+			return !completed.empty();
+		}
+		bool dispatch() override {
+			// callbacks may submit new cycles, only the ones completed before are handled in this call
+			std::deque<std::unique_ptr<AsyncCycle::Pending> > ready;
+			ready.swap(completed);
+			for (auto &pending: ready) {
+				if (pending->has_guard && pending->guard.expired()) {
+					continue; // the object that submitted the cycle is gone
+				}
+				if (!pending->callback) {
+					if (!pending->ok) {
+						std::cerr << "AsyncCycle failed" << std::endl;
+					}
+					continue;
+				}
+				try {
+					pending->callback(pending->ok, pending->reads);
+				} catch (etherbone::exception_t &e) {
+					std::cerr << "AsyncCycle callback: etherbone exception: " << e << std::endl;
+				} catch (std::exception &e) {
+					std::cerr << "AsyncCycle callback: exception: " << e.what() << std::endl;
+				}
+			}
+			return true;
+		}
+		std::string type() override {
+			return "AsyncCycleSource";
+		}
+	private:
+		std::deque<std::unique_ptr<AsyncCycle::Pending> > completed;
+	};
+
+	AsyncCycle::AsyncCycle(etherbone::Device &device)
+		: pending(new Pending)
+	{
+		pending->has_guard = false;
+		pending->ok        = false;
+		cycle.open(device, pending, &AsyncCycle::done);
+	}
+
+	AsyncCycle::~AsyncCycle()
+	{
+		if (pending != nullptr) {
+			cycle.abort();
+			delete pending;
+		}
+	}
+
+	void AsyncCycle::read(eb_address_t address, eb_format_t format)
+	{
+		cycle.read(address, format);
+	}
+
+	void AsyncCycle::write(eb_address_t address, eb_format_t format, eb_data_t data)
+	{
+		cycle.write(address, format, data);
+	}
+
+	void AsyncCycle::read_config(eb_address_t address, eb_format_t format)
+	{
+		cycle.read_config(address, format);
+	}
+
+	void AsyncCycle::submit(const Guard &guard, Callback callback)
+	{
+		pending->guard     = guard;
+		pending->has_guard = true;
+		pending->callback  = callback;
+		submit();
+	}
+
+	void AsyncCycle::submit()
+	{
+		AsyncCycleSource::get();
+		pending = nullptr; // etherbone owns it until done is called
+		cycle.close();
+	}
+
+	AsyncCycle::Guard AsyncCycle::make_guard()
+	{
+		return std::make_shared<char>(0);
+	}
+
+	void AsyncCycle::done(Pending *pending, etherbone::Device dev, etherbone::Operation op, etherbone::status_t status)
+	{
+		std::unique_ptr<Pending> p(pending);
+		p->ok = (status == EB_OK);
+		for (; !op.is_null(); op = op.next()) {
+			if (op.is_read()) {
+				p->reads.push_back(op.data());
+			}
+		}
+		AsyncCycleSource::get().push(std::move(p));
+	}
+
+}
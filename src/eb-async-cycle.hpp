@@ -0,0 +1,88 @@
+/*  Copyright (C) 2022 GSI Helmholtz Centre for Heavy Ion Research GmbH 
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#ifndef TR_EB_ASYNC_CYCLE_HPP_
+#define TR_EB_ASYNC_CYCLE_HPP_
+
+#ifndef ETHERBONE_THROWS
+#define ETHERBONE_THROWS 1
+#define __STDC_FORMAT_MACROS
+#define __STDC_CONSTANT_MACROS
+#endif
+#include <etherbone.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace saftlib {
+
+	class AsyncCycleSource;
+
+	/// @brief an etherbone cycle that does not wait for the response of the device
+	///
+	/// Usage is like etherbone::Cycle, but instead of close() the cycle is submitted 
+	/// together with a callback function:
+	///
+	///     AsyncCycle cycle(device);
+	///     cycle.write(adr1, EB_DATA32, value);
+	///     cycle.read (adr2, EB_DATA32);
+	///     cycle.submit(guard, [](bool ok, const std::vector<eb_data_t> &reads) { ... });
+	///
+	/// submit returns immediately. When the device has responded (the EB_Source of the 
+	/// saftbus::Loop processes the response), the callback is called with one value per 
+	/// read() in the order of the read() calls. 
+	/// The callback is always called from the saftbus::Loop, never from within another 
+	/// etherbone access, so it does not matter if a synchronous etherbone::Cycle in some 
+	/// other place collects the response. Callbacks are called in the order in which the 
+	/// cycles were submitted. 
+	/// The callback is not called if the guard has expired. Objects that submit cycles 
+	/// keep the only shared_ptr of their guard, so no callback reaches a destroyed object.
+	class AsyncCycle {
+	public:
+		typedef std::function<void(bool ok, const std::vector<eb_data_t> &reads)> Callback;
+		typedef std::shared_ptr<void> Guard;
+
+		AsyncCycle(etherbone::Device &device);
+		/// a cycle that is destroyed without submit is aborted
+		~AsyncCycle();
+
+		void read (eb_address_t address, eb_format_t format = EB_DATA32);
+		void write(eb_address_t address, eb_format_t format, eb_data_t data);
+		/// read from the etherbone configuration space, the value is reported like the value of read()
+		void read_config(eb_address_t address, eb_format_t format = EB_DATA32);
+
+		/// @brief send the cycle, callback is called when the device has responded
+		void submit(const Guard &guard, Callback callback);
+		/// @brief send the cycle, only failures are reported (on std::cerr)
+		void submit();
+
+		/// @brief create a new guard for an object that submits cycles
+		static Guard make_guard();
+	private:
+		friend class AsyncCycleSource;
+		struct Pending;
+		static void done(Pending *pending, etherbone::Device dev, etherbone::Operation op, etherbone::status_t status);
+
+		etherbone::Cycle cycle;
+		Pending *pending;
+	};
+
+}
+
+#endif
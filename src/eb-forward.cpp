@@ -28,6 +28,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <poll.h>
+#include <errno.h>
 
 #include <iostream>
 #include <iomanip>
@@ -35,13 +36,35 @@
 
 #define WR_PPS_VENDOR_ID        0xce42
 #define WR_PPS_DEVICE_ID        0xde0d8ced
-#define WR_PPS_GEN_ESCR         0x1c      //External Sync Control Register
 
 namespace saftlib {
 
+	// Number of bytes that are read from the pseudo-terminal at once
+	const unsigned READ_BUFFER_SIZE = 4096;
+
+	// etherbone record header flags
+	const uint32_t EB_RECORD_BCA = 0x80000000;
+	const uint32_t EB_RECORD_RCA = 0x40000000;
+	const uint32_t EB_RECORD_RFF = 0x20000000;
+	const uint32_t EB_RECORD_CYC = 0x08000000;
+	const uint32_t EB_RECORD_WCA = 0x04000000;
+	const uint32_t EB_RECORD_WFF = 0x02000000;
+
+	static uint32_t get_word(const uint8_t *ptr) 
+	{
+		return uint32_t(ptr[0])<<24 | uint32_t(ptr[1])<<16 | uint32_t(ptr[2])<<8 | uint32_t(ptr[3]);
+	}
+	static void push_word(std::vector<uint8_t> &data, uint32_t word)
+	{
+		data.push_back(word>>24);
+		data.push_back(word>>16);
+		data.push_back(word>>8);
+		data.push_back(word>>0);
+	}
+
 	void EB_Forward::open_pts() 
 	{
-		_pts_fd = open("/dev/ptmx", O_RDWR);
+		_pts_fd = open("/dev/ptmx", O_RDWR | O_NOCTTY | O_NONBLOCK);
 		grantpt(_pts_fd);
 		unlockpt(_pts_fd);
 		chmod(ptsname(_pts_fd), S_IRUSR | S_IWUSR | 
@@ -52,29 +75,33 @@ namespace saftlib {
 		io_source = saftbus::Loop::get_default().connect<saftbus::IoSource>(std::bind(&EB_Forward::accept_connection, this, std::placeholders::_1), _pts_fd, POLLIN);
 	}
 
-	EB_Forward::EB_Forward(const std::string& eb_name, etherbone::Device &device)
+	bool EB_Forward::reopen_pts()
+	{
+		saftbus::Loop::get_default().remove(output_source);
+		output_source = saftbus::SourceHandle();
+		close(_pts_fd); // close and reopen immediately
+		// forget the old eb-tool. Responses to its cycles that are still in flight are dropped
+		request.clear();
+		responses.clear();
+		output.clear();
+		open_cycle.reset();
+		open_records.clear();
+		open_response.reset();
+		open_pts(); 
+		return false; // remove old fd from loop
+	}
+
+	EB_Forward::EB_Forward(etherbone::Device &device)
 		: SdbDevice(device, WR_PPS_VENDOR_ID, WR_PPS_DEVICE_ID)
+		, _pts_fd(0)
+		, async_guard(AsyncCycle::make_guard())
 	{	
-		_pts_fd = 0;
-		if (eb_name.size()) {
-			if (eb_name[0] == '/') {
-				_eb_device_fd = open(eb_name.c_str(), O_RDWR);
-			} else {
-				std::string name = "/";
-				name.append(eb_name);
-				_eb_device_fd = open(name.c_str(), O_RDWR);
-			}
-			if (_eb_device_fd > 0) {
-				open_pts();
-				return;
-			}
-		}
 		open_pts();
 	} 
 	EB_Forward::~EB_Forward()
 	{
 		saftbus::Loop::get_default().remove(io_source);
-		close(_eb_device_fd);
+		saftbus::Loop::get_default().remove(output_source);
 		if (_pts_fd) {
 			close(_pts_fd);
 		}		
@@ -82,156 +109,190 @@ namespace saftlib {
 
 	bool EB_Forward::accept_connection(int condition)
 	{
-		// std::cerr << "EB_Forward::accept_connection" << std::endl;
-		// static std::vector<uint8_t> request;  // data from eb-tool
-		// static std::vector<uint8_t> response; // data from device
-		request.clear();
-		response.clear();
-
-		unsigned request_size = 0;
-
+		// read everything that the eb-tool has written so far. 
+		// An incomplete record at the end stays in the request buffer until the next call.
 		for (;;) {
-			uint8_t val;
-			int result = read(_pts_fd, (void*)&val, sizeof(val));
+			uint8_t buffer[READ_BUFFER_SIZE];
+			int result = read(_pts_fd, (void*)buffer, sizeof(buffer));
+			if (result < 0 && (errno == EAGAIN || errno == EINTR)) {
+				break; // all available data read
+			}
 			if (result <= 0) { // end of file 
-				close(_pts_fd); // close and reopen immediately
-				open_pts(); 
-				return false; // remove old fd from loop
+				return reopen_pts();
 			}
-			if (result == sizeof(val)) { // normal read 
-				request.push_back(val);
-
-				if (request.size() == 4) {
-					if ( request[0]     == 0x4e  // test for Etherbone magic word
-					  && request[1]     == 0x6f 
-					  )//&& request[2]     == 0x11 
-					   //&& (request[3]     == 0xff || request[3] == 0x77)) // on 32 bit systems, the host will send 0x77 while on 64 bit systems the host will send 0xff
-					{
-						// hard-coded response
-						response.push_back(0x4e);
-						response.push_back(0x6f);
-						response.push_back(0x16);
-						response.push_back(0x44);
-
-						for (int i = 0; i < 4; ++i) {
-							result = read(_pts_fd, (void*)&val, sizeof(val));
-							if (result <= 0) { 
-								close(_pts_fd); // close and reopen immediately
-								open_pts(); 
-								return false; // remove old fd from loop
-							}
-							response.push_back(val);
-						}
-						result = write(_pts_fd, (void*)&response[0], response.size());
-						if (result <= 0) { 
-							close(_pts_fd); // close and reopen immediately
-							open_pts(); 
-							return false; // remove old fd from loop
-						}
-						// handling of Etherbone header done.
-						return true;
-					} else { // assume it is an Etherbone cycle header, calculate the response size
-						int wcount = request[2];
-						int rcount = request[3];
-						request_size += 4; // for the cycle header
-						if (wcount) {
-							request_size += 4 + 4*wcount; // base address + wcount write values 
-						}
-						if (rcount) {
-							request_size += 4 + 4*rcount; // base return address + rcount read addresses
-						}
-					}
-				}
+			request.insert(request.end(), buffer, buffer+result);
+		}
+		process_request();
+		return true;
+	}
 
-				// process the request by sending it to the device,
-				//  read the response from the device and write the 
-				//   response back to the eb-tool
-				if (request_size && request_size == request.size()) {
-					// std::cerr << _eb_device_fd << " " << _pts_fd << " request_size = " << request.size() << std::endl;
-					// all cycle bytes read
-
-					// visu.clear();
-					// for (int i = 0; i < (int)request.size()/4; ++i) {
-					// 	std::ostringstream req_out;
-					// 	for (int j = 0; j < 4; ++j) {
-					// 		req_out << std::hex << std::setw(2) << std::setfill('0') << (int)request[i*4+j];
-					// 	}
-					// 	visu.push_back(std::make_pair(req_out.str(),""));
-					// }
-
-
-					write_all(_eb_device_fd, (char*)&request[0], request.size());
-					response.clear();
-					response.resize(request.size());
-					struct pollfd pfds[1] = {0,};
-					pfds[0].fd = _eb_device_fd;
-					pfds[0].events = POLLIN | POLLHUP;
-					if (poll(pfds,1,-1) == 0) {
-						return false;
-					}
-					read_all(_eb_device_fd, (char*)&response[0], response.size());
-
-					// for (int i = 0; i < (int)response.size()/4; ++i) {
-					// 	std::ostringstream resp_out;
-					// 	for (int j = 0; j < 4; ++j) {
-					// 		resp_out << std::hex << std::setw(2) << std::setfill('0') << (int)response[i*4+j];
-					// 	}
-					// 	visu[i].second = resp_out.str();
-					// }
-
-					// std::cout << "---" << std::endl;
-					// for(auto &line: visu) {
-					// 	std::cout << line.first << "   " << line.second << std::endl;
-					// }
-
-
-					write_all(_pts_fd, (char*)&response[0], response.size());
-
-					// just read once after the forwarding procedure ... maybe this fixes the occasional wrong read
-					eb_data_t data;
-					device.read(adr_first + WR_PPS_GEN_ESCR, EB_DATA32, &data);
-
-
-					return true;
+	void EB_Forward::process_request()
+	{
+		// split the data into Etherbone headers and records.
+		unsigned pos = 0;
+		while (request.size()-pos >= 4) {
+			uint8_t *record = &request[pos];
+			if ( record[0]     == 0x4e  // test for Etherbone magic word
+			  && record[1]     == 0x6f 
+			  )//&& record[2]     == 0x11 
+			   //&& (record[3]     == 0xff || record[3] == 0x77)) // on 32 bit systems, the host will send 0x77 while on 64 bit systems the host will send 0xff
+			{
+				if (request.size()-pos < 8) {
+					break; // wait for the rest of the header
 				}
-
+				// hard-coded response
+				std::shared_ptr<Response> header_response = std::make_shared<Response>();
+				header_response->ready = true;
+				header_response->data  = {0x4e, 0x6f, 0x16, 0x44, record[4], record[5], record[6], record[7]};
+				responses.push_back(header_response);
+				// handling of Etherbone header done.
+				pos += 8;
+			} else { // assume it is an Etherbone record header, calculate the record size
+				int wcount = record[2];
+				int rcount = record[3];
+				unsigned record_size = 4; // for the record header
+				if (wcount) {
+					record_size += 4 + 4*wcount; // base address + wcount write values 
+				}
+				if (rcount) {
+					record_size += 4 + 4*rcount; // base return address + rcount read addresses
+				}
+				if (request.size()-pos < record_size) {
+					break; // wait for the rest of the record
+				}
+				add_record(record, record_size);
+				pos += record_size;
 			}
 		}
-		return false;
+		request.erase(request.begin(), request.begin()+pos);
+		flush_responses();
 	}	
 
-	void EB_Forward::write_all(int fd, char *ptr, int size) 
+	void EB_Forward::add_record(const uint8_t *record, unsigned size)
 	{
-		while (size > 0) {
-			int result = write(fd, ptr, size);
-			if (result > 0) {
-				size -= result;
-				ptr += result;
+		// All records up to the one with the cycle flag belong to the same wishbone cycle
+		if (!open_cycle) {
+			open_cycle.reset(new AsyncCycle(device));
+			open_response = std::make_shared<Response>();
+			open_response->ready = false;
+			responses.push_back(open_response);
+		}
+		uint32_t header = get_word(record);
+		unsigned wcount = record[2];
+		unsigned rcount = record[3];
+		const uint8_t *ptr = record+4;
+		Record r = {header, 0};
+		if (wcount) {
+			eb_address_t write_adr = get_word(ptr); 
+			ptr += 4;
+			for (unsigned i = 0; i < wcount; ++i, ptr += 4) {
+				if (!(header & EB_RECORD_WCA)) { // writes to the config space are ignored
+					open_cycle->write(write_adr, EB_DATA32, get_word(ptr));
+				}
+				// increment write_adr unless we are writing into a fifo
+				if (!(header & EB_RECORD_WFF)) write_adr += 4;
+			}
+		}
+		if (rcount) {
+			r.base_ret_adr = get_word(ptr);
+			ptr += 4;
+			for (unsigned i = 0; i < rcount; ++i, ptr += 4) {
+				if (header & EB_RECORD_RCA) {
+					open_cycle->read_config(get_word(ptr), EB_DATA32);
+				} else {
+					open_cycle->read(get_word(ptr), EB_DATA32);
+				}
+			}
+		}
+		open_records.push_back(r);
+
+		if (header & EB_RECORD_CYC) {
+			std::shared_ptr<Response> response = open_response;
+			std::vector<Record> records;
+			records.swap(open_records);
+			open_cycle->submit(async_guard, [this, response, records](bool ok, const std::vector<eb_data_t> &reads) {
+				cycle_done(response, records, ok, reads);
+			});
+			open_cycle.reset();
+			open_response.reset();
+		}
+	}
+
+	void EB_Forward::cycle_done(std::shared_ptr<Response> response, const std::vector<Record> &records, 
+		                        bool ok, const std::vector<eb_data_t> &reads)
+	{
+		if (!ok) {
+			std::cerr << "EB_Forward: forwarded cycle failed" << std::endl;
+		}
+		// The response to a record has the same size as the record.
+		// Writes are answered with zeros, and a header for the read response.
+		unsigned read_idx = 0;
+		for (auto &record: records) {
+			uint32_t header = record.header;
+			unsigned wcount = (header & 0x0000ff00) >> 8;
+			unsigned rcount = (header & 0x000000ff) >> 0;
+			uint32_t response_header  = (header & 0x00ff0000);     // echo byte_enable
+			         response_header |= (header & 0x000000ff) << 8; // rcount becomes wcount
+			         response_header |= bool(header & EB_RECORD_CYC) << 27; // response cyc <= request cyc
+			         response_header |= bool(header & EB_RECORD_BCA) << 26; // response wca <= request bca
+			         response_header |= bool(header & EB_RECORD_RFF) << 25; // response wff <= request rff
+			if (wcount > 0) {
+				push_word(response->data, 0x0);
+				push_word(response->data, 0x0);
+				for (unsigned i = 0; i < wcount; ++i) {
+					push_word(response->data, (i == wcount-1)?(response_header & 0xffffff00):0x0);
+				}
 			} else {
-				std::cerr << "EB_Forward::write_all failed" << std::endl;
-				// error... very bad... dont know how to handle this 
-				// this probably means that the device is not connected anymore
-				return;
+				push_word(response->data, response_header);
+			}
+			if (rcount > 0) {
+				push_word(response->data, record.base_ret_adr);
+				for (unsigned i = 0; i < rcount; ++i, ++read_idx) {
+					push_word(response->data, read_idx < reads.size() ? reads[read_idx] : 0x0);
+				}
 			}
 		}
-		// std::cerr << "EB_Forward::write_all done " << size << std::endl;
+		response->ready = true;
+		flush_responses();
+	}
 
+	void EB_Forward::flush_responses()
+	{
+		while (!responses.empty() && responses.front()->ready) {
+			output.insert(output.end(), responses.front()->data.begin(), responses.front()->data.end());
+			responses.pop_front();
+		}
+		write_output();
 	}
-	void EB_Forward::read_all(int fd, char *ptr, int size) 
+
+	void EB_Forward::write_output()
 	{
-		while (size > 0) {
-			int result = read(fd, ptr, size);
+		while (!output.empty()) {
+			int result = write(_pts_fd, (void*)&output[0], output.size());
 			if (result > 0) {
-				size -= result;
-				ptr += result;
+				output.erase(output.begin(), output.begin()+result);
+			} else if (result < 0 && errno == EINTR) {
+				continue;
+			} else if (result < 0 && errno == EAGAIN) {
+				// the rest is written when the eb-tool has taken some data
+				if (!output_source.connected()) {
+					output_source = saftbus::Loop::get_default().connect<saftbus::IoSource>(std::bind(&EB_Forward::output_ready, this, std::placeholders::_1), _pts_fd, POLLOUT);
+				}
+				return;
 			} else {
-				std::cerr << "EB_Forward::read_all failed" << std::endl;
-				// error... very bad... dont know how to handle this 
-				// this probably means that the device is not connected anymore
+				// the eb-tool is gone. accept_connection will notice it and reopen the pseudo-terminal
+				std::cerr << "EB_Forward::write_output failed" << std::endl;
+				output.clear();
 				return;
 			}
 		}
-		// std::cerr << "EB_Forward::read_all done " << size << std::endl;
+	}
+
+	bool EB_Forward::output_ready(int condition)
+	{
+		output_source = saftbus::SourceHandle(); // this source is removed, write_output connects a new one if needed
+		write_output();
+		return false;
 	}
 
 	std::string EB_Forward::eb_forward_path()
@@ -240,4 +301,3 @@ namespace saftlib {
 	}
 
 }
-
@@ -23,24 +23,32 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <deque>
+#include <memory>
 
 #include <saftbus/loop.hpp>
 
 #include "SdbDevice.hpp"
+#include "eb-async-cycle.hpp"
 
 namespace saftlib {
 
     /// @brief Maintains a pseudo-terminal device that mimics a serial etherbone device.
     ///
-    /// All data from the created pseudo terminal (e.g. /dev/pts/14) is read, split-up into complete 
-    /// etherbone packages and redirected to the real hardware. When the real hardware responds to the
-    /// etherbone request, the response is written back to the pseudo-terminal device.
+    /// All data from the created pseudo terminal (e.g. /dev/pts/14) is read and split-up into 
+    /// etherbone records. The reads and writes of the records are done with AsyncCycles on the 
+    /// etherbone::Device of the daemon, so the cycles of the eb-tool and of the daemon share one 
+    /// connection to the hardware. When the device has responded to a cycle, the response for the 
+    /// eb-tool is assembled and written back to the pseudo-terminal device.
     /// This effectively allows using eb-tools, such as eb-ls on serial devices, even when the device is
     /// occupied the TimingReceiver object.
+    /// Nothing blocks the event loop: the pseudo-terminal is non-blocking, responses are written
+    /// in the order of the requests as soon as they are complete, and whatever the eb-tool 
+    /// does not take immediately is written when the pseudo-terminal becomes writable.
+    /// Writes of the eb-tool to the etherbone configuration space are ignored.
 	class EB_Forward : public SdbDevice {
 	public:
-		EB_Forward(const std::string& eb_name, etherbone::Device &device); 
+		EB_Forward(etherbone::Device &device); 
 		~EB_Forward();
 
 		bool accept_connection(int condition);
@@ -50,17 +58,39 @@ namespace saftlib {
 		std::string eb_forward_path();
 
 	private:
-		void write_all(int fd, char *ptr, int size);
-		void read_all(int fd, char *ptr, int size);
+		// response to an etherbone header or to the records of one cycle
+		struct Response {
+			bool ready;
+			std::vector<uint8_t> data;
+		};
+		// what is needed to assemble the response to one record
+		struct Record {
+			uint32_t header;
+			uint32_t base_ret_adr;
+		};
+		void process_request();
+		void add_record(const uint8_t *record, unsigned size);
+		void cycle_done(std::shared_ptr<Response> response, const std::vector<Record> &records, 
+		                bool ok, const std::vector<eb_data_t> &reads);
+		void flush_responses();
+		void write_output();
+		bool output_ready(int condition);
 		void open_pts();
-		int     _eb_device_fd, _pts_fd; 
+		bool reopen_pts();
+		int     _pts_fd; 
         saftbus::SourceHandle io_source;
+        saftbus::SourceHandle output_source;
 
-        std::vector<std::pair<std::string, std::string> > visu;
+        std::vector<uint8_t> request;  // data from eb-tool, may end with an incomplete record
+        std::deque<std::shared_ptr<Response> > responses; // in the order of the requests
+        std::vector<uint8_t> output;   // complete responses that the pseudo-terminal did not yet take
 
-        std::vector<uint8_t> request;  // data from eb-tool
-        std::vector<uint8_t> response; // data from device
+        // the cycle of the eb-tool that is not yet complete (no record with the cycle flag so far)
+        std::unique_ptr<AsyncCycle>       open_cycle;
+        std::vector<Record>               open_records;
+        std::shared_ptr<Response>         open_response;
 
+        AsyncCycle::Guard async_guard;
 	};
 
 
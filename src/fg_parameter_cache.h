@@ -0,0 +1,115 @@
+/*  Copyright (C) 2021-2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+#ifndef FG_PARAMETER_CACHE_H_
+#define FG_PARAMETER_CACHE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+// Shared memory layout of format-version 1 for MasterFunctionGenerator::InitializeSharedMemory.
+//
+// The boost::interprocess::managed_shared_memory segment contains
+//   - an int32_t named "format-version" with value 1
+//   - a char array named "ParameterCache" (FG_PARAMETER_CACHE_NAME) holding one flat block:
+//
+//       FgParameterCacheHeader
+//       FgParameterCacheEntry index[num_fgs * num_beam_processes]
+//       parameter tuples        [tuple_capacity] (12 bytes each, same layout as saftlib::ParameterTuple)
+//
+// The block contains no pointers, only offsets relative to its start, so it can be mapped at
+// any address. The entry for (fg, beam_process) is index[fg * num_beam_processes + beam_process],
+// fg counts the active function generators of the MasterFunctionGenerator starting at 0.
+// An entry with count == 0 means there is no data for that fg in that beam process.
+//
+// Readers do not take a lock. The writer makes the sequence counter odd before it modifies
+// index or tuple data and makes it even again when it is done (fg_parameter_cache_begin_write
+// and fg_parameter_cache_end_write). A reader that sees an odd sequence, or a sequence that
+// changed while the reader was copying data, discards what it copied and tries again.
+// The writer must not change the dimensions in the header after the block was created.
+
+#define FG_PARAMETER_CACHE_NAME           "ParameterCache"
+#define FG_PARAMETER_CACHE_MAGIC          0x46475043  // "FGPC"
+#define FG_PARAMETER_CACHE_FORMAT_VERSION 1
+#define FG_PARAMETER_CACHE_TUPLE_SIZE     12
+
+struct FgParameterCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	std::atomic<uint32_t> sequence;
+	uint32_t num_fgs;
+	uint32_t num_beam_processes;
+	uint32_t tuple_capacity;
+	uint64_t index_offset;  // in bytes from start of the header
+	uint64_t tuples_offset; // in bytes from start of the header
+};
+
+struct FgParameterCacheEntry {
+	uint32_t first; // index of the first tuple
+	uint32_t count; // number of tuples
+};
+
+inline std::size_t fg_parameter_cache_size(uint32_t num_fgs, uint32_t num_beam_processes, uint32_t tuple_capacity)
+{
+	return sizeof(FgParameterCacheHeader)
+	     + sizeof(FgParameterCacheEntry) * num_fgs * num_beam_processes
+	     + FG_PARAMETER_CACHE_TUPLE_SIZE * tuple_capacity;
+}
+
+// initialize a block of at least fg_parameter_cache_size(...) bytes with an empty index
+inline FgParameterCacheHeader *fg_parameter_cache_init(void *block, uint32_t num_fgs, uint32_t num_beam_processes, uint32_t tuple_capacity)
+{
+	FgParameterCacheHeader *header = static_cast<FgParameterCacheHeader*>(block);
+	header->magic              = FG_PARAMETER_CACHE_MAGIC;
+	header->version            = FG_PARAMETER_CACHE_FORMAT_VERSION;
+	header->sequence.store(0);
+	header->num_fgs            = num_fgs;
+	header->num_beam_processes = num_beam_processes;
+	header->tuple_capacity     = tuple_capacity;
+	header->index_offset       = sizeof(FgParameterCacheHeader);
+	header->tuples_offset      = header->index_offset + sizeof(FgParameterCacheEntry) * num_fgs * num_beam_processes;
+	FgParameterCacheEntry *index = reinterpret_cast<FgParameterCacheEntry*>(static_cast<char*>(block) + header->index_offset);
+	for (uint32_t i = 0; i < num_fgs * num_beam_processes; ++i) {
+		index[i].first = 0;
+		index[i].count = 0;
+	}
+	return header;
+}
+
+inline FgParameterCacheEntry *fg_parameter_cache_index(FgParameterCacheHeader *header)
+{
+	return reinterpret_cast<FgParameterCacheEntry*>(reinterpret_cast<char*>(header) + header->index_offset);
+}
+
+inline char *fg_parameter_cache_tuples(FgParameterCacheHeader *header)
+{
+	return reinterpret_cast<char*>(header) + header->tuples_offset;
+}
+
+inline void fg_parameter_cache_begin_write(FgParameterCacheHeader *header)
+{
+	header->sequence.fetch_add(1, std::memory_order_acq_rel); // odd: write in progress
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+inline void fg_parameter_cache_end_write(FgParameterCacheHeader *header)
+{
+	header->sequence.fetch_add(1, std::memory_order_release); // even: data is consistent
+}
+
+#endif
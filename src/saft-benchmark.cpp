@@ -0,0 +1,537 @@
+#include "SAFTd_Proxy.hpp"
+#include "TimingReceiver_Proxy.hpp"
+#include "SoftwareActionSink_Proxy.hpp"
+#include "SoftwareCondition_Proxy.hpp"
+#include "CommonFunctions.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <exception>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+// End-to-end benchmark of saftbusd with a TimingReceiver (typically emulated by saft-software-tr).
+//
+// A matrix of scenarios is run. Each scenario has a number of client processes, each client
+// has a number of SoftwareActionSinks (signal fan-out) with the same set of conditions.
+// The benchmark injects bursts of events, every event matches one condition of every sink
+// of every client. The injection time (steady clock) is passed in the event parameter, so
+// every client can measure the latency from InjectEvent until its callback is called.
+// The next burst is injected when all clients have received all actions of the previous burst.
+// Optionally, every client calls a proxy function at a given rate while it receives actions.
+//
+// The result (latency percentiles and sustained throughput of each scenario) is written as
+// JSON with one scenario per line. A previous result can be used as baseline, the program
+// reports all metrics that are worse than the baseline by more than the tolerance and
+// returns 2 in that case.
+
+static const uint64_t benchmark_event_id = UINT64_C(0xbe0c000000000000);
+
+static uint64_t steady_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// latencies in 1 us bins, the last bin holds everything >= 100 ms
+struct Histogram {
+	enum { bins = 100000 };
+	std::vector<uint64_t> counts;
+	uint64_t count, max_ns;
+	Histogram() : counts(bins, 0), count(0), max_ns(0) {}
+	void add(uint64_t ns) {
+		uint64_t bin = ns/1000;
+		++counts[bin<bins?bin:bins-1];
+		++count;
+		if (ns > max_ns) max_ns = ns;
+	}
+	// upper limit of the bin that contains the given fraction of all values
+	uint64_t percentile_us(double fraction) const {
+		uint64_t limit = fraction*count, sum = 0;
+		for (unsigned bin = 0; bin < bins; ++bin) {
+			sum += counts[bin];
+			if (sum > limit) return bin+1;
+		}
+		return bins;
+	}
+	// transfer between processes: "<max_ns> <bin>:<count> <bin>:<count> ..."
+	std::string to_string() const {
+		std::ostringstream out;
+		out << max_ns;
+		for (unsigned bin = 0; bin < bins; ++bin) {
+			if (counts[bin]) out << " " << bin << ":" << counts[bin];
+		}
+		return out.str();
+	}
+	bool merge(const std::string &str) {
+		std::istringstream in(str);
+		uint64_t max, bin, n;
+		char colon;
+		if (!(in >> max)) return false;
+		if (max > max_ns) max_ns = max;
+		while (in >> bin >> colon >> n) {
+			if (bin >= bins || colon != ':') return false;
+			counts[bin] += n;
+			count += n;
+		}
+		return true;
+	}
+};
+
+struct Scenario {
+	unsigned clients;
+	unsigned conditions;
+	unsigned burst;
+	unsigned fanout;
+	unsigned call_rate; // proxy calls per second and client
+	std::string name() const {
+		std::ostringstream out;
+		out << "clients=" << clients << " conditions=" << conditions << " burst=" << burst
+		    << " fanout=" << fanout << " call_rate=" << call_rate;
+		return out.str();
+	}
+};
+
+struct Result {
+	std::string name;
+	std::map<std::string, double> values;
+	std::string error;
+};
+
+
+//////////////////////////////////////////////////
+// client process
+//////////////////////////////////////////////////
+
+// Protocol on stdout: "ready", then "ack" whenever all actions of one burst were received,
+// finally "histogram <Histogram::to_string()>".
+static int run_client(const std::string &device, unsigned conditions, unsigned fanout, unsigned burst, unsigned call_rate, unsigned events)
+{
+	auto tr = saftlib::TimingReceiver_Proxy::create(std::string("/de/gsi/saftlib/")+device);
+	Histogram histogram;
+	uint64_t received = 0;
+	uint64_t per_burst = (uint64_t)burst*fanout;
+	uint64_t expected  = (uint64_t)events*fanout;
+
+	std::vector<std::shared_ptr<saftlib::SoftwareActionSink_Proxy> > sinks;
+	std::vector<std::shared_ptr<saftlib::SoftwareCondition_Proxy> >  conds;
+	for (unsigned s = 0; s < fanout; ++s) {
+		sinks.push_back(saftlib::SoftwareActionSink_Proxy::create(tr->NewSoftwareActionSink("")));
+		for (unsigned c = 0; c < conditions; ++c) {
+			auto condition = saftlib::SoftwareCondition_Proxy::create(sinks.back()->NewCondition(true, benchmark_event_id | c, ~UINT64_C(0), 0));
+			// injected events are always late, and events of one burst have the same deadline
+			condition->setAcceptEarly(true);
+			condition->setAcceptLate(true);
+			condition->setAcceptConflict(true);
+			condition->setAcceptDelayed(true);
+			condition->SigAction.connect([&](uint64_t id, uint64_t param, saftlib::Time deadline, saftlib::Time executed, uint16_t flags) {
+				histogram.add(steady_ns() - param);
+				if (++received % per_burst == 0) {
+					std::cout << "ack" << std::endl;
+				}
+			});
+			conds.push_back(condition);
+		}
+	}
+	std::cout << "ready" << std::endl;
+
+	uint64_t call_period = call_rate ? UINT64_C(1000000000)/call_rate : 0;
+	uint64_t next_call   = steady_ns() + call_period;
+	while (received < expected) {
+		int timeout_ms = 100;
+		if (call_period) {
+			uint64_t now = steady_ns();
+			if (now >= next_call) {
+				tr->getName();
+				next_call += call_period;
+				continue;
+			}
+			timeout_ms = (next_call-now)/1000000;
+		}
+		if (saftlib::wait_for_signal(timeout_ms) < 0) {
+			std::cerr << "saft-benchmark client: lost connection" << std::endl;
+			return 1;
+		}
+		if (getppid() == 1) {
+			return 1; // the benchmark process is gone
+		}
+	}
+	std::cout << "histogram " << histogram.to_string() << std::endl;
+	return 0;
+}
+
+
+//////////////////////////////////////////////////
+// benchmark process
+//////////////////////////////////////////////////
+
+struct Client {
+	pid_t pid;
+	int fd;
+	std::string buffer;
+	Client() : pid(-1), fd(-1) {}
+	~Client() {
+		if (fd >= 0) close(fd);
+		if (pid > 0) {
+			kill(pid, SIGTERM);
+			waitpid(pid, nullptr, 0);
+		}
+	}
+	// read one line from the client, false on timeout or if the client quits
+	bool read_line(std::string &line, int timeout_ms) {
+		for (;;) {
+			size_t pos = buffer.find('\n');
+			if (pos != std::string::npos) {
+				line = buffer.substr(0, pos);
+				buffer.erase(0, pos+1);
+				return true;
+			}
+			struct pollfd pfd = {fd, POLLIN, 0};
+			if (poll(&pfd, 1, timeout_ms) != 1) {
+				return false;
+			}
+			char chunk[4096];
+			ssize_t n = read(fd, chunk, sizeof(chunk));
+			if (n <= 0) {
+				return false;
+			}
+			buffer.append(chunk, n);
+		}
+	}
+};
+
+static void start_client(Client &client, const char *program, const std::string &device, const Scenario &scenario, unsigned events)
+{
+	int pipefd[2];
+	if (pipe(pipefd) != 0) {
+		throw std::runtime_error(std::string("cannot create pipe: ") + strerror(errno));
+	}
+	std::vector<std::string> args = {program, device, "--client",
+		std::to_string(scenario.conditions), std::to_string(scenario.fanout), std::to_string(scenario.burst),
+		std::to_string(scenario.call_rate), std::to_string(events)};
+	client.pid = fork();
+	if (client.pid < 0) {
+		throw std::runtime_error(std::string("cannot fork: ") + strerror(errno));
+	}
+	if (client.pid == 0) {
+		// the client needs its own saftbus connection, so it starts as a new program
+		dup2(pipefd[1], 1);
+		close(pipefd[0]);
+		close(pipefd[1]);
+		std::vector<char*> argv;
+		for (auto &arg: args) argv.push_back(&arg[0]);
+		argv.push_back(nullptr);
+		execv("/proc/self/exe", &argv[0]);
+		std::cerr << "cannot start client: " << strerror(errno) << std::endl;
+		_exit(1);
+	}
+	close(pipefd[1]);
+	client.fd = pipefd[0];
+}
+
+static Result run_scenario(const char *program, const std::string &device, std::shared_ptr<saftlib::TimingReceiver_Proxy> tr, const Scenario &scenario, unsigned events)
+{
+	Result result;
+	result.name = scenario.name();
+	result.values["clients"]    = scenario.clients;
+	result.values["conditions"] = scenario.conditions;
+	result.values["burst"]      = scenario.burst;
+	result.values["fanout"]     = scenario.fanout;
+	result.values["call_rate"]  = scenario.call_rate;
+
+	unsigned bursts = (events + scenario.burst - 1) / scenario.burst;
+	events = bursts*scenario.burst;
+	std::vector<Client> clients(scenario.clients);
+	for (auto &client: clients) {
+		start_client(client, program, device, scenario, events);
+	}
+	std::string line;
+	for (auto &client: clients) {
+		if (!client.read_line(line, 10000) || line != "ready") {
+			result.error = "client did not start";
+			return result;
+		}
+	}
+
+	uint64_t start = steady_ns();
+	for (unsigned b = 0; b < bursts; ++b) {
+		for (unsigned e = 0; e < scenario.burst; ++e) {
+			uint64_t id = benchmark_event_id | ((b*scenario.burst + e) % scenario.conditions);
+			tr->InjectEvent(id, steady_ns(), saftlib::makeTimeTAI(0));
+		}
+		for (auto &client: clients) {
+			if (!client.read_line(line, 5000) || line != "ack") {
+				result.error = "actions were lost (timeout)";
+				return result;
+			}
+		}
+	}
+	double seconds = (steady_ns() - start)/1e9;
+
+	Histogram histogram;
+	for (auto &client: clients) {
+		if (!client.read_line(line, 5000) || line.compare(0, 10, "histogram ") != 0 || !histogram.merge(line.substr(10))) {
+			result.error = "client did not report its measurement";
+			return result;
+		}
+	}
+	result.values["events"]   = events;
+	result.values["actions"]  = histogram.count;
+	result.values["p50_us"]   = histogram.percentile_us(0.5);
+	result.values["p99_us"]   = histogram.percentile_us(0.99);
+	result.values["p999_us"]  = histogram.percentile_us(0.999);
+	result.values["max_us"]   = histogram.max_ns/1000;
+	result.values["per_s"]    = seconds > 0 ? histogram.count/seconds : 0;
+	return result;
+}
+
+// latency and rate of one proxy function call without any signals
+static Result run_proxy_calls(std::shared_ptr<saftlib::TimingReceiver_Proxy> tr, unsigned calls)
+{
+	Result result;
+	result.name = "proxy-calls";
+	Histogram histogram;
+	uint64_t start = steady_ns();
+	for (unsigned i = 0; i < calls; ++i) {
+		uint64_t call_start = steady_ns();
+		tr->getName();
+		histogram.add(steady_ns() - call_start);
+	}
+	double seconds = (steady_ns() - start)/1e9;
+	result.values["calls"]   = calls;
+	result.values["p50_us"]  = histogram.percentile_us(0.5);
+	result.values["p99_us"]  = histogram.percentile_us(0.99);
+	result.values["p999_us"] = histogram.percentile_us(0.999);
+	result.values["max_us"]  = histogram.max_ns/1000;
+	result.values["per_s"]   = seconds > 0 ? calls/seconds : 0;
+	return result;
+}
+
+static void write_json(std::ostream &out, const std::string &device, const std::vector<Result> &results)
+{
+	out << "{" << std::endl;
+	out << "  \"device\": \"" << device << "\"," << std::endl;
+	out << "  \"scenarios\": [" << std::endl;
+	for (unsigned i = 0; i < results.size(); ++i) {
+		out << "    {\"name\": \"" << results[i].name << "\"";
+		for (auto &value: results[i].values) {
+			out << ", \"" << value.first << "\": " << std::fixed << std::setprecision(value.first == "per_s" ? 1 : 0) << value.second;
+		}
+		if (!results[i].error.empty()) {
+			out << ", \"error\": \"" << results[i].error << "\"";
+		}
+		out << "}" << (i+1 < results.size() ? "," : "") << std::endl;
+	}
+	out << "  ]" << std::endl;
+	out << "}" << std::endl;
+}
+
+// read the scenario lines of a file that was written by write_json
+static std::map<std::string, Result> read_json(const std::string &filename)
+{
+	std::ifstream in(filename.c_str());
+	if (!in) {
+		throw std::runtime_error(std::string("cannot open baseline file ") + filename);
+	}
+	std::map<std::string, Result> results;
+	std::string line;
+	while (std::getline(in, line)) {
+		size_t pos = line.find("{\"name\": \"");
+		if (pos == std::string::npos) continue;
+		pos += 10;
+		size_t end = line.find('"', pos);
+		if (end == std::string::npos) continue;
+		Result result;
+		result.name = line.substr(pos, end-pos);
+		pos = end+1;
+		for (;;) {
+			size_t key_begin = line.find(", \"", pos);
+			if (key_begin == std::string::npos) break;
+			key_begin += 3;
+			size_t key_end = line.find("\": ", key_begin);
+			if (key_end == std::string::npos) break;
+			std::string key = line.substr(key_begin, key_end-key_begin);
+			std::istringstream value_in(line.substr(key_end+3));
+			double value;
+			if (value_in >> value) {
+				result.values[key] = value;
+			} else {
+				result.error = "baseline has no measurement";
+			}
+			pos = key_end+3;
+		}
+		results[result.name] = result;
+	}
+	return results;
+}
+
+// print the comparison, return true if something got worse by more than tolerance percent
+static bool compare(const std::vector<Result> &results, const std::map<std::string, Result> &baseline, double tolerance)
+{
+	bool regression = false;
+	const char *lower_is_better[]  = {"p50_us", "p99_us", "p999_us"};
+	std::cerr << std::left << std::setw(60) << "scenario" << std::setw(10) << "metric"
+	          << std::right << std::setw(14) << "baseline" << std::setw(14) << "now" << std::setw(10) << "change" << std::endl;
+	for (auto &result: results) {
+		auto base = baseline.find(result.name);
+		if (base == baseline.end() || !base->second.error.empty() || !result.error.empty()) {
+			continue;
+		}
+		std::vector<std::pair<std::string, bool> > metrics;
+		for (auto metric: lower_is_better) metrics.push_back(std::make_pair(std::string(metric), true));
+		metrics.push_back(std::make_pair(std::string("per_s"), false));
+		for (auto &metric: metrics) {
+			auto now_value  = result.values.find(metric.first);
+			auto base_value = base->second.values.find(metric.first);
+			if (now_value == result.values.end() || base_value == base->second.values.end() || base_value->second <= 0) {
+				continue;
+			}
+			double change = 100.0*(now_value->second - base_value->second)/base_value->second;
+			bool worse = metric.second ? change > tolerance : change < -tolerance;
+			std::cerr << std::left << std::setw(60) << result.name << std::setw(10) << metric.first
+			          << std::right << std::fixed << std::setprecision(1)
+			          << std::setw(14) << base_value->second << std::setw(14) << now_value->second
+			          << std::setw(9) << change << "%" << (worse ? "  REGRESSION" : "") << std::endl;
+			regression |= worse;
+		}
+	}
+	return regression;
+}
+
+static bool parse_list(const char *str, std::vector<unsigned> &result, bool allow_zero = false)
+{
+	result.clear();
+	std::istringstream in(str);
+	std::string item;
+	while (std::getline(in, item, ',')) {
+		std::istringstream item_in(item);
+		unsigned value;
+		if (!(item_in >> value) || (value == 0 && !allow_zero)) return false;
+		result.push_back(value);
+	}
+	return !result.empty();
+}
+
+static void help(const char *program)
+{
+	std::cerr << "Run a matrix of end-to-end benchmark scenarios against saftbusd and a TimingReceiver" << std::endl;
+	std::cerr << "(typically emulated by saft-software-tr) and report latency and throughput as JSON." << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "usage: " << program << " <saftlib-device> [options]" << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "  --clients <list>      number of client processes, e.g. 1,2,4 (default: 1)" << std::endl;
+	std::cerr << "  --conditions <list>   number of conditions per SoftwareActionSink (default: 1)" << std::endl;
+	std::cerr << "  --bursts <list>       number of events injected back to back (default: 1)" << std::endl;
+	std::cerr << "  --fanout <list>       number of SoftwareActionSinks per client that receive every event (default: 1)" << std::endl;
+	std::cerr << "  --call-rates <list>   proxy calls per second that every client does while receiving actions (default: 0)" << std::endl;
+	std::cerr << "  --events <n>          number of injected events per scenario (default: 1000)" << std::endl;
+	std::cerr << "  --proxy-calls <n>     number of calls for the proxy call measurement, 0 to skip it (default: 10000)" << std::endl;
+	std::cerr << "  --output <file>       write the JSON result to this file instead of stdout" << std::endl;
+	std::cerr << "  --baseline <file>     compare with a previous result, return 2 if a metric got worse" << std::endl;
+	std::cerr << "  --tolerance <percent> allowed change of a metric before it counts as regression (default: 20)" << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "   example: saft-software-tr &" << std::endl;
+	std::cerr << "            saftbusd libsaft-service.so tr0:$(cat /tmp/simbridge-eb-device) &" << std::endl;
+	std::cerr << "            " << program << " tr0 --clients 1,4 --bursts 1,10 --output baseline.json" << std::endl;
+	std::cerr << "            " << program << " tr0 --clients 1,4 --bursts 1,10 --baseline baseline.json" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		help(argv[0]);
+		return 1;
+	}
+	std::string device = argv[1];
+	try {
+		if (argc == 8 && std::string(argv[2]) == "--client") {
+			unsigned values[5];
+			for (int i = 0; i < 5; ++i) {
+				std::istringstream in(argv[3+i]);
+				if (!(in >> values[i])) return 1;
+			}
+			return run_client(device, values[0], values[1], values[2], values[3], values[4]);
+		}
+
+		std::vector<unsigned> clients = {1}, conditions = {1}, bursts = {1}, fanouts = {1}, call_rates = {0};
+		unsigned events = 1000, proxy_calls = 10000;
+		std::string output, baseline;
+		double tolerance = 20;
+		for (int i = 2; i < argc; ++i) {
+			std::string arg = argv[i];
+			const char *value = (i+1 < argc) ? argv[i+1] : "";
+			bool ok = true;
+			if      (arg == "--clients")     ok = parse_list(value, clients);
+			else if (arg == "--conditions")  ok = parse_list(value, conditions);
+			else if (arg == "--bursts")      ok = parse_list(value, bursts);
+			else if (arg == "--fanout")      ok = parse_list(value, fanouts);
+			else if (arg == "--call-rates")  ok = parse_list(value, call_rates, true);
+			else if (arg == "--events")      { std::istringstream in(value); ok = (in >> events) && events > 0; }
+			else if (arg == "--proxy-calls") { std::istringstream in(value); ok = !!(in >> proxy_calls); }
+			else if (arg == "--output")      output = value;
+			else if (arg == "--baseline")    baseline = value;
+			else if (arg == "--tolerance")   { std::istringstream in(value); ok = !!(in >> tolerance); }
+			else if (arg == "-h" || arg == "--help") { help(argv[0]); return 0; }
+			else {
+				std::cerr << "unknown option " << arg << std::endl;
+				return 1;
+			}
+			if (!ok) {
+				std::cerr << "invalid value \"" << value << "\" for " << arg << std::endl;
+				return 1;
+			}
+			++i;
+		}
+
+		auto tr = saftlib::TimingReceiver_Proxy::create(std::string("/de/gsi/saftlib/")+device);
+
+		std::vector<Result> results;
+		if (proxy_calls > 0) {
+			results.push_back(run_proxy_calls(tr, proxy_calls));
+		}
+		for (auto c: clients) for (auto k: conditions) for (auto b: bursts) for (auto f: fanouts) for (auto r: call_rates) {
+			Scenario scenario = {c, k, b, f, r};
+			std::cerr << scenario.name() << " ..." << std::flush;
+			results.push_back(run_scenario(argv[0], device, tr, scenario, events));
+			const Result &result = results.back();
+			if (result.error.empty()) {
+				std::cerr << " p50 < " << result.values.at("p50_us") << " us, p99 < " << result.values.at("p99_us")
+				          << " us, " << (uint64_t)result.values.at("per_s") << " actions/s" << std::endl;
+			} else {
+				std::cerr << " " << result.error << std::endl;
+			}
+		}
+
+		if (output.empty()) {
+			write_json(std::cout, device, results);
+		} else {
+			std::ofstream out(output.c_str());
+			write_json(out, device, results);
+			if (!out) {
+				std::cerr << "cannot write " << output << std::endl;
+				return 1;
+			}
+		}
+
+		if (!baseline.empty() && compare(results, read_json(baseline), tolerance)) {
+			return 2;
+		}
+
+	} catch (std::runtime_error &e ) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
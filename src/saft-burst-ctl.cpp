@@ -613,14 +613,20 @@ static int  bg_invoke_async(std::shared_ptr<BurstGenerator_Proxy> bg, uint32_t i
     return -1;
   }
 
+  // instructions are queued in saftd, the signals may belong to instructions sent before or after this one.
+  // The response is taken from the signal argument, getResponse() may already be overwritten by a later instruction.
   uint32_t response = 0;
-  int n_timeout = 3;
+  sigc::connection on_complete = bg->sigInstComplete.connect([&response, inst_code](uint32_t value) {
+    if ((value & 0xFFFF) == inst_code)
+      response = value;
+  });
 
-  while (!response && n_timeout) {
+  int n_timeout = 3;
+  while (((response & 0xFFFF) != inst_code) && n_timeout) {
     if (saftlib::wait_for_signal(1000) == 0)  // wait for response or time-out (burst generator checks its mailbox every second)
       --n_timeout;                            // count time-out
-    response = bg->getResponse();             // check response
   }
+  on_complete.disconnect();
 
   uint32_t ret_code = response & 0xFFFF;
   if (ret_code != inst_code)
@@ -118,6 +118,8 @@ static void help(void) {
   std::cout << "                                   <poll-iv> is the polling interval for MSI on USB devices (default is 1 ms)." << std::endl;
   std::cout << "  remove                           remove the device from saftlib management " << std::endl;
   std::cout << "  quit                             instructs the saftlib daemon to quit " << std::endl << std::endl;
+  std::cout << "  check-shadow                     compare saftlib's shadow copies of configuration registers with the hardware" << std::endl;
+  std::cout << "  housekeeping                     display duration statistics of the periodic housekeeping (lock state, watchdogs)" << std::endl;
   std::cout << std::endl;
   std::cout << "This tool displays Timing Receiver and related saftlib status. It can also be used to list the ECA status for" << std::endl;
   std::cout << "software actions. Furthermore, one can do simple things with a Timing Receiver (snoop for events, inject messages)." <<std::endl;
@@ -315,6 +317,8 @@ int main(int argc, char** argv)
   bool deviceRemove   = false;
   bool useFirstDev    = false;
   bool saftdQuit      = false;
+  bool shadowCheck    = false;
+  bool housekeepingDisp = false;
   bool currentTemp    = false;
   bool devInject      = false;          // development mode to inject without WR-lock
   char *value_end;
@@ -519,6 +523,22 @@ int main(int argc, char** argv)
       saftdQuit = true;
     } // "quit"
 
+    else if (strcasecmp(command, "check-shadow") == 0) {
+      if (optind+2  != argc) {
+        std::cerr << program << ": expecting no argument: check-shadow" << std::endl;
+        return 1;
+      }
+      shadowCheck = true;
+    } // "check-shadow"
+
+    else if (strcasecmp(command, "housekeeping") == 0) {
+      if (optind+2  != argc) {
+        std::cerr << program << ": expecting no argument: housekeeping" << std::endl;
+        return 1;
+      }
+      housekeepingDisp = true;
+    } // "housekeeping"
+
     else std::cerr << program << ": unknown command: " << command << std::endl;
   } // commands
 
@@ -592,6 +612,26 @@ int main(int argc, char** argv)
       displayCurrentTemperature(receiver);
     }
 
+    // compare shadow registers with hardware
+    if (shadowCheck) {
+      std::vector<std::string> mismatches = receiver->CheckRegisterShadow();
+      for (auto &mismatch: mismatches) {
+        std::cout << mismatch << std::endl;
+      }
+      std::cout << "shadow registers: " << (mismatches.empty()?"consistent":"inconsistent (now updated from hardware)") << std::endl;
+      if (!mismatches.empty()) {
+        return 1;
+      }
+    }
+
+    // display housekeeping statistics
+    if (housekeepingDisp) {
+      std::map<std::string, uint64_t> stats = receiver->getHousekeepingStatistics();
+      std::cout << "housekeeping cycles: " << stats["count"] << " (failed: " << stats["failed"] << ", skipped: " << stats["skipped"] << ")" << std::endl;
+      std::cout << "duration [us]: last " << stats["last_us"] << ", min " << stats["min_us"] 
+                << ", mean " << stats["mean_us"] << ", max " << stats["max_us"] << std::endl;
+    }
+
     std::shared_ptr<SoftwareActionSink_Proxy> sink = SoftwareActionSink_Proxy::create(receiver->NewSoftwareActionSink(""));
 
     // display status of software actions
@@ -12,6 +12,10 @@
 #include <stdio.h>
 #include <iostream>
 #include <unistd.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
 
 #include "interfaces/SAFTd.h"
 #include "interfaces/TimingReceiver.h"
@@ -52,6 +56,7 @@ static void ecpu_help (void)
   std::cout << "  -x:                            Destroy all unowned conditions" << std::endl;
   std::cout << "  -z                             Translate mask, e.g. '16' -> '0xffff00000000'" << std::endl;
   std::cout << "  -l                             List conditions" << std::endl;
+  std::cout << "  -w <cpu> <firmware.bin>:       Halt cpu, load and verify firmware, reset cpu (prints timing)" << std::endl;
   std::cout << "  -h:                            Print help (this message)" << std::endl;
   std::cout << "  -v:                            Switch to verbose mode" << std::endl;
   std::cout << std::endl;
@@ -59,6 +64,8 @@ static void ecpu_help (void)
   std::cout << program << " exploder5a_123t " << "-c 64 58 0x2 0x4 -d -z" << std::endl;
   std::cout << program << " exploder5a_123t " << "-c 64 0xffffffffffffffff 0x2 0x4 -d" << std::endl;
   std::cout << "  This will create a new condition and disown it" << std::endl;
+  std::cout << program << " exploder5a_123t " << "-w 0 firmware.bin" << std::endl;
+  std::cout << "  This will load firmware.bin into user cpu 0 and restart it" << std::endl;
   std::cout << std::endl;
   std::cout << BugReportContact << std::endl;
   std::cout << ToolLicenseGPL << std::endl;
@@ -80,6 +87,9 @@ int main (int argc, char** argv)
   bool translate_mask  = false;
   bool list_conditions = false;
   bool negative_offset = false;
+  bool load_firmware   = false;
+  unsigned cpu_idx     = 0;
+  std::string firmware;
   uint64_t eventID      = 0x0;
   uint64_t eventMask    = 0x0;
   int64_t  offset       = 0x0;
@@ -91,7 +101,7 @@ int main (int argc, char** argv)
   program = argv[0];
 
   /* Parse arguments */
-  while ((opt = getopt(argc, argv, "c:dgxzlvh")) != -1)
+  while ((opt = getopt(argc, argv, "c:dgxzlw:vh")) != -1)
   {
     switch (opt)
     {
@@ -108,6 +118,15 @@ int main (int argc, char** argv)
         else                        { std::cerr << "Error: Missing tag!" << std::endl; return (-1); }
         break;
       }
+      case 'w':
+      {
+        load_firmware = true;
+        cpu_idx = strtoul(argv[optind-1], &pEnd, 0);
+        if (*pEnd != 0)             { std::cerr << "Error: Invalid cpu index!" << std::endl; return (-1); }
+        if (argv[optind] != NULL)   { firmware = argv[optind++]; }
+        else                        { std::cerr << "Error: Missing firmware file!" << std::endl; return (-1); }
+        break;
+      }
       case 'd': { disown_sink     = true; break; }
       case 'g': { negative_offset = true; break; }
       case 'x': { destroy_sink    = true; break; }
@@ -170,6 +189,36 @@ int main (int argc, char** argv)
     }
     std::shared_ptr<TimingReceiver_Proxy> receiver = TimingReceiver_Proxy::create(devices[deviceName]);
 
+    /* Load firmware, this does not need the embedded CPU action sink */
+    if (load_firmware)
+    {
+      /* the file is read here, saftbusd only gets its content */
+      std::vector<uint32_t> image;
+      auto t_read = std::chrono::steady_clock::now();
+      try
+      {
+        image = saftlib::read_firmware_image(firmware);
+      }
+      catch (std::runtime_error &e)
+      {
+        std::cerr << e.what() << std::endl;
+        return (-1);
+      }
+      auto t0 = std::chrono::steady_clock::now();
+      receiver->SafeHaltCpu(cpu_idx);
+      auto t1 = std::chrono::steady_clock::now();
+      receiver->WriteFirmwareImage(cpu_idx, image);
+      auto t2 = std::chrono::steady_clock::now();
+      receiver->CpuReset(cpu_idx);
+      auto t3 = std::chrono::steady_clock::now();
+      std::cout << "Firmware " << firmware << " loaded into cpu " << cpu_idx << " and verified" << std::endl;
+      std::cout << "  read file:         " << std::chrono::duration_cast<std::chrono::microseconds>(t0-t_read).count() << " us" << std::endl;
+      std::cout << "  halt:              " << std::chrono::duration_cast<std::chrono::microseconds>(t1-t0).count() << " us" << std::endl;
+      std::cout << "  write and verify:  " << std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count() << " us" << std::endl;
+      std::cout << "  reset:             " << std::chrono::duration_cast<std::chrono::microseconds>(t3-t2).count() << " us" << std::endl;
+      return (0);
+    }
+
     /* Search for embedded CPU channel */
     map<std::string, std::string> e_cpus = receiver->getInterfaces()["EmbeddedCPUActionSink"];
     if (e_cpus.size() != 1)
@@ -41,6 +41,7 @@
 #include <string>
 #include <unistd.h>
 #include <poll.h>
+#include <algorithm>
 
 #include "saft-tools-define.hpp"
 
@@ -920,42 +921,52 @@ static int io_setup (int io_oe, int io_term, int io_spec_out, int io_spec_in, in
       if (io_partner != "") { std::cout << "  Partner: " << io_partner << std::endl; }
       std::cout << std::endl;
 
+      /* Get the state of all IOs at once */
+      std::vector< std::string > io_names;
+      std::map< std::string, std::vector< uint8_t > > io_states = receiver->ReadAllIoStates(io_names);
+      unsigned io_idx = std::find(io_names.begin(), io_names.end(), ioName) - io_names.begin();
+      if (io_idx == io_names.size())
+      {
+        std::cout << "Error: There is no IO with the name " << ioName << "!" << std::endl;
+        return (__IO_RETURN_FAILURE);
+      }
+
       /* Display configuration */
       std::cout << "Current state:" << std::endl;
       if (io_type != IO_CFG_FIELD_DIR_INPUT)
       {
         /* Display output */
-        if (output_proxy->ReadOutput())             { std::cout << "  Output:           High" << std::endl; }
+        if (io_states["Output"][io_idx])            { std::cout << "  Output:           High" << std::endl; }
         else                                        { std::cout << "  Output:           Low" << std::endl; }
 
         /* Display combined output */
-        if (output_proxy->ReadCombinedOutput())     { std::cout << "  CombinedOutput:   High" << std::endl; }
+        if (io_states["CombinedOutput"][io_idx])    { std::cout << "  CombinedOutput:   High" << std::endl; }
         else                                        { std::cout << "  CombinedOutput:   Low" << std::endl; }
 
         /* Display output enable state */
         if (output_proxy->getOutputEnableAvailable())
         {
-          if (output_proxy->getOutputEnable())      { std::cout << "  OutputEnable:     On" << std::endl; }
+          if (io_states["OutputEnable"][io_idx])    { std::cout << "  OutputEnable:     On" << std::endl; }
           else                                      { std::cout << "  OutputEnable:     Off" << std::endl; }
         }
 
         /* Display special out state */
         if (output_proxy->getSpecialPurposeOutAvailable())
         {
-          if (output_proxy->getSpecialPurposeOut()) { std::cout << "  SpecialOut:       On" << std::endl; }
+          if (io_states["SpecialPurposeOut"][io_idx]) { std::cout << "  SpecialOut:       On" << std::endl; }
           else                                      { std::cout << "  SpecialOut:       Off" << std::endl; }
         }
 
         /* Display gate out state */
-        if (output_proxy->getGateOut())             { std::cout << "  GateOut:          On" << std::endl; }
+        if (io_states["GateOut"][io_idx])           { std::cout << "  GateOut:          On" << std::endl; }
         else                                        { std::cout << "  GateOut:          Off" << std::endl; }
 
         /* Display BuTiS multiplexer state */
-        if (output_proxy->getBuTiSMultiplexer())    { std::cout << "  BuTiS t0 + TS:    On" << std::endl; }
+        if (io_states["BuTiSMultiplexer"][io_idx])  { std::cout << "  BuTiS t0 + TS:    On" << std::endl; }
         else                                        { std::cout << "  BuTiS t0 + TS:    Off" << std::endl; }
 
         /* Display WR PPS multiplexer state */
-        if (output_proxy->getPPSMultiplexer())      { std::cout << "  WR PPS:           On" << std::endl; }
+        if (io_states["PPSMultiplexer"][io_idx])    { std::cout << "  WR PPS:           On" << std::endl; }
         else                                        { std::cout << "  WR PPS:           Off" << std::endl; }
 
         /* Display IO index */
@@ -966,25 +977,25 @@ static int io_setup (int io_oe, int io_term, int io_spec_out, int io_spec_in, in
       if (io_type != IO_CFG_FIELD_DIR_OUTPUT)
       {
         /* Display input */
-        if (input_proxy->ReadInput())               { std::cout << "  Input:            High" << std::endl; }
+        if (io_states["Input"][io_idx])             { std::cout << "  Input:            High" << std::endl; }
         else                                        { std::cout << "  Input:            Low" << std::endl; }
 
         /* Display output enable state */
         if (input_proxy->getInputTerminationAvailable())
         {
-          if (input_proxy->getInputTermination())   { std::cout << "  InputTermination: On" << std::endl; }
+          if (io_states["InputTermination"][io_idx]) { std::cout << "  InputTermination: On" << std::endl; }
           else                                      { std::cout << "  InputTermination: Off" << std::endl; }
         }
 
         /* Display special in state */
         if (input_proxy->getSpecialPurposeInAvailable())
         {
-          if (input_proxy->getSpecialPurposeIn())   { std::cout << "  SpecialIn:        On" << std::endl; }
+          if (io_states["SpecialPurposeIn"][io_idx]) { std::cout << "  SpecialIn:        On" << std::endl; }
           else                                      { std::cout << "  SpecialIn:        Off" << std::endl; }
         }
 
         /* Display gate in state */
-        if (input_proxy->getGateIn())               { std::cout << "  GateIn:           On" << std::endl; }
+        if (io_states["GateIn"][io_idx])            { std::cout << "  GateIn:           On" << std::endl; }
         else                                        { std::cout << "  GateIn:           Off" << std::endl; }
 
         /* Display stable time */
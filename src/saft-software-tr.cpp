@@ -36,6 +36,7 @@
 #include <iomanip>
 #include <fstream>
 #include <deque>
+#include <mutex>
 
 #include <cstdint>
 
@@ -68,13 +69,45 @@ bool poll_msis = false; // If this is true, MSIS are provided in registers of  e
 /// to it (using the pseudo-terminal device).
 /// Saftlib clients can create software action sinks and inject events into the simulated hardware.
 /// The timing events are redistributed to the correct SoftwarActionSinks just as they would be 
-/// if saftlib would work on real hardware. The functionality is limited in that flags such as 
-/// LATE,CONFLICT,DELAYED,EARLY are not supported. Late events are always delivered immediately. 
+/// if saftlib would work on real hardware. LATE, EARLY, CONFLICT and DELAYED actions are flagged 
+/// and counted, and are only delivered if the condition accepts them. The action queue has a 
+/// capacity of 100 actions (--queue-capacity <n>), actions that find it full are counted as overflow.
+/// Actions are DELAYED if they are released more than 1 ms (--delayed-threshold <ns>) too late.
 /// The execution time comes from the system time and is not synchronized to a WhiteRabbit network.
 ///
 /// Besides parts of the ECA, not much of the hardware behavior is currently implemented. 
+///
+/// By default, the etherbone slave works on transaction level: it decodes complete etherbone 
+/// records, executes their read and write accesses directly on the emulated devices and sends 
+/// all responses in one packet. The original cycle-by-cycle emulation of the wishbone signals 
+/// is still available with the --signal-level option.
+///
+/// Actions are released by a worker thread that sleeps until the earliest pending deadline.
+/// The delay between deadline and release (scheduling jitter) is reported every 10 seconds 
+/// and at the end of the program. The interval can be changed with --jitter-report <seconds>.
+///
+/// Injected events are matched against the condition tables like in hardware: a binary search in 
+/// the search table finds the chain of matching conditions in the walker table. The tables are 
+/// copied on every table flip. --benchmark-matcher measures the number of events per second that 
+/// can be matched for different numbers of conditions.
+///
+/// One process can emulate several independent TimingReceivers (--devices <n>). Each of them has 
+/// its own pseudo-terminal and ECA state. The name of device 0 is written into 
+/// "/tmp/simbridge-eb-device", the name of device <k> into "/tmp/simbridge-eb-device-<k>".
+/// All pseudo-terminals are served by the main thread, one worker thread releases the actions of 
+/// all devices. With more than one device the program does not wait for a client before it starts.
+/// A write to the FpgaReset of any device ends the program.
+///
+/// For load tests without hardware, events can be generated inside the program:
+/// --generate <events/s> with --generate-ids <id,...>, --generate-random, --generate-seed <n>, 
+/// --generate-burst <n>, --generate-count <n>, or replayed from a file in saft-dm format with 
+/// --replay <file> and --replay-repeat <n>. The deadline of each event is --lead-time <ns> 
+/// (default 1 ms) after its generation.
 namespace software_tr {
 
+class DeviceMap;
+struct Receiver;
+
 // std_logic values
 typedef enum { 
 	STD_LOGIC_U,
@@ -95,16 +128,19 @@ public:
 	void init();
 	void shutdown();
 
-	EBslave(bool stop_until_connected, uint32_t sdb_adr, uint32_t msi_addr_first, uint32_t msi_addr_last); 
+	EBslave(bool stop_until_connected, uint32_t sdb_adr, uint32_t msi_addr_first, uint32_t msi_addr_last, 
+	        const std::string &device_file = "/tmp/simbridge-eb-device"); 
 	~EBslave() {
 		std::cerr << "closing fd" << std::endl;
 		close(pfds[0].fd);
 		std::cerr << "destructor done" << std::endl;
 	}
 	std::string pts_name();
+	int fd() const { return pfds[0].fd; }
+	bool msis_pending();
 
 
-	void fill_input_buffer();
+	void fill_input_buffer(int timeout_ms = 1);
 	// return true if a word is available
 	// return false if there is nothing
 	bool next_word(uint32_t &result);
@@ -127,11 +163,24 @@ public:
 
 	void push_msi(uint32_t adr, uint32_t dat);
 
+	// transaction-level alternative to master_out/master_in:
+	// handle all complete etherbone records in the input and send the responses in one packet
+	void handle_records(DeviceMap &devices, int timeout_ms = 1);
+
 private:
+	// value of a register in etherbone config space, err is set for unknown registers
+	uint32_t config_read(uint32_t adr, bool &err);
+	// append all pending MSIs as etherbone records to buffer
+	void append_msis(std::vector<uint8_t> &buffer);
+	// handle one etherbone record and append the response words
+	void handle_record(DeviceMap &devices, std::deque<uint32_t>::const_iterator record, std::vector<uint32_t> &response);
+
 	struct pollfd pfds[1];	
 	std::deque<uint32_t> input_word_buffer;
 	std::deque<uint32_t> input_word_buffer2; // only used to echo the input next to the output (not used for bridge logic)
 	std::deque<uint32_t> output_word_buffer;
+	uint8_t input_bytes[4]; // bytes of an incomplete input word
+	int     input_byte_count;
 	bool eb_flag_bca = false;
 	bool eb_flag_rca = false;
 	bool eb_flag_rff = false;
@@ -158,6 +207,7 @@ private:
 		uint32_t dat;
 	};
 	std::deque<MSI> msi_queue;
+	std::mutex      msi_mutex; // msi_queue is filled by the ECA thread
 	uint32_t msi_adr;
 	uint32_t msi_dat;
 	uint32_t msi_cnt;
@@ -200,6 +250,7 @@ private:
 
 	bool _stop_until_connected;
 	bool _shutdown;
+	std::string _device_file; // the pts name is written into this file
 };
 
 void EBslave::shutdown() {
@@ -212,6 +263,7 @@ void EBslave::init() {
 	input_word_buffer.clear();
 	input_word_buffer2.clear();
 	output_word_buffer.clear();
+	input_byte_count = 0;
 
 	if (_shutdown) return; // dont open the device if shutdown was initiated;
 
@@ -254,7 +306,7 @@ void EBslave::init() {
 	grantpt(pfds[0].fd);
 	unlockpt(pfds[0].fd);
 	state = EB_SLAVE_STATE_IDLE;
-	std::ofstream tmpfile("/tmp/simbridge-eb-device");
+	std::ofstream tmpfile(_device_file.c_str());
 	tmpfile << pts_name().substr(1) << std::endl;
 	if (verbosity >= 0) {
 		std::cout << "eb-device: " << pts_name() << std::endl;
@@ -277,9 +329,11 @@ void EBslave::init() {
 }
 
 
-EBslave::EBslave(bool stop_until_connected, uint32_t sdb_adr, uint32_t msi_addr_first, uint32_t msi_addr_last) 
+EBslave::EBslave(bool stop_until_connected, uint32_t sdb_adr, uint32_t msi_addr_first, uint32_t msi_addr_last, 
+                 const std::string &device_file) 
 {
 	_stop_until_connected = stop_until_connected;
+	_device_file = device_file;
 	_shutdown = false;
 	eb_sdb_adr       = sdb_adr;
 	eb_msi_adr_first = msi_addr_first;
@@ -292,11 +346,10 @@ std::string EBslave::pts_name() {
 }
 
 
-void EBslave::fill_input_buffer() {
+void EBslave::fill_input_buffer(int timeout_ms) {
 	uint8_t buffer[1024];
 	uint8_t *value;
 	pfds[0].events = POLLIN;
-	int timeout_ms = 1;
 	int result = poll(pfds,1,timeout_ms);
 	if (result != 1) {
 		return;
@@ -325,18 +378,23 @@ void EBslave::fill_input_buffer() {
 		pfds[0].fd = 0;
 		init();
 
-	} else if (result >= 4) {
+	} else if (result > 0) {
 		value = buffer;
 		while (result > 0) {
-			uint32_t value32  = value[0]; value32 <<=8;
-			         value32 |= value[1]; value32 <<=8;
-			         value32 |= value[2]; value32 <<=8;
-			         value32 |= value[3]; 
+			// a word may be split over two reads, keep incomplete words for the next read
+			input_bytes[input_byte_count++] = *value++;
+			--result;
+			if (input_byte_count < 4) {
+				continue;
+			}
+			input_byte_count = 0;
+			uint32_t value32  = input_bytes[0]; value32 <<=8;
+			         value32 |= input_bytes[1]; value32 <<=8;
+			         value32 |= input_bytes[2]; value32 <<=8;
+			         value32 |= input_bytes[3]; 
 			// std::cerr << "<= 0x" << std::hex << std::setw(8) << std::setfill('0') << (uint32_t)value32 << std::endl;
 			input_word_buffer.push_back(value32);
 			input_word_buffer2.push_back(value32);
-			result -= 4;
-			value  += 4; 
 			++word_count;
 		}
 	}
@@ -446,19 +504,6 @@ int EBslave::master_out(std_logic_t *cyc, std_logic_t *stb, std_logic_t *we, int
 			}
 		break;
 		case EB_SLAVE_STATE_EB_CONFIG_REST:
-			// eb slave config space registers
-			// x"00000000"                                      when "01000", -- 0x20 = 0[010 00]00
-			// x"00000000"                                      when "01001", -- 0x24 = 0[010 01]00
-			// x"00000000"                                      when "01010", -- 0x28
-			// x"00000001"                                      when "01011", -- 0x2c
-			// x"00000000"                                      when "01100", -- 0x30
-			// c_ebs_msi.sdb_component.addr_first(31 downto  0) when "01101", -- 0x34
-			// x"00000000"                                      when "01110", -- 0x38
-			// c_ebs_msi.sdb_component.addr_last(31 downto  0)  when "01111", -- 0x3c
-			// msi_adr                                          when "10000", -- 0x40 = 0[100 00]00
-			// msi_dat                                          when "10001", -- 0x44 = 0[100 01]00
-			// msi_cnt                                          when "10010", -- 0x48 = 0[100 10]00
-			// x"00000000"                                      when others;
 			if (eb_wcount > 0) {
 				uint32_t write_val;
 				if (next_word(write_val)) {
@@ -483,57 +528,11 @@ int EBslave::master_out(std_logic_t *cyc, std_logic_t *stb, std_logic_t *we, int
 				if (next_word(read_adr)) {
 
 					--eb_rcount;
-					switch(read_adr) {
-						case 0x0: 
-							wb_stbs.push_back(wb_stb(error_shift_reg,error_shift_reg,false,true)); // not a real strobe, just a pass-through
-							wb_stbs.back().end_cyc = eb_flag_cyc;
-							error_shift_reg = 0; // clear the error shift register 
-						break;
-						case 0xc: 
-						    // this should return the sdb address
-							wb_stbs.push_back(wb_stb(eb_sdb_adr,eb_sdb_adr,false,true)); // not a real strobe, just a pass-through
-							wb_stbs.back().end_cyc = eb_flag_cyc;
-						break;
-						case 0x2c: 
-							wb_stbs.push_back(wb_stb(0x1,0x1,false,true)); // not a real strobe, just a pass-through
-							wb_stbs.back().end_cyc = eb_flag_cyc;
-						break;
-						case 0x34:
-							wb_stbs.push_back(wb_stb(eb_msi_adr_first,eb_msi_adr_first,false,true)); // not a real strobe, just a pass-through
-							wb_stbs.back().end_cyc = eb_flag_cyc;
-						break;
-						case 0x3c:
-							wb_stbs.push_back(wb_stb(eb_msi_adr_last,eb_msi_adr_last,false,true)); // not a real strobe, just a pass-through
-							wb_stbs.back().end_cyc = eb_flag_cyc;
-						break;
-						case 0x40: // msi_adr
-							if (msi_queue.size() > 0 && poll_msis) {
-								msi_adr = msi_queue.front().adr;
-								msi_dat = msi_queue.front().dat;
-								msi_cnt = 1;
-								if (msi_queue.size() > 1) {
-									msi_cnt = 3;
-								}
-								msi_queue.pop_front();
-							} else {
-								msi_cnt = 0;
-							}
-							wb_stbs.push_back(wb_stb(msi_adr,msi_adr,false,true)); // not a real strobe, just a pass-through
-							wb_stbs.back().end_cyc = eb_flag_cyc;
-						break;
-						case 0x44: // msi_dat
-							wb_stbs.push_back(wb_stb(msi_dat,msi_dat,false,true)); // not a real strobe, just a pass-through
-							wb_stbs.back().end_cyc = eb_flag_cyc;
-						break;
-						case 0x48:
-							wb_stbs.push_back(wb_stb(msi_cnt,msi_cnt,false,true)); // not a real strobe, just a pass-through
-							wb_stbs.back().end_cyc = eb_flag_cyc;
-						break;
-						default: 
-							wb_stbs.push_back(wb_stb(0x0,0x0,false,true)); // not a real strobe, just a pass-through
-							wb_stbs.back().end_cyc = eb_flag_cyc;
-							wb_stbs.back().err = true;
-					}
+					bool err = false;
+					uint32_t value = config_read(read_adr, err);
+					wb_stbs.push_back(wb_stb(value,value,false,true)); // not a real strobe, just a pass-through
+					wb_stbs.back().end_cyc = eb_flag_cyc;
+					wb_stbs.back().err = err;
 					if (eb_rcount == 0) {
 						state = EB_SLAVE_STATE_EB_HEADER;
 					}
@@ -640,6 +639,60 @@ int EBslave::master_out(std_logic_t *cyc, std_logic_t *stb, std_logic_t *we, int
 	return end_cyc;
 }
 
+uint32_t EBslave::config_read(uint32_t adr, bool &err) {
+	// eb slave config space registers
+	// x"00000000"                                      when "01000", -- 0x20 = 0[010 00]00
+	// x"00000000"                                      when "01001", -- 0x24 = 0[010 01]00
+	// x"00000000"                                      when "01010", -- 0x28
+	// x"00000001"                                      when "01011", -- 0x2c
+	// x"00000000"                                      when "01100", -- 0x30
+	// c_ebs_msi.sdb_component.addr_first(31 downto  0) when "01101", -- 0x34
+	// x"00000000"                                      when "01110", -- 0x38
+	// c_ebs_msi.sdb_component.addr_last(31 downto  0)  when "01111", -- 0x3c
+	// msi_adr                                          when "10000", -- 0x40 = 0[100 00]00
+	// msi_dat                                          when "10001", -- 0x44 = 0[100 01]00
+	// msi_cnt                                          when "10010", -- 0x48 = 0[100 10]00
+	// x"00000000"                                      when others;
+	switch(adr) {
+		case 0x0: {
+			uint32_t value = error_shift_reg;
+			error_shift_reg = 0; // clear the error shift register 
+			return value;
+		}
+		case 0xc: 
+			// this should return the sdb address
+			return eb_sdb_adr;
+		case 0x2c: 
+			return 0x1;
+		case 0x34:
+			return eb_msi_adr_first;
+		case 0x3c:
+			return eb_msi_adr_last;
+		case 0x40: { // msi_adr
+			std::lock_guard<std::mutex> lock(msi_mutex);
+			if (msi_queue.size() > 0 && poll_msis) {
+				msi_adr = msi_queue.front().adr;
+				msi_dat = msi_queue.front().dat;
+				msi_cnt = 1;
+				if (msi_queue.size() > 1) {
+					msi_cnt = 3;
+				}
+				msi_queue.pop_front();
+			} else {
+				msi_cnt = 0;
+			}
+			return msi_adr;
+		}
+		case 0x44: // msi_dat
+			return msi_dat;
+		case 0x48:
+			return msi_cnt;
+		default: 
+			err = true;
+			return 0x0;
+	}
+}
+
 int EBslave::handle_pass_through() {
 	int end_cyc = 0;
 	// std::cerr << "handle_pass_through " << wb_stbs.size() << std::endl;
@@ -685,41 +738,48 @@ void EBslave::send_output_buffer()
 	}
 	if (word_count == 0 && poll_msis == false) {
 		// std::cerr << "all bytes sent" << std::endl;
-		for (unsigned i = 0; i < msi_queue.size(); ++i) {
-			std::vector<uint8_t> msi_buffer;
-			uint32_t adr = msi_queue[i].adr - eb_msi_adr_first;
-			uint32_t dat = msi_queue[i].dat;
-			if (verbosity >= 1) {
-				std::cerr << "send msi ";
-				std::cerr << "adr=0x" << std::hex << std::setw(8) << std::setfill('0') << adr << " ";
-				std::cerr << "dat=0x" << std::hex << std::setw(8) << std::setfill('0') << dat << " ";
-				std::cerr << std::dec << std::endl;
-			}
-			
-			msi_buffer.push_back(0xa8);
-			msi_buffer.push_back(0x0f);
-			msi_buffer.push_back(0x01);
-			msi_buffer.push_back(0x00);
-
-			msi_buffer.push_back(adr>>24);
-			msi_buffer.push_back(adr>>16);
-			msi_buffer.push_back(adr>>8);
-			msi_buffer.push_back(adr>>0);
-
-			msi_buffer.push_back(dat>>24);
-			msi_buffer.push_back(dat>>16);
-			msi_buffer.push_back(dat>>8);
-			msi_buffer.push_back(dat>>0);		
-
+		std::vector<uint8_t> msi_buffer;
+		append_msis(msi_buffer);
+		if (msi_buffer.size()) {
 			int result = write(pfds[0].fd, (void*)&msi_buffer[0], msi_buffer.size());
 			if (result != (int)msi_buffer.size()) {
 				std::cerr << "Error in SEBslave::send_output_buffer: write unexpected number of bytes" << std::endl;
 			}
 		}
-		msi_queue.clear();
 	}
 }
 
+void EBslave::append_msis(std::vector<uint8_t> &buffer) 
+{
+	std::lock_guard<std::mutex> lock(msi_mutex);
+	for (unsigned i = 0; i < msi_queue.size(); ++i) {
+		uint32_t adr = msi_queue[i].adr - eb_msi_adr_first;
+		uint32_t dat = msi_queue[i].dat;
+		if (verbosity >= 1) {
+			std::cerr << "send msi ";
+			std::cerr << "adr=0x" << std::hex << std::setw(8) << std::setfill('0') << adr << " ";
+			std::cerr << "dat=0x" << std::hex << std::setw(8) << std::setfill('0') << dat << " ";
+			std::cerr << std::dec << std::endl;
+		}
+		
+		buffer.push_back(0xa8);
+		buffer.push_back(0x0f);
+		buffer.push_back(0x01);
+		buffer.push_back(0x00);
+
+		buffer.push_back(adr>>24);
+		buffer.push_back(adr>>16);
+		buffer.push_back(adr>>8);
+		buffer.push_back(adr>>0);
+
+		buffer.push_back(dat>>24);
+		buffer.push_back(dat>>16);
+		buffer.push_back(dat>>8);
+		buffer.push_back(dat>>0);		
+	}
+	msi_queue.clear();
+}
+
 // should be called on falling_edge(clk)
 int EBslave::master_in(std_logic_t ack, std_logic_t err, std_logic_t rty, std_logic_t stall, int dat) {
 	int end_cyc = 0;
@@ -765,16 +825,22 @@ void EBslave::msi_slave_out(std_logic_t *ack, std_logic_t *err, std_logic_t *rty
 }
 
 void EBslave::push_msi(uint32_t adr, uint32_t dat) {
+	std::lock_guard<std::mutex> lock(msi_mutex);
 	msi_queue.push_back(MSI(adr,dat));
 }
 
+bool EBslave::msis_pending() {
+	std::lock_guard<std::mutex> lock(msi_mutex);
+	return !msi_queue.empty();
+}
+
 void EBslave::msi_slave_in(std_logic_t cyc, std_logic_t stb, std_logic_t we, int adr, int dat, int sel) {
 	msi_slave_out_ack = false;
 	msi_slave_out_err = false;
 	if (cyc == STD_LOGIC_1 && stb == STD_LOGIC_1) {
 		if (we == STD_LOGIC_1) {
 			msi_slave_out_ack = true;
-			msi_queue.push_back(MSI(adr,dat));
+			push_msi(adr,dat);
 			// ignore sel
 		} else {
 			msi_slave_out_err = true; // msi_slave is write-only!
@@ -797,13 +863,17 @@ void EBslave::msi_slave_in(std_logic_t cyc, std_logic_t stb, std_logic_t we, int
 #include <algorithm>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <queue>
+#include <random>
 
 namespace software_tr {
 
-EBslave *eb_slave = nullptr;
 uint32_t eca_msi_target_adr = 0;
 uint32_t eca_in_buffer[8] = {0,};
 uint32_t eca_tag = 0;
+int jitter_report_interval = 10; // seconds between two reports of the scheduling jitter, 0: report only at the end
 
 
 
@@ -811,11 +881,190 @@ uint32_t eca_tag = 0;
 class Device
 {
 public:
-	virtual bool contains(uint32_t adr) = 0;
+	// address ranges occupied by the device, first and last address are both part of the range
+	virtual std::vector<std::pair<uint32_t, uint32_t> > address_ranges() = 0;
 	virtual bool read_access(uint32_t adr, int sel, uint32_t *dat_out) { return false; }
 	virtual bool write_access(uint32_t adr, int sel, uint32_t dat) { return false; }
 };
 
+// Interval map from address ranges to Devices. 
+// A lookup is a binary search over the first addresses of all ranges. Consecutive accesses
+// usually hit the same range, so the last range that was found is checked first.
+// If address ranges of two devices overlap, the addresses belong to the device that was added first.
+class DeviceMap
+{
+public:
+	DeviceMap() : last_found(ranges.end()) {}
+	void add(std::shared_ptr<Device> device) {
+		devices.push_back(device);
+		for (auto &range: device->address_ranges()) {
+			insert(range.first, range.second, device.get());
+		}
+	}
+	// return nullptr if the address is not mapped
+	Device *find(uint32_t adr) {
+		if (last_found != ranges.end() && adr >= last_found->first && adr <= last_found->second.last) {
+			return last_found->second.device;
+		}
+		auto itr = ranges.upper_bound(adr); // first range that starts behind adr
+		if (itr == ranges.begin()) {
+			return nullptr;
+		}
+		--itr;
+		if (adr > itr->second.last) {
+			return nullptr;
+		}
+		last_found = itr;
+		return itr->second.device;
+	}
+	// read or write access to the device that contains adr, false if there is no such device or if the access failed
+	bool access(bool we, uint32_t adr, int sel, uint32_t *dat) {
+		Device *device = find(adr);
+		if (device == nullptr) {
+			if (verbosity >= 0) {
+				std::cout << "address not mapped: 0x" 
+				          << std::hex << std::setw(8) << std::setfill('0') << adr
+				          << std::endl;
+			}
+			return false;
+		}
+		if (we) {
+			return device->write_access(adr, sel, *dat);
+		}
+		return device->read_access(adr, sel, dat);
+	}
+private:
+	struct Range {
+		uint32_t last;
+		Device  *device;
+	};
+	void insert(uint32_t first, uint32_t last, Device *device) {
+		// insert only the parts of [first,last] that are not occupied by other devices
+		uint64_t adr = first;
+		while (adr <= last) {
+			auto next = ranges.upper_bound(adr);
+			if (next != ranges.begin()) {
+				auto prev = next;
+				--prev;
+				if (adr <= prev->second.last) { // adr is occupied, skip the occupied range
+					adr = (uint64_t)prev->second.last + 1;
+					continue;
+				}
+			}
+			uint64_t gap_last = last;
+			if (next != ranges.end() && next->first <= gap_last) {
+				gap_last = (uint64_t)next->first - 1;
+			}
+			ranges[adr] = Range{(uint32_t)gap_last, device};
+			adr = gap_last + 1;
+		}
+	}
+	std::vector<std::shared_ptr<Device> > devices;
+	std::map<uint32_t, Range> ranges; // first address of the range to Range
+	std::map<uint32_t, Range>::iterator last_found;
+};
+
+void EBslave::handle_records(DeviceMap &devices, int timeout_ms) {
+	fill_input_buffer(timeout_ms);
+	input_word_buffer2.clear(); // only used by the signal-level bridge
+	std::vector<uint32_t> response;
+	for (;;) {
+		if (state == EB_SLAVE_STATE_IDLE) {
+			// etherbone header: magic word and one more word that is echoed
+			if (input_word_buffer.size() < 2) break;
+			if (input_word_buffer[0] != 0x4e6f11ff) {
+				input_word_buffer.pop_front();
+				continue;
+			}
+			response.push_back(0x4e6f1644);
+			response.push_back(input_word_buffer[1]);
+			input_word_buffer.erase(input_word_buffer.begin(), input_word_buffer.begin()+2);
+			state = EB_SLAVE_STATE_EB_HEADER;
+			continue;
+		}
+		if (input_word_buffer.empty()) break;
+		uint32_t header = input_word_buffer.front();
+		unsigned wcount = (header & 0x0000ff00) >> 8;
+		unsigned rcount = (header & 0x000000ff) >> 0;
+		unsigned record_size = 1 + (wcount?wcount+1:0) + (rcount?rcount+1:0);
+		if (input_word_buffer.size() < record_size) break; // wait for the rest of the record
+		handle_record(devices, input_word_buffer.begin(), response);
+		input_word_buffer.erase(input_word_buffer.begin(), input_word_buffer.begin()+record_size);
+	}
+
+	std::vector<uint8_t> write_buffer;
+	write_buffer.reserve(4*response.size());
+	for (auto word: response) {
+		write_buffer.push_back(word>>24);
+		write_buffer.push_back(word>>16);
+		write_buffer.push_back(word>>8);
+		write_buffer.push_back(word>>0);
+	}
+	if (input_word_buffer.empty() && poll_msis == false) {
+		append_msis(write_buffer);
+	}
+	if (write_buffer.size()) {
+		int result = write(pfds[0].fd, (void*)&write_buffer[0], write_buffer.size());
+		if (result != (int)write_buffer.size()) {
+			std::cerr << "Error in EBslave::handle_records: write unexpected number of bytes" << std::endl;
+		}
+	}
+}
+
+void EBslave::handle_record(DeviceMap &devices, std::deque<uint32_t>::const_iterator record, std::vector<uint32_t> &response) {
+	uint32_t header = *record++;
+	bool flag_bca =  header & 0x80000000;
+	bool flag_rca =  header & 0x40000000;
+	bool flag_rff =  header & 0x20000000;
+	bool flag_cyc =  header & 0x08000000;
+	bool flag_wca =  header & 0x04000000;
+	bool flag_wff =  header & 0x02000000;
+	unsigned wcount = (header & 0x0000ff00) >> 8;
+	unsigned rcount = (header & 0x000000ff) >> 0;
+	uint32_t response_header  = (header & 0x00ff0000); // echo byte_enable
+	         response_header |= (header & 0x000000ff) << 8; // rcount becomes wcount
+	         response_header |= (flag_cyc << 27); // response rca <= request bca
+	         response_header |= (flag_bca << 26); // response rff <= request rff
+	         response_header |= (flag_rff << 25); // response wca <= request wca;
+
+	// Like in the signal-level bridge, failed wishbone accesses are not reported in the error 
+	// register, because not all registers that saftlib writes are emulated.
+	if (wcount > 0) {
+		// the response to the writes is zero, a new header is inserted in front of the read response
+		response.push_back(0x0);
+		uint32_t write_adr = *record++;
+		response.push_back(0x0);
+		for (unsigned i = 0; i < wcount; ++i) {
+			uint32_t dat = *record++;
+			if (!flag_wca) { // writes to the config space are ignored
+				devices.access(true, write_adr, 0xf, &dat);
+				error_shift_reg <<= 1;
+			}
+			// increment write_adr unless we are writing into a fifo
+			if (!flag_wff) write_adr += 4;
+			response.push_back((i == wcount-1)?(response_header & 0xffffff00):0x0);
+		}
+	} else {
+		response.push_back(response_header);
+	}
+	if (rcount > 0) {
+		uint32_t base_ret_adr = *record++;
+		response.push_back(base_ret_adr);
+		for (unsigned i = 0; i < rcount; ++i) {
+			uint32_t read_adr = *record++;
+			uint32_t dat = 0x0;
+			bool err = false;
+			if (flag_rca) {
+				dat = config_read(read_adr, err);
+			} else {
+				devices.access(false, read_adr, 0xf, &dat);
+			}
+			error_shift_reg = (error_shift_reg << 1) | err;
+			response.push_back(dat);
+		}
+	}
+}
+
 // This class reads an SDB record file and allows to place other Devices (i.e. Classes 
 // derived from class Device) into the address space based on their product and vendor ids.
 class SDBrecords : public Device {
@@ -854,13 +1103,8 @@ public:
 	uint32_t start_adr() {
 		return start;
 	}
-	bool contains(uint32_t adr) {
-		for (auto &block: blocks) {
-			if (adr >= block.first && adr <= block.second) {
-				return true;
-			}
-		}
-		return false;
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return blocks;
 	}
 	bool read_access(uint32_t adr, int sel, uint32_t *dat_out) {
 		auto itr = memory.find(adr);
@@ -871,7 +1115,7 @@ public:
 		return false;
 	}
 	template<class Dev>
-	std::vector<std::shared_ptr<Dev> > create_devices() {
+	std::vector<std::shared_ptr<Dev> > create_devices(Receiver &receiver) {
 		if (verbosity >= 0) {
 			std::cout << "looking for device_id " << std::hex << Dev::product_id << std::endl;
 		}
@@ -882,7 +1126,7 @@ public:
 					if (verbosity >= 0) {
 						std::cout << "found device 0x" << std::hex << Dev::product_id << std::endl;
 					}
-					result.push_back(std::make_shared<Dev>(block_device_adr_first(block_adr), result.size()));
+					result.push_back(std::make_shared<Dev>(receiver, block_device_adr_first(block_adr), result.size()));
 				}
 			}
 		}
@@ -910,12 +1154,12 @@ public:
 		vendor_id = 0x651,
 		product_id = 0xb6232cd3,
 	};
-	WatchdogMutex(uint32_t adr_first, int instance) 
+	WatchdogMutex(Receiver &receiver, uint32_t adr_first, int instance) 
 		: _adr_first(adr_first) 
 		, _instance(instance) 
 	{}
-	bool contains(uint32_t adr) {
-		return adr == _adr_first; // WatchdogMutex has only one register
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return {{_adr_first, _adr_first}}; // WatchdogMutex has only one register
 	}
 	bool read_access(uint32_t adr, int sel, uint32_t *dat_out) {
 		if (verbosity >= 1) {
@@ -943,7 +1187,7 @@ public:
 		vendor_id = 0x651,
 		product_id = 0x3a362063,
 	};
-	FpgaReset(uint32_t adr_first, int instance) 
+	FpgaReset(Receiver &receiver, uint32_t adr_first, int instance) 
 		: _adr_first(adr_first) 
 		, _instance(instance) 
 	{
@@ -951,12 +1195,8 @@ public:
 			std::cout << "FpgaReset " << std::hex << _adr_first << std::endl;
 		}
 	}
-	bool contains(uint32_t adr) {
-		if ( (adr >= _adr_first) && (adr < _adr_first + 0x100) ) {
-			return true;
-		} else {
-			return false;
-		}
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return {{_adr_first, _adr_first + 0xff}};
 	}
 	bool write_access(uint32_t adr, int sel, uint32_t dat) {
 		if (dat == 0xdeadbeef) {
@@ -1004,38 +1244,108 @@ namespace software_tr {
 
 // This class does in software (roughly) what the real ECA does in hardware.
 // Limitations: 
-//   * only software action sinks and software conditions are supported.
-//   * no LATE/EARLY/CONFLICT/DELAYED flags are set
+//   * only software action sinks and software conditions are supported 
+//     (actions of all conditions are delivered to the software action sinks).
+//   * there is only one channel (the Linux facing queue) and the order of actions with 
+//     different subchannels (num) is the order of their release.
+// Failure modes are emulated like this:
+//   * LATE:     the deadline had passed when the event was injected
+//   * EARLY:    the deadline was more than early_threshold in the future when the event was injected
+//   * CONFLICT: the deadline is equal to the deadline of the previous action on the same subchannel
+//   * DELAYED:  the action was released more than delayed_threshold after it was due
+// Late and early actions are due immediately, all other actions are due at their deadline.
+// Each failure increments the failed count of its code (MSI when the count becomes non-zero). 
+// The action is only delivered (with the failure flag set) if the condition accepts the failure.
+// A delivered action that finds the queue full (queue_capacity) is dropped and counted as overflow.
 struct SoftwareECA {
-	struct SearchCandidate {
-		SearchCandidate(int first, uint64_t search) : first_walker(first), search_event(search) {
-			if (first_walker == 0xffff) {
-				first_walker = -1;
-			}
-		}
-		int      first_walker;
-		uint64_t search_event;
-	};
-
-	std::vector<SearchCandidate> search_candidates;
-
-
-	struct Search {
+	struct Event {
 		uint64_t id;
-		uint64_t mask;
-		int first;
-		Search(uint64_t _id, uint64_t _mask, int _first) : id(_id), mask(_mask), first(_first) {}
-		bool operator==(const Search &rhs) {
-			return /*id == rhs.id && mask == rhs.mask &&*/ first == rhs.first;
-		}
-		Search& operator=(const Search &rhs) {
-			id = rhs.id; mask = rhs.mask; first = rhs.first;
-			return *this;
+		uint64_t param;
+		uint64_t deadline;
+		uint32_t num;
+		int32_t tag;
+		uint32_t msi_adr;
+		uint32_t msi_dat;
+		Event(uint64_t _id, uint64_t _param, uint64_t _deadline, uint32_t _num, int32_t _tag, uint32_t _msi_adr, uint32_t _msi_dat) : id(_id), param(_param), deadline(_deadline), num(_num), tag(_tag), msi_adr(_msi_adr), msi_dat(_msi_dat), sequence(0), due(_deadline), flags(0), accept(0), executed(0), eca(nullptr) {}
+		bool operator==(const Event &rhs) const {
+			return id == rhs.id && param == rhs.param && deadline == rhs.deadline /*&& num == rhs.num*/ && tag == rhs.tag && msi_adr == rhs.msi_adr && msi_dat == rhs.msi_dat;
 		}
+		uint64_t sequence; // events with equal due time become actions in the order of their creation
+		uint64_t due;      // time of release
+		uint32_t flags;    // (1<<ECA_LATE) | (1<<ECA_EARLY) | ... 
+		uint32_t accept;   // failure flags that are accepted by the condition
+		uint64_t executed; // time when the action was actually released
+		SoftwareECA *eca;  // the ECA that releases the action
+	};
+	// Counters of one subchannel. They are read and cleared through the ECA channel registers.
+	struct Subchannel {
+		uint32_t valid_count;
+		uint32_t overflow_count;
+		uint32_t failed_count[4];  // indexed by ECA_LATE, ECA_EARLY, ECA_CONFLICT, ECA_DELAYED
+		std::vector<Event> failed; // the first action for each failure code
+		bool     has_last_deadline;
+		uint64_t last_deadline;
+		Subchannel() : valid_count(0), overflow_count(0), failed_count{0,0,0,0}, 
+		               failed(4, Event(0,0,0,0,0,0,0)), has_last_deadline(false), last_deadline(0) {}
+	};
+	// One entry of the search table. The table is sorted by event. All event ids from the event of 
+	// one entry up to (excluding) the event of the next entry match the conditions in the walker 
+	// chain that starts at first_walker (0xffff: no condition matches).
+	struct SearchEntry {
+		uint64_t event;
+		uint16_t first_walker;
+	};
+	// One entry of the walker table, i.e. one condition. next is the index of the next condition 
+	// in the chain (0xffff: end of chain).
+	struct Walker {
+		int64_t  offset;
+		int32_t  tag;
+		uint16_t next;
+		int      flags;
+		int      channel;
+		int      num;
 	};
 
-
-
+	enum {
+		search_capacity = 0x200,
+		walker_capacity = 0x100,
+		offset_bits     = 32,
+	};
+	// Like in hardware, saftlib writes search and walker entries into inactive tables
+	// and activates them with a table flip (ECA_FLIP_ACTIVE_OWR).
+	std::vector<SearchEntry> search_table;
+	std::vector<Walker>      walker_table;
+	// Tables that are used to match injected events. They are replaced on every table flip.
+	// The event generator matches events in its own thread, so access is guarded by tables_mutex.
+	std::mutex               tables_mutex;
+	std::vector<SearchEntry> active_search_table;
+	std::vector<Walker>      active_walker_table;
+
+	bool write_search_entry(unsigned index, const SearchEntry &entry) {
+		if (index >= search_capacity) return false;
+		if (index >= search_table.size()) search_table.resize(index+1);
+		search_table[index] = entry;
+		return true;
+	}
+	bool write_walker_entry(unsigned index, const Walker &entry) {
+		if (index >= walker_capacity) return false;
+		if (index >= walker_table.size()) walker_table.resize(index+1);
+		walker_table[index] = entry;
+		return true;
+	}
+	void flip_tables() {
+		std::lock_guard<std::mutex> lock(tables_mutex);
+		active_search_table = search_table;
+		active_walker_table = walker_table;
+		// saftlib fills the unused part of the search table with copies of the last entry, 
+		// the table is sorted anyway, but make sure that a binary search is possible.
+		std::stable_sort(active_search_table.begin(), active_search_table.end(), 
+			[](const SearchEntry &lhs, const SearchEntry &rhs) { return lhs.event < rhs.event; });
+		if (verbosity >= 1) {
+			std::cout << "table flip: " << std::dec << active_search_table.size() << " search entries, " 
+			          << active_walker_table.size() << " walker entries" << std::endl;
+		}
+	}
 
 	static uint64_t get_time_ns() {
 		struct timespec now;
@@ -1045,6 +1355,32 @@ struct SoftwareECA {
 		return ns;
 	}
 
+	// Find the conditions that match the event id and append one Event per condition.
+	// The last search entry with event <= id is found by binary search, 
+	// then the walker chain of this entry is followed.
+	void match(uint64_t id, uint64_t param, uint64_t deadline, std::vector<Event> &result) {
+		auto entry = std::upper_bound(active_search_table.begin(), active_search_table.end(), id, 
+			[](uint64_t id, const SearchEntry &entry) { return id < entry.event; });
+		if (entry == active_search_table.begin()) {
+			return;
+		}
+		--entry;
+		unsigned steps = 0;
+		for (uint16_t walker_idx = entry->first_walker; 
+			 walker_idx != 0xffff && walker_idx < active_walker_table.size() && steps < active_walker_table.size(); 
+			 walker_idx = active_walker_table[walker_idx].next, ++steps) {
+			const Walker &walker = active_walker_table[walker_idx];
+			if (verbosity >= 1) {
+				std::cout << "Condition matches walker " << std::dec << walker_idx << " with tag=" << std::dec << walker.tag << std::endl;
+			}
+			uint64_t offset_deadline = deadline+walker.offset;
+			uint32_t msi_data = ECA_VALID<<16; 
+			result.push_back(Event(id,param,offset_deadline,walker.num,walker.tag, msi_target_adr, msi_data|walker.num));
+			result.back().accept = walker.flags;
+		}
+	}
+
+	// inject the event that was written into in_buffer by EcaEventsIn
 	void inject() {
 		if (verbosity >= 1) {
 			std::cout << ">>>>>>>>>>>>>>  EVENT INJECTED <<<<<<<<<<<<<<<" << std::endl;
@@ -1058,246 +1394,428 @@ struct SoftwareECA {
 		uint64_t deadline = in_buffer[6];
 		deadline <<= 32;
 		deadline |= in_buffer[7];
-		if (verbosity >= 1) {
-			std::cout << "search.size() = " << searches.size() << std::endl;
-			std::cout << "walkers:" << std::endl;
-		}
-		for (auto &walk: walker) {
-			walk.second.fired = false;
-			if (verbosity >= 1) {
-				std::cout << "  " << std::dec << walk.first << " tag = " << walk.second.tag << "  next = " << walk.second.next << std::endl;
+		inject(id, param, deadline);
+	}
+
+	// Match the event and schedule one action per matching condition. 
+	// Returns the number of scheduled actions.
+	unsigned inject(uint64_t id, uint64_t param, uint64_t deadline) {
+		std::vector<Event> new_events;
+		{
+			std::lock_guard<std::mutex> lock(tables_mutex);
+			match(id, param, deadline, new_events);
+		}
+		if (new_events.empty()) {
+			return 0;
+		}
+		uint64_t now = get_time_ns();
+		std::lock_guard<std::mutex> lock(events_mutex);
+		for (auto &new_event: new_events) {
+			new_event.eca = this;
+			if (new_event.deadline < now) {
+				new_event.flags |= 1<<ECA_LATE;
+				new_event.due    = now;
+			} else if (new_event.deadline - now > early_threshold) {
+				new_event.flags |= 1<<ECA_EARLY;
+				new_event.due    = now;
 			}
-		}
-		for (auto &search: searches) {
+			new_event.sequence = event_sequence++;
+			events.push(new_event);
 			if (verbosity >= 1) {
-				std::cout << "id = " << std::hex << id << " search.id = " << std::hex << search.id << " search.mask = " << std::hex << search.mask << std::endl;
-			}
-			if ((id&search.mask) == (search.id&search.mask)) {
-				int walker_idx = search.first;
-				do {
-					if (verbosity >= 1) {
-						std::cout << "Condition matches walker " << std::dec << walker_idx << " with tag=" << std::dec << walker[walker_idx].tag << std::endl;
-					}
-					uint64_t offset_deadline = deadline+walker[walker_idx].offset;
-					uint32_t msi_data = ECA_VALID<<16; 
-					////// late flag doesn't work yet. TODO: make it work!
-					// uint64_t now = get_time_ns();
-					// if (offset_deadline < now) {
-					// 	msi_data = ECA_LATE<<16; 
-					// }
-
-					if (walker[walker_idx].fired == false) {
-						Event new_event(id,param,offset_deadline,walker[walker_idx].num,walker[walker_idx].tag, msi_target_adr, msi_data|walker[walker_idx].num);
-						std::lock_guard<std::mutex> lock(events_mutex);
-						events.push_back(new_event);
-						std::sort(events.begin(), events.end());
-						if (verbosity >= 1) {
-							std::cout << "create event with id=" << std::hex << id << " param=" << param << " deadline=" << deadline << std::dec << " num=" << walker_idx << " tag=" << walker[walker_idx].tag << std::endl;
-							std::cout << "event.size() = " << events.size() << std::endl;
-						}
-					}
-					walker[walker_idx].fired = true;
-					walker_idx = walker[walker_idx].next;
-				} while((0xffff&walker_idx) != 0xffff);
+				std::cout << "create event with id=" << std::hex << id << " param=" << param << " deadline=" << new_event.deadline << std::dec << " num=" << new_event.num << " tag=" << new_event.tag << std::endl;
+				std::cout << "event.size() = " << events.size() << std::endl;
 			}
 		}
+		events_cv.notify_one(); // the new events may be due first
+		return new_events.size();
 	}
-	std::vector<Search> searches;
 
-
-	bool is_prefix_mask(uint64_t mask) {
-		if (mask == 0) return true;
-		for (uint64_t m = UINT64_C(0xffffffffffffffff); m != 0; m <<= 1) {
-			if (mask == m) return true;
+	uint32_t in_buffer[8];
+	uint32_t msi_target_adr;
+	// order for the priority queue: the event that is due first is on top
+	struct LaterDeadline {
+		bool operator()(const Event &lhs, const Event &rhs) const {
+			if (lhs.due != rhs.due) return lhs.due > rhs.due;
+			return lhs.sequence > rhs.sequence;
 		}
-		return false;
-	}
-	uint64_t fix_mask(uint64_t mask) {
-		for (uint64_t test = UINT64_C(0x8000000000000000); test != 0; test >>= 1) {
-			if ((mask&test) == 0) return ~((test<<1)-1);
+	};
+	// Events of all SoftwareECAs wait in one queue until they are due, 
+	// so that one worker thread can release the actions of all emulated devices.
+	static std::mutex events_mutex;
+	static std::condition_variable events_cv; // notified whenever an event is added
+	static std::priority_queue<Event, std::vector<Event>, LaterDeadline> events;
+	static uint64_t event_sequence;
+	std::mutex actions_mutex;
+	std::deque<Event> actions; // 2nd thread converts events into actions
+	EBslave *eb_slave = nullptr; // receives the MSIs
+
+	// State of the Linux facing channel, guarded by actions_mutex
+	uint64_t early_threshold   = UINT64_C(1) << offset_bits; // same as ActionSink::getEarlyThreshold
+	uint64_t delayed_threshold = 1000000; // ns
+	unsigned queue_capacity    = 100;
+	unsigned most_full         = 0;
+	bool     most_full_armed   = true;    // MSI is sent if most_full changes
+	std::vector<Subchannel> subchannels;
+
+	Subchannel &subchannel(unsigned num) {
+		if (num >= subchannels.size()) subchannels.resize(num+1);
+		return subchannels[num];
+	}
+
+	// Set failure flags that are known at the time of release, update the counters, 
+	// and move the event into the action queue if it is delivered. 
+	// Called with actions_mutex locked.
+	void release(Event event, uint64_t now) {
+		Subchannel &sub = subchannel(event.num);
+		event.executed = now;
+		if (now - event.due > delayed_threshold) {
+			event.flags |= 1<<ECA_DELAYED;
+		}
+		if (sub.has_last_deadline && sub.last_deadline == event.deadline) {
+			event.flags |= 1<<ECA_CONFLICT;
+		}
+		sub.has_last_deadline = true;
+		sub.last_deadline     = event.deadline;
+		for (unsigned code = ECA_LATE; code <= ECA_DELAYED; ++code) {
+			if (event.flags & (1<<code)) {
+				if (sub.failed_count[code]++ == 0) {
+					sub.failed[code] = event;
+					eb_slave->push_msi(event.msi_adr, (code<<16) | event.num);
+				}
+			}
 		}
-		return mask;
-	}
-	void push_search(const Search& s) {
-		if (std::find(searches.begin(), searches.end(), s) == searches.end()) {
-			searches.push_back(s);
-			if (verbosity >= 1) {
-				std::cout << " pushed -> search: " << std::hex << searches.back().id << " " << searches.back().mask << " " << std::dec << searches.back().first;
+		if (event.flags & ~event.accept) {
+			return; // the condition does not accept this failure
+		}
+		if (actions.size() >= queue_capacity) {
+			if (sub.overflow_count++ == 0) {
+				eb_slave->push_msi(event.msi_adr, (ECA_OVERFLOW<<16) | event.num);
 			}
-		} else {
-			if (verbosity >= 1) {
-				std::cout << " NOT pushed -> search: " << std::hex << s.id << " " << s.mask << " " << std::dec << s.first;
+			return;
+		}
+		actions.push_back(event);
+		++sub.valid_count;
+		// create the MSI to signal host that an action is pending
+		eb_slave->push_msi(event.msi_adr, event.msi_dat);
+		if (actions.size() > most_full) {
+			most_full = actions.size();
+			if (most_full_armed) {
+				most_full_armed = false;
+				eb_slave->push_msi(event.msi_adr, ECA_MAX_FULL<<16);
 			}
 		}
-
 	}
 
-	// this transformation is completely based on heuristics and observation, reverse-engineering and guesswork.
-	// it may not be 100% correct but works for a lot of testc cases. TODO: make more test cases
-	// (this one is an implementation in case all sowftware conditions have nonzero masks)
-	void analyse_search_candidates_normal() {
-		uint64_t s_open = 0;
-		for (unsigned i = 0; i < search_candidates.size(); ++i) {
-			int prev_i = (i>0)?(i-1):(0);
-			int      w0 = search_candidates[prev_i].first_walker;
-			int      w1 = search_candidates[i].first_walker;
-			uint64_t s0 = search_candidates[prev_i].search_event;
-			uint64_t s1 = search_candidates[i].search_event;
-			if (w1 != -1 && w0 == -1) {
-				s_open = s1;
+	// Difference between the time when an action was created and the time when it was due.
+	// Values are collected in a histogram with 1 us bins.
+	struct Jitter {
+		enum { bins = 10000 }; // the last bin holds everything >= 10 ms
+		std::vector<uint64_t> histogram;
+		uint64_t count, sum_ns, max_ns;
+		Jitter() : histogram(bins, 0), count(0), sum_ns(0), max_ns(0) {}
+		void add(uint64_t late_ns) {
+			uint64_t bin = late_ns/1000;
+			++histogram[bin<bins?bin:bins-1];
+			++count;
+			sum_ns += late_ns;
+			if (late_ns > max_ns) max_ns = late_ns;
+		}
+		// upper limit of the bin that contains the given fraction of all values
+		uint64_t percentile_us(double fraction) const {
+			uint64_t limit = fraction*count, sum = 0;
+			for (unsigned bin = 0; bin < bins; ++bin) {
+				sum += histogram[bin];
+				if (sum > limit) return bin+1;
 			}
-			uint64_t mask1 = ~(s1-s0-1);
-			uint64_t id0 = s0&mask1;
-			uint64_t id1 = s1&mask1;
-
-			uint64_t mask2 = ~(s1-s_open-1);
-			uint64_t id_open  = s_open&mask2;
+			return bins;
+		}
+		void report(const std::string &what) const {
+			if (count == 0) return;
+			std::cout << what << ": " << std::dec << count << " actions"
+			          << ", mean " << sum_ns/count/1000 << " us" 
+			          << ", p50 < " << percentile_us(0.5) << " us"
+			          << ", p99 < " << percentile_us(0.99) << " us"
+			          << ", p99.9 < " << percentile_us(0.999) << " us"
+			          << ", max " << max_ns/1000 << " us" << std::endl;
+		}
+	};
 
-			if (verbosity >= 1) {
-				std::cout << std::dec << w1 << " " << std::hex << s1
-				          << " => mask1=" << std::hex <<std::setw(16)<<std::setfill('0') << mask1 
-				          << " => mask2=" << std::hex <<std::setw(16)<<std::setfill('0') << mask2 
-				          << " is_prefix_mask(" << is_prefix_mask(mask1) << ") w1=" << w1 << " id1=" << id1
-				          << " id_open=" << id_open;
+	// Worker thread that converts events into actions when they are due.
+	// It sleeps until the earliest due time or until a new event is added.
+	static void eca_events_to_actions() {
+		using namespace std::chrono;
+		Jitter total, interval;
+		uint64_t next_report = SoftwareECA::get_time_ns() + jitter_report_interval*UINT64_C(1000000000);
+		std::unique_lock<std::mutex> lock_events(events_mutex);
+		while (!FpgaReset::_reset_was_triggered) {
+			uint64_t now = SoftwareECA::get_time_ns();
+			if (jitter_report_interval > 0 && now >= next_report) {
+				if (verbosity >= 0) {
+					interval.report("scheduling jitter");
+				}
+				interval = Jitter();
+				next_report = now + jitter_report_interval*UINT64_C(1000000000);
 			}
-
-			if (is_prefix_mask(mask1) && i) {
-				if (w0 == -1) w0 = 0;
-				     if (id0) push_search(Search(id0,mask1,w0));
-				else if (id1) push_search(Search(id1,mask1,w0));	
-			} else if (is_prefix_mask(mask2) && i) {
-				if (w0 == -1) w0 = 0;
-		    	if (id_open) push_search(Search(id_open,mask2,w0));
+			if (events.empty() || events.top().due > now) {
+				// wake up at least every 100 ms to see if a reset was triggered
+				uint64_t wake_up = now + UINT64_C(100000000);
+				if (!events.empty() && events.top().due < wake_up) {
+					wake_up = events.top().due;
+				}
+				events_cv.wait_until(lock_events, system_clock::time_point(duration_cast<system_clock::duration>(nanoseconds(wake_up))));
+				continue;
 			}
+			const Event &event = events.top();
+			total.add(now - event.due);
+			interval.add(now - event.due);
 			if (verbosity >= 1) {
-				std::cout << std::endl;
+				std::cout << "creating action: now=" << std::dec << now << " deadline=" << event.deadline << std::endl;
 			}
+			SoftwareECA *eca = event.eca;
+			std::lock_guard<std::mutex> lock_actions(eca->actions_mutex);
+			// take an event from the event queue and insert it into 
+			//   action queue where it can be read from the ECA_QUEUE Device
+			eca->release(event, now);
+			events.pop();
+		}
+		if (verbosity >= 0) {
+			total.report("scheduling jitter (total)");
 		}
 	}
 
-	// this transformation is completely based on heuristics and observation, reverse-engineering and guesswork.
-	// it may not be 100% correct but works for a lot of testc cases. TODO: make more test cases
-	// (this one is a special implementation in case a software condition is looking for id=0 with mask=0)
-	void analyse_search_candidates_zero() {
-		uint64_t s_open = 0;
-		for (unsigned i = 0; i < search_candidates.size(); ++i) {
-			int prev_i = (i>0)?(i-1):(0);
-			int      w0 = search_candidates[prev_i].first_walker;
-			int      w1 = search_candidates[i].first_walker;
-			uint64_t s0 = search_candidates[prev_i].search_event;
-			uint64_t s1 = search_candidates[i].search_event;
-			if (w1 != 0 && w0 == 0) {
-				s_open = s1;
-			}
-			uint64_t mask1 = ~(s1-s0-1);
-			// uint64_t id0 = s0&mask1;
-			uint64_t id1 = s1&mask1;
+};
+std::mutex                  SoftwareECA::events_mutex;
+std::condition_variable     SoftwareECA::events_cv;
+std::priority_queue<SoftwareECA::Event, std::vector<SoftwareECA::Event>, SoftwareECA::LaterDeadline> SoftwareECA::events;
+uint64_t                    SoftwareECA::event_sequence = 0;
+
+// Measure how many events per second SoftwareECA::match handles for different numbers of conditions.
+// Condition i matches all event ids with (i+1) in bits 16..63. The tables are built as ECA::compile
+// would build them and half of the events match one of the conditions.
+static void benchmark_matcher() {
+	const unsigned events = 1000000;
+	std::mt19937_64 random(1);
+	std::vector<uint64_t> ids(events);
+	std::vector<SoftwareECA::Event> result;
+	SoftwareECA eca;
+	eca.msi_target_adr = 0;
+	std::cout << "conditions  search-entries  events/s" << std::endl;
+	for (unsigned conditions: {1, 2, 5, 10, 20, 50, 100, 200, 255}) {
+		eca.search_table.clear();
+		eca.walker_table.clear();
+		eca.write_search_entry(0, SoftwareECA::SearchEntry{0, 0xffff});
+		for (unsigned i = 0; i < conditions; ++i) {
+			eca.write_search_entry(2*i+1, SoftwareECA::SearchEntry{(uint64_t)(i+1) << 16, (uint16_t)i});
+			eca.write_search_entry(2*i+2, SoftwareECA::SearchEntry{(uint64_t)(i+2) << 16, 0xffff});
+			eca.write_walker_entry(i, SoftwareECA::Walker{0, (int32_t)i, 0xffff, 0, 0, 0});
+		}
+		eca.flip_tables();
+		for (auto &id: ids) {
+			uint64_t prefix = (random()&1) ? (random()%conditions + 1) : (random()%conditions + conditions + 1);
+			id = (prefix << 16) | (random()&0xffff);
+		}
+		unsigned matches = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (auto id: ids) {
+			result.clear();
+			eca.match(id, 0, 0, result);
+			matches += result.size();
+		}
+		std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+		std::cout << std::dec << std::setw(10) << std::setfill(' ') << conditions 
+		          << std::setw(16) << eca.active_search_table.size() 
+		          << std::setw(10) << (uint64_t)(events/duration.count()) << std::endl;
+		if (matches == 0) {
+			std::cerr << "no event matched" << std::endl;
+		}
+	}
+}
 
-			uint64_t mask2 = ~(s1-s_open-1);
-			uint64_t id_open  = s_open&mask2;
 
-			if (verbosity >= 1) {
-				std::cout << std::dec << w1 << " " << std::hex << s1
-				          << " => mask1=" << std::hex <<std::setw(16)<<std::setfill('0') << mask1 
-				          << " => mask2=" << std::hex <<std::setw(16)<<std::setfill('0') << mask2 
-				          << " is_prefix_mask(" << is_prefix_mask(mask1) << ") w1=" << w1 << " id1=" << id1
-				          << " id_open=" << id_open;
-			}
+// One emulated TimingReceiver with its own etherbone slave (pseudo-terminal), ECA state and devices.
+// The devices of a Receiver get a reference to it when they are created.
+struct Receiver {
+	SoftwareECA              eca;
+	std::unique_ptr<EBslave> eb_slave;
+	DeviceMap                devices;
+};
 
-			if (i == 0) {
-				push_search(Search(0,0,w1));
-			} else {
-				if (w0 != 0) {
-					if (w1 > w0) {
-						if (is_prefix_mask(mask1) && id1) {
-							push_search(Search(id1,mask1,w1));
-						} 
-					} else {
-						if (is_prefix_mask(mask2) && id_open) {
-							push_search(Search(id_open,mask2,w0));
-						}
-					}
-				}
-			}
-			if (verbosity >= 1) {
-				std::cout << std::endl;
+// Generates timing events inside the program, as if they were received from the timing network.
+// The events are matched and released exactly like events that are injected by saftlib, so the 
+// host sees the same MSIs and queue entries as with hardware. This allows to measure the rate at 
+// which SoftwareActionSinks can deliver actions, and what happens if they cannot keep up.
+// Events are generated either
+//   * at a fixed rate: bursts of burst_size events every burst_size/rate seconds. The ids are 
+//     taken from the ids list in turn, or randomly (reproducible with a fixed seed), or
+//   * by replaying a file in the format of saft-dm: one event per line as 
+//     '<eventID> <param> <time>' with time in ns (decimal) relative to the start of the file.
+// With several emulated devices, every event is injected into all of them, like a timing 
+// message that is broadcast by the timing network.
+// Every event gets the deadline "time of generation + lead_time". Generated events carry their 
+// sequence number (starting at 0) as parameter, so a client can detect lost actions. 
+// Generation starts after saftlib 
+// has activated the first non-empty condition table on one of the devices, so that events are not lost while 
+// the clients are setting up their conditions.
+struct EventGenerator {
+	double                rate          = 0;       // events per second, 0: no generated events
+	unsigned              burst_size    = 1;
+	std::vector<uint64_t> ids           = {0};
+	bool                  random_ids    = false;
+	uint64_t              seed          = 1;
+	uint64_t              max_events    = 0;       // 0: no limit
+	uint64_t              lead_time     = 1000000; // ns
+	std::string           replay_file;
+	unsigned              replay_repeat = 1;
+	std::vector<SoftwareECA*> ecas;           // the events are injected into all of them
+
+	struct ReplayEvent {
+		uint64_t id;
+		uint64_t param;
+		uint64_t time;
+	};
+
+	bool enabled() const {
+		return rate > 0 || !replay_file.empty();
+	}
+
+	// parse a comma separated list of event ids
+	bool set_ids(const std::string &list) {
+		ids.clear();
+		std::istringstream in(list);
+		std::string item;
+		while (std::getline(in, item, ',')) {
+			try {
+				ids.push_back(std::stoull(item, nullptr, 0));
+			} catch (std::exception &) {
+				return false;
 			}
 		}
+		return !ids.empty();
 	}
 
-
-	void analyse_search_candidates() {
-		if (search_candidates.size() /*&& search_candidates[0].first_walker == 0*/ && search_candidates[0].search_event == 0) {
-			analyse_search_candidates_zero();
-		} else {
-			analyse_search_candidates_normal();
+	void read_replay_file(std::vector<ReplayEvent> &schedule) {
+		std::ifstream in(replay_file.c_str());
+		if (!in) {
+			throw std::runtime_error(std::string("cannot open event file ") + replay_file);
 		}
-		if (verbosity >= 1) {
-			std::cerr << ">>>>> searches >>>> " << std::endl;
-			for (unsigned i = 0; i < searches.size(); ++i) {
-				std::cout << "   -> search: " << std::hex << searches[i].id << " " << searches[i].mask << " " << std::dec << searches[i].first << std::endl;
+		std::string line;
+		while (std::getline(in, line)) {
+			if (line.find_first_not_of(" \t\r") == std::string::npos || line[line.find_first_not_of(" \t")] == '#') {
+				continue;
 			}
+			std::istringstream stream(line);
+			ReplayEvent event;
+			if (!(stream >> std::hex >> event.id >> event.param >> std::dec >> event.time)) {
+				throw std::runtime_error(std::string("cannot parse line \"") + line + "\" in " + replay_file);
+			}
+			schedule.push_back(event);
 		}
 	}
 
-	struct Walker {
-		int64_t offset;
-		int32_t  tag;
-		int      next;
-		int      flags;
-		int      channel;
-		int      num;
-		bool     fired;
-	};
-	std::map<int, Walker > walker;
-	uint32_t in_buffer[8];
-	uint32_t msi_target_adr;
-	struct Event {
-		uint64_t id;
-		uint64_t param;
-		uint64_t deadline;
-		uint32_t num;
-		int32_t tag;
-		uint32_t msi_adr;
-		uint32_t msi_dat;
-		Event(uint64_t _id, uint64_t _param, uint64_t _deadline, uint32_t _num, int32_t _tag, uint32_t _msi_adr, uint32_t _msi_dat) : id(_id), param(_param), deadline(_deadline), num(_num), tag(_tag), msi_adr(_msi_adr), msi_dat(_msi_dat) {}
-		bool operator==(const Event &rhs) const {
-			return id == rhs.id && param == rhs.param && deadline == rhs.deadline /*&& num == rhs.num*/ && tag == rhs.tag && msi_adr == rhs.msi_adr && msi_dat == rhs.msi_dat;
+	// sleep until the given time, but wake up regularly to see if the program should end
+	static bool sleep_until(uint64_t time_ns) {
+		for (;;) {
+			if (FpgaReset::_reset_was_triggered) {
+				return false;
+			}
+			uint64_t now = SoftwareECA::get_time_ns();
+			if (now >= time_ns) {
+				return true;
+			}
+			uint64_t delay = time_ns - now;
+			if (delay > UINT64_C(100000000)) delay = UINT64_C(100000000);
+			std::this_thread::sleep_for(std::chrono::nanoseconds(delay));
 		}
-		bool operator<(const Event& rhs) const {
-			return deadline < rhs.deadline;
+	}
+
+	bool wait_for_conditions() {
+		for (;;) {
+			for (auto eca: ecas) {
+				std::lock_guard<std::mutex> lock(eca->tables_mutex);
+				if (!eca->active_walker_table.empty()) {
+					return true;
+				}
+			}
+			if (!sleep_until(SoftwareECA::get_time_ns() + UINT64_C(10000000))) {
+				return false;
+			}
 		}
-	};
-	std::mutex events_mutex;
-	std::mutex actions_mutex;
-	std::deque<Event> events;
-	std::deque<Event> actions; // 2nd thread converts events into actions
+	}
 
+	unsigned inject(uint64_t id, uint64_t param, uint64_t deadline) {
+		unsigned actions = 0;
+		for (auto eca: ecas) {
+			actions += eca->inject(id, param, deadline);
+		}
+		return actions;
+	}
 
-	static void eca_events_to_actions(SoftwareECA *software_eca) {
-		for(; !FpgaReset::_reset_was_triggered; usleep(100)) {
-			for (;;) {
-				uint64_t now = SoftwareECA::get_time_ns();
-				std::lock_guard<std::mutex> lock_events(software_eca->events_mutex);
-				if (!software_eca->events.empty() && software_eca->events.front().deadline <= now) {
-					if (verbosity >= 1) {
-						std::cout << "creating action: now=" << std::dec << now << " deadline=" << software_eca->events.front().deadline << std::endl;
+	static void run(EventGenerator *generator) {
+		try {
+			std::vector<ReplayEvent> schedule;
+			if (!generator->replay_file.empty()) {
+				generator->read_replay_file(schedule);
+			}
+			if (!generator->wait_for_conditions()) {
+				return;
+			}
+			if (verbosity >= 0) {
+				std::cout << "event generator started" << std::endl;
+			}
+			uint64_t events = 0, actions = 0;
+			uint64_t start = SoftwareECA::get_time_ns();
+			if (!schedule.empty()) {
+				// like saft-dm: every iteration starts when the previous one was injected
+				for (unsigned iteration = 0; iteration < generator->replay_repeat; ++iteration) {
+					uint64_t iteration_start = SoftwareECA::get_time_ns() + generator->lead_time;
+					for (auto &event: schedule) {
+						uint64_t deadline = iteration_start + event.time;
+						if (!sleep_until(deadline - generator->lead_time)) {
+							break;
+						}
+						actions += generator->inject(event.id, event.param, deadline);
+						++events;
 					}
-					std::lock_guard<std::mutex> lock_actions(software_eca->actions_mutex);
-					// take an event from the event queue and insert it into 
-					//   action queue where it can be read from the ECA_QUEUE Device
-					software_eca->actions.push_back(software_eca->events.front());
-					software_eca->events.pop_front();
-					// create the MSI to signal host that an action is pending
-					eb_slave->push_msi(software_eca->actions.back().msi_adr, software_eca->actions.back().msi_dat);
-				} else {
-					break;
 				}
+			} else {
+				std::mt19937_64 random(generator->seed);
+				uint64_t burst_period = generator->burst_size*1e9/generator->rate;
+				uint64_t next_burst = start;
+				size_t next_id = 0;
+				while (generator->max_events == 0 || events < generator->max_events) {
+					if (!sleep_until(next_burst)) {
+						break;
+					}
+					uint64_t deadline = next_burst + generator->lead_time;
+					for (unsigned i = 0; i < generator->burst_size; ++i) {
+						uint64_t id;
+						if (generator->random_ids) {
+							id = generator->ids[random()%generator->ids.size()];
+						} else {
+							id = generator->ids[next_id++];
+							if (next_id == generator->ids.size()) next_id = 0;
+						}
+						// events of a burst are 1 ns apart, equal deadlines would be conflicts
+						actions += generator->inject(id, events, deadline + i);
+						++events;
+						if (events == generator->max_events) break;
+					}
+					// if the generator falls behind, the following bursts are generated 
+					// without delay until it has caught up
+					next_burst += burst_period;
+				}
+			}
+			if (verbosity >= 0) {
+				double seconds = (SoftwareECA::get_time_ns() - start)/1e9;
+				std::cout << "event generator: " << std::dec << events << " events in " << seconds << " s"
+				          << " (" << (uint64_t)(seconds>0?events/seconds:0) << " events/s), " 
+				          << actions << " actions" << std::endl;
 			}
+		} catch (std::runtime_error &e) {
+			std::cerr << "Event generator error: " << e.what() << std::endl;
 		}
 	}
-
-} software_eca; // directly create a global instance of our SoftwareECA
+} event_generator;
 
 
 // This class mimics the ECA control registers.
@@ -1310,29 +1828,37 @@ public:
 		vendor_id = 0x651,
 		product_id = 0xb2afc251,
 	};
-	EcaUnitControl(uint32_t adr_first, int instance) 
-		: _adr_first(adr_first) 
+	EcaUnitControl(Receiver &receiver, uint32_t adr_first, int instance) 
+		: _eca(receiver.eca)
+		, _adr_first(adr_first) 
 		, _instance(instance) 
+		, _selected_channel(0)
+		, _selected_num(0)
+		, _selected_code(0)
+		, _selected_search(0)
+		, _selected_walker(0)
+		, _search_entry{0, 0xffff}
+		, _walker_entry{0, 0, 0xffff, 0, 0, 0}
 	{
 		if (verbosity >= 1) {
 			std::cout << "EcaUnitControl " << std::hex << _adr_first << std::endl;
 		}
 	}
-	bool contains(uint32_t adr) {
-		return (adr >= _adr_first) && (adr < _adr_first + 0x100); 
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return {{_adr_first, _adr_first + 0xff}};
 	}
 
 	bool read_access(uint32_t adr, int sel, uint32_t *dat_out) {
 		const int channel_type[2] = {0,0};
 		const int channel_raw_max_num[2] = {20, 20};
-		const int channel_raw_capacity[2] = {100, 100};
+		const int channel_raw_capacity[2] = {100, (int)_eca.queue_capacity};
 		uint32_t result;
 		switch(adr-_adr_first) {
 			case ECA_CHANNELS_GET:         result =     2;
 			break;
-			case ECA_SEARCH_CAPACITY_GET:  result = 0x200;
+			case ECA_SEARCH_CAPACITY_GET:  result = SoftwareECA::search_capacity;
 			break;
-			case ECA_WALKER_CAPACITY_GET:  result = 0x100;
+			case ECA_WALKER_CAPACITY_GET:  result = SoftwareECA::walker_capacity;
 			break;
 			case ECA_LATENCY_GET: result = 12;
 			break;
@@ -1348,15 +1874,22 @@ public:
     		break;
     		case ECA_TIME_LO_GET: result = SoftwareECA::get_time_ns()&0xffffffff;
     		break;
-			case ECA_CHANNEL_MOSTFULL_ACK_GET:   result = 0;
-			break;
-			case ECA_CHANNEL_MOSTFULL_CLEAR_GET: result = 0;
-			break;
-			case ECA_CHANNEL_VALID_COUNT_GET:    result = 0;
-			break;
-			case ECA_CHANNEL_OVERFLOW_COUNT_GET: result = 0;
-			break;
-			case ECA_CHANNEL_FAILED_COUNT_GET:   result = 0;
+			case ECA_CHANNEL_MOSTFULL_ACK_GET:   
+			case ECA_CHANNEL_MOSTFULL_CLEAR_GET: 
+			case ECA_CHANNEL_VALID_COUNT_GET:    
+			case ECA_CHANNEL_OVERFLOW_COUNT_GET: 
+			case ECA_CHANNEL_FAILED_COUNT_GET:   
+			case ECA_CHANNEL_EVENT_ID_HI_GET:
+			case ECA_CHANNEL_EVENT_ID_LO_GET:
+			case ECA_CHANNEL_PARAM_HI_GET:
+			case ECA_CHANNEL_PARAM_LO_GET:
+			case ECA_CHANNEL_TAG_GET:
+			case ECA_CHANNEL_TEF_GET:
+			case ECA_CHANNEL_DEADLINE_HI_GET:
+			case ECA_CHANNEL_DEADLINE_LO_GET:
+			case ECA_CHANNEL_EXECUTED_HI_GET:
+			case ECA_CHANNEL_EXECUTED_LO_GET:
+				result = channel_status(adr-_adr_first);
 			break;
     		default: return false;
 		}
@@ -1367,73 +1900,25 @@ public:
 		return true;
 	}
 
-	bool is_prefix_mask(uint64_t mask) {
-		if (mask == 0) return true;
-		for (uint64_t m = UINT64_C(0xffffffffffffffff); m != 0; m <<= 1) {
-			if (mask == m) return true;
-		}
-		return false;
-	}
-	uint64_t fix_mask(uint64_t mask) {
-		for (uint64_t test = UINT64_C(0x8000000000000000); test != 0; test >>= 1) {
-			if ((mask&test) == 0) return ~((test<<1)-1);
-		}
-		return mask;
-	}
-
 	bool write_access(uint32_t adr, int sel, uint32_t dat) {
-		static int      selected_walker;
-		static int      prev_first_walker, first_walker;
-		static uint64_t prev_search_event, search_event;
-		static bool     end_of_search;
-		static bool     select_first;
-		// static int      null_walker = 0xffff;
 		switch(adr-_adr_first) {
 			case ECA_SEARCH_SELECT_RW:
-				// std::cerr << "ECA_SEARCH_SELECT_RW " << std::hex << dat << std::endl;
-				select_first = false;
-				if (dat == 0) {
-					if (verbosity >= 1) {
-						std::cout << ">>>>>>>>clear software_eca searches" << std::endl;
-					}
-					software_eca.searches.clear();
-					software_eca.search_candidates.clear();
-					prev_first_walker = -1;
-					prev_search_event = 0;
-					select_first = true;
-					end_of_search = false;
-				} 
+				_selected_search = dat;
 				return true;
 			case ECA_SEARCH_RW_FIRST_RW:     
-				// std::cerr << "ECA_SEARCH_RW_FIRST_RW:" << std::hex << dat << std::endl ;
-				first_walker = dat;
-				if (first_walker == 0xffff) first_walker = -1;
+				_search_entry.first_walker = dat;
 				return true;
 			case ECA_SEARCH_RW_EVENT_HI_RW: 
-				// std::cerr << "ECA_SEARCH_RW_EVENT_HI_RW: " << std::hex << dat << std::endl; 
-				search_event   = dat; 
-				search_event <<= 32;
+				_search_entry.event   = dat; 
+				_search_entry.event <<= 32;
 				return true;
 			case ECA_SEARCH_RW_EVENT_LO_RW: 
-				// std::cerr << "ECA_SEARCH_RW_EVENT_LO_RW: " << std::hex << dat << std::endl; 
-				// search_rw_event |= dat;
-				search_event |= dat;
-
-
-				// insert the data written into the registers into a search-candiate-list
-				if (prev_search_event == search_event && prev_first_walker == first_walker && !select_first) {
-					if (!end_of_search) {
-						// analyze the search-candidate-list and transform it into a list of tuples (id,mask,first_walker)
-						software_eca.analyse_search_candidates();
-					}
-					end_of_search = true;
-				}
-				if (!end_of_search) {
-					software_eca.search_candidates.push_back(SoftwareECA::SearchCandidate(first_walker,search_event));
-				}
-
-				prev_first_walker = first_walker;
-				prev_search_event = search_event;
+				_search_entry.event |= dat;
+				return true;
+			case ECA_SEARCH_WRITE_OWR:
+				return _eca.write_search_entry(_selected_search, _search_entry);
+			case ECA_FLIP_ACTIVE_OWR:
+				_eca.flip_tables();
 				return true;
 
 	    	case ECA_CHANNEL_SELECT_RW: 
@@ -1446,68 +1931,116 @@ public:
 				} else {
 					return false;
 				}
+			case ECA_CHANNEL_NUM_SELECT_RW:
+				_selected_num = dat;
+				return true;
+			case ECA_CHANNEL_CODE_SELECT_RW:
+				_selected_code = dat & 0x3;
+				return true;
 			case ECA_CHANNEL_MSI_SET_ENABLE_OWR: return true;
 			case ECA_CHANNEL_MSI_SET_TARGET_OWR: 
 				eca_msi_target_adr = dat; 
-				software_eca.msi_target_adr = dat;
+				_eca.msi_target_adr = dat;
 				return true;
 			case ECA_WALKER_SELECT_RW:
-				// std::cerr << "walker select " << std::dec << dat << std::endl; 
-				// _selected_walker = dat;
-				selected_walker = dat;
-				if (selected_walker == 0) {
-					software_eca.walker.clear();
-				} 
+				_selected_walker = dat;
 				return true;
 			case ECA_WALKER_RW_NEXT_RW:         
-				// std::cerr << "ECA_WALKER_RW_NEXT_RW " << std::hex << dat << std::endl;
-				software_eca.walker[selected_walker].next = dat;
-				 return true;
+				_walker_entry.next = dat;
+				return true;
 			case ECA_WALKER_RW_OFFSET_HI_RW:    
-				// std::cerr << "ECA_WALKER_RW_OFFSET_HI_RW " << std::hex << dat << std::endl; 
-				software_eca.walker[selected_walker].offset = dat;
-				software_eca.walker[selected_walker].offset <<= 32;
+				_walker_entry.offset = dat;
+				_walker_entry.offset <<= 32;
 				return true;
 			case ECA_WALKER_RW_OFFSET_LO_RW:    
-				software_eca.walker[selected_walker].offset |= dat;
-				//std::cerr << "ECA_WALKER_RW_OFFSET_LO_RW " << std::hex << dat << std::endl; 
+				_walker_entry.offset |= dat;
 				return true;
 			case ECA_WALKER_RW_TAG_RW:
-				// std::cerr << "walker TAG : " << std::dec << dat << std::endl ;
-				software_eca.walker[selected_walker].tag = dat;
+				_walker_entry.tag = dat;
 				return true;
 			case ECA_WALKER_RW_FLAGS_RW:        
-				//std::cerr << "ECA_WALKER_RW_FLAGS_RW " << std::hex << dat << std::endl; 
-				software_eca.walker[selected_walker].flags = dat;
+				_walker_entry.flags = dat;
 				return true;
 			case ECA_WALKER_RW_CHANNEL_RW:      
-				//std::cerr << "ECA_WALKER_RW_CHANNEL_RW " << std::hex << dat << std::endl; 
-				software_eca.walker[selected_walker].channel = dat;
+				_walker_entry.channel = dat;
 				return true;
 			case ECA_WALKER_RW_NUM_RW:          
-				//std::cerr << "ECA_WALKER_RW_NUM_RW " << std::hex << dat << std::endl; 
-				software_eca.walker[selected_walker].num = dat;
+				_walker_entry.num = dat;
 				return true;
 			case ECA_WALKER_WRITE_OWR:          
-				//std::cerr << "write walker tags " << std::hex << dat << std::endl; /*_walker_tags = _walker_tags_tmp; _walker_tags_tmp.clear();*/ 
 				if (verbosity >= 1) {
-					std::cout << "walker " << std::dec << selected_walker 
-								<< " next=" << software_eca.walker[selected_walker].next 
-								<< " tag=" << software_eca.walker[selected_walker].tag
-								<< " flags=" << std::hex << software_eca.walker[selected_walker].flags
-								<< " channel=" << std::dec << software_eca.walker[selected_walker].channel
-								<< " num=" << std::dec << software_eca.walker[selected_walker].num
+					std::cout << "walker " << std::dec << _selected_walker 
+								<< " next=" << _walker_entry.next 
+								<< " tag=" << _walker_entry.tag
+								<< " flags=" << std::hex << _walker_entry.flags
+								<< " channel=" << std::dec << _walker_entry.channel
+								<< " num=" << std::dec << _walker_entry.num
 								<< std::endl;
 				}
-				return true;
+				return _eca.write_walker_entry(_selected_walker, _walker_entry);
 		}
 		return false; 
 	}
 
 private:
+	// Counters and failure records of the selected channel/subchannel/code.
+	// Only channel 1 (the Linux facing queue) is emulated, all other channels read as 0.
+	uint32_t channel_status(uint32_t reg) {
+		if (_selected_channel != 1) {
+			return 0;
+		}
+		std::lock_guard<std::mutex> lock(_eca.actions_mutex);
+		SoftwareECA::Subchannel &sub = _eca.subchannel(_selected_num);
+		const SoftwareECA::Event &failed = sub.failed[_selected_code];
+		uint32_t used = _eca.actions.size();
+		uint32_t result = 0;
+		switch(reg) {
+			case ECA_CHANNEL_MOSTFULL_ACK_GET:   
+				result = used<<16 | _eca.most_full;
+				_eca.most_full_armed = true;
+			break;
+			case ECA_CHANNEL_MOSTFULL_CLEAR_GET: 
+				result = used<<16 | _eca.most_full;
+				_eca.most_full       = used;
+				_eca.most_full_armed = true;
+			break;
+			case ECA_CHANNEL_VALID_COUNT_GET:    
+				result = sub.valid_count;
+				sub.valid_count = 0;
+			break;
+			case ECA_CHANNEL_OVERFLOW_COUNT_GET: 
+				result = sub.overflow_count;
+				sub.overflow_count = 0;
+			break;
+			case ECA_CHANNEL_FAILED_COUNT_GET:   
+				result = sub.failed_count[_selected_code];
+				sub.failed_count[_selected_code] = 0;
+				sub.failed[_selected_code] = SoftwareECA::Event(0,0,0,0,0,0,0);
+			break;
+			case ECA_CHANNEL_EVENT_ID_HI_GET: result = failed.id>>32;              break;
+			case ECA_CHANNEL_EVENT_ID_LO_GET: result = failed.id&0xffffffff;       break;
+			case ECA_CHANNEL_PARAM_HI_GET:    result = failed.param>>32;           break;
+			case ECA_CHANNEL_PARAM_LO_GET:    result = failed.param&0xffffffff;    break;
+			case ECA_CHANNEL_TAG_GET:         result = failed.tag;                 break;
+			case ECA_CHANNEL_TEF_GET:         result = 0;                          break;
+			case ECA_CHANNEL_DEADLINE_HI_GET: result = failed.deadline>>32;        break;
+			case ECA_CHANNEL_DEADLINE_LO_GET: result = failed.deadline&0xffffffff; break;
+			case ECA_CHANNEL_EXECUTED_HI_GET: result = failed.executed>>32;        break;
+			case ECA_CHANNEL_EXECUTED_LO_GET: result = failed.executed&0xffffffff; break;
+		}
+		return result;
+	}
+
+	SoftwareECA &_eca;
 	uint32_t _adr_first;
 	int      _instance;
 	int 	 _selected_channel;
+	unsigned _selected_num;
+	unsigned _selected_code;
+	unsigned _selected_search;
+	unsigned _selected_walker;
+	SoftwareECA::SearchEntry _search_entry; // values of the search table registers
+	SoftwareECA::Walker      _walker_entry; // values of the walker table registers
 	std::vector<uint32_t> _rom;
 };
 
@@ -1518,36 +2051,37 @@ public:
 		vendor_id = 0x651,
 		product_id = 0xd5a3faea,
 	};
-	EcaQueue(uint32_t adr_first, int instance) 
-		: _adr_first(adr_first) 
+	EcaQueue(Receiver &receiver, uint32_t adr_first, int instance) 
+		: _eca(receiver.eca)
+		, _adr_first(adr_first) 
 		, _instance(instance) 
 	{
 		if (verbosity >= 0) {
 			std::cout << "EcaQueue " << std::hex << _adr_first << std::endl;
 		}
 	}
-	bool contains(uint32_t adr) {
-		return (adr >= _adr_first) && (adr < _adr_first + 0x40); 
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return {{_adr_first, _adr_first + 0x3f}};
 	}
 	bool read_access(uint32_t adr, int sel, uint32_t *dat_out) {
 
 		// std::cerr << "ECA queue read access " << std::hex << adr-_adr_first << std::endl;
-		// std::cerr << "software_eca.events.size()=" << software_eca.events.size() << std::endl;
-		std::lock_guard<std::mutex> lock(software_eca.actions_mutex);
-		if (!software_eca.actions.empty()) {
-			uint64_t execution_time = SoftwareECA::get_time_ns();
+		// std::cerr << "_eca.events.size()=" << _eca.events.size() << std::endl;
+		std::lock_guard<std::mutex> lock(_eca.actions_mutex);
+		if (!_eca.actions.empty()) {
+			uint64_t execution_time = _eca.actions.front().executed;
 			switch (adr-_adr_first) {
 				case ECA_QUEUE_QUEUE_ID_GET:    *dat_out = 0; return true;
-				case ECA_QUEUE_FLAGS_GET:       *dat_out = (1 << ECA_VALID); return true;
-				case ECA_QUEUE_NUM_GET:         *dat_out = software_eca.actions.front().num; return true;
-				case ECA_QUEUE_EVENT_ID_HI_GET: *dat_out = software_eca.actions.front().id>>32; /*eca_in_buffer[0]*/; return true;
-				case ECA_QUEUE_EVENT_ID_LO_GET: *dat_out = software_eca.actions.front().id&0xffffffff; /*eca_in_buffer[1]*/; return true;
-				case ECA_QUEUE_PARAM_HI_GET:    *dat_out = software_eca.actions.front().param>>32; /*eca_in_buffer[2]*/; return true;
-				case ECA_QUEUE_PARAM_LO_GET:    *dat_out = software_eca.actions.front().param&0xffffffff; /*eca_in_buffer[3]*/; return true;
-				case ECA_QUEUE_TAG_GET:         *dat_out = software_eca.actions.front().tag; /*eca_tag*/;          return true;
+				case ECA_QUEUE_FLAGS_GET:       *dat_out = (1 << ECA_VALID) | _eca.actions.front().flags; return true;
+				case ECA_QUEUE_NUM_GET:         *dat_out = _eca.actions.front().num; return true;
+				case ECA_QUEUE_EVENT_ID_HI_GET: *dat_out = _eca.actions.front().id>>32; /*eca_in_buffer[0]*/; return true;
+				case ECA_QUEUE_EVENT_ID_LO_GET: *dat_out = _eca.actions.front().id&0xffffffff; /*eca_in_buffer[1]*/; return true;
+				case ECA_QUEUE_PARAM_HI_GET:    *dat_out = _eca.actions.front().param>>32; /*eca_in_buffer[2]*/; return true;
+				case ECA_QUEUE_PARAM_LO_GET:    *dat_out = _eca.actions.front().param&0xffffffff; /*eca_in_buffer[3]*/; return true;
+				case ECA_QUEUE_TAG_GET:         *dat_out = _eca.actions.front().tag; /*eca_tag*/;          return true;
 				case ECA_QUEUE_TEF_GET:         *dat_out = 0; /*eca_in_buffer[5]*/; return true;
-				case ECA_QUEUE_DEADLINE_HI_GET: *dat_out = software_eca.actions.front().deadline>>32;/*eca_in_buffer[6];*/ return true;
-				case ECA_QUEUE_DEADLINE_LO_GET: *dat_out = software_eca.actions.front().deadline&0xffffffff;/*eca_in_buffer[7];*/ return true;
+				case ECA_QUEUE_DEADLINE_HI_GET: *dat_out = _eca.actions.front().deadline>>32;/*eca_in_buffer[6];*/ return true;
+				case ECA_QUEUE_DEADLINE_LO_GET: *dat_out = _eca.actions.front().deadline&0xffffffff;/*eca_in_buffer[7];*/ return true;
 				case ECA_QUEUE_EXECUTED_HI_GET: *dat_out = execution_time>>32; return true;
 				case ECA_QUEUE_EXECUTED_LO_GET: *dat_out = execution_time&0xffffffff; return true;
 			}
@@ -1556,11 +2090,11 @@ public:
 	}
 
 	bool write_access(uint32_t adr, int sel, uint32_t dat) {
-		std::lock_guard<std::mutex> lock(software_eca.actions_mutex);
+		std::lock_guard<std::mutex> lock(_eca.actions_mutex);
 		if (adr-_adr_first == ECA_QUEUE_POP_OWR) {
-			if (!software_eca.actions.empty()) software_eca.actions.pop_front(); 
+			if (!_eca.actions.empty()) _eca.actions.pop_front(); 
 			if (verbosity >= 1) {
-				std::cout << "ECA_QUEUE_POP_OWR actions.size()=" << software_eca.actions.size() << std::endl; 
+				std::cout << "ECA_QUEUE_POP_OWR actions.size()=" << _eca.actions.size() << std::endl; 
 			}
 			return true;
 		}
@@ -1568,6 +2102,7 @@ public:
 	}
 
 private:
+	SoftwareECA &_eca;
 	uint32_t _adr_first;
 	int      _instance;
 };
@@ -1579,8 +2114,9 @@ public:
 		vendor_id = 0x651,
 		product_id = 0x8752bf45,
 	};
-	EcaEventsIn(uint32_t adr_first, int instance) 
-		: _adr_first(adr_first) 
+	EcaEventsIn(Receiver &receiver, uint32_t adr_first, int instance) 
+		: _eca(receiver.eca)
+		, _adr_first(adr_first) 
 		, _instance(instance) 
 		, _write_count(0)
 	{
@@ -1588,22 +2124,22 @@ public:
 			std::cout << "EcaEventsIn " << std::hex << _adr_first << std::endl;
 		}
 	}
-	bool contains(uint32_t adr) {
-		return adr == _adr_first; 
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return {{_adr_first, _adr_first}};
 	}
 	bool write_access(uint32_t adr, int sel, uint32_t dat) {
 		if (verbosity >= 1) {
 			std::cout << "eca_event_in " << std::hex << adr << " " << dat << std::endl;
 		}
 		eca_in_buffer[_write_count] = dat;
-		software_eca.in_buffer[_write_count] = dat;
+		_eca.in_buffer[_write_count] = dat;
 		++_write_count;
 		if (_write_count == 8) {
 			_write_count = 0;
 			if (verbosity >= 1) {
 				std::cout << "====> injection of event" << std::endl;
 			}
-			software_eca.inject();
+			_eca.inject();
 			//eb_slave->push_msi(eca_msi_target_adr, 0x40000);
 		}
 		return true;
@@ -1611,6 +2147,7 @@ public:
 
 
 private:
+	SoftwareECA &_eca;
 	uint32_t _adr_first;
 	int      _instance;
 	int      _write_count;
@@ -1629,7 +2166,7 @@ public:
 		vendor_id = 0x651,
 		product_id = 0x2d39fa8b,
 	};
-	BuildIdRom(uint32_t adr_first, int instance) 
+	BuildIdRom(Receiver &receiver, uint32_t adr_first, int instance) 
 		: _adr_first(adr_first) 
 		, _instance(instance) 
 	{
@@ -1665,8 +2202,8 @@ public:
 		}
 		while (_rom.size() < 0x400) _rom.push_back(0);
 	}
-	bool contains(uint32_t adr) {
-		return (adr >= _adr_first) && (adr < _adr_first + 0x400); 
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return {{_adr_first, _adr_first + 0x3ff}};
 	}
 	bool read_access(uint32_t adr, int sel, uint32_t *dat_out) {
 		unsigned rom_idx = (adr-_adr_first)/4;
@@ -1696,7 +2233,7 @@ public:
 		vendor_id = 0xce42,
 		product_id = 0xde0d8ced,
 	};
-	WrPpsGenerator(uint32_t adr_first, int instance) 
+	WrPpsGenerator(Receiver &receiver, uint32_t adr_first, int instance) 
 		: _adr_first(adr_first) 
 		, _instance(instance) 
 	{
@@ -1704,8 +2241,8 @@ public:
 			std::cout << "WrPpsGenerator " << std::hex << _adr_first << std::endl;
 		}
 	}
-	bool contains(uint32_t adr) {
-		return (adr >= _adr_first) && (adr < _adr_first + 0x100); 
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return {{_adr_first, _adr_first + 0xff}};
 	}
 	// this pps generator is alywas locked
 	bool read_access(uint32_t adr, int sel, uint32_t *dat_out) {
@@ -1726,39 +2263,100 @@ private:
 
 
 
+// This class mimics the IO control registers with a few GPIO outputs.
+//  There are no physical pins, an output value that is written can be read back 
+//  from the output register and from the combined output register.
+//  The configuration registers (output enable, termination, multiplexers, gates, ...)
+//  are plain set/reset bit registers.
 class IoControl : public Device {
 public:
 	enum {
 		vendor_id = 0x651,
 		product_id = 0x10c05791,
 	};
-	IoControl(uint32_t adr_first, int instance) 
+	IoControl(Receiver &receiver, uint32_t adr_first, int instance) 
 		: _adr_first(adr_first) 
 		, _instance(instance) 
+		, _outputs(num_outputs, 0)
 	{
 		if (verbosity >= 1) {
 			std::cout << "IoControl " << std::hex << _adr_first << std::endl;
 		}
 	}
-	bool contains(uint32_t adr) {
-		return (adr >= _adr_first) && (adr < _adr_first + 0x10000); 
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return {{_adr_first, _adr_first + 0xffff}};
 	}
 	bool read_access(uint32_t adr, int sel, uint32_t *dat_out) {
-  		const uint32_t eGPIO_Info   = 0x0104;
-  		const uint32_t eLVDS_Info   = 0x0108;
-  		const uint32_t eFIXED_Info  = 0x010c;
-		switch(adr-_adr_first) {
-			case eGPIO_Info:  *dat_out = 0; return true;
+		uint32_t offset = adr-_adr_first;
+		switch(offset) {
+			case eGPIO_Info:  *dat_out = num_outputs<<24 | num_outputs<<8; return true; // all GPIOs are outputs
 			case eLVDS_Info:  *dat_out = 0; return true;
 			case eFIXED_Info: *dat_out = 0; return true;
 		}
-
+		if (offset >= eConfig_Begin && offset < eConfig_End) {
+			*dat_out = _config[offset & ~eConfig_Reset];
+			return true;
+		}
+		if (offset >= eSet_GPIO_Out_Begin && offset < eSet_GPIO_Out_Begin + num_outputs*4) {
+			*dat_out = _outputs[(offset-eSet_GPIO_Out_Begin)/4];
+			return true;
+		}
+		// there are no inputs, the combined output registers start right at the input registers
+		if (offset >= eGet_GPIO_In_Begin && offset < eGet_GPIO_In_Begin + num_outputs*4) {
+			*dat_out = _outputs[(offset-eGet_GPIO_In_Begin)/4];
+			return true;
+		}
+		if (offset >= eIO_Map_Table_Begin && offset < eIO_Map_Table_Begin + num_outputs*16) {
+			*dat_out = io_table_word((offset-eIO_Map_Table_Begin)/16, (offset-eIO_Map_Table_Begin)%16/4);
+			return true;
+		}
+		return false;
+	}
+	bool write_access(uint32_t adr, int sel, uint32_t dat) {
+		uint32_t offset = adr-_adr_first;
+		if (offset >= eConfig_Begin && offset < eConfig_End) {
+			if (offset & eConfig_Reset) _config[offset & ~eConfig_Reset] &= ~dat;
+			else                        _config[offset]                  |=  dat;
+			return true;
+		}
+		if (offset >= eSet_GPIO_Out_Begin && offset < eSet_GPIO_Out_Begin + num_outputs*4) {
+			_outputs[(offset-eSet_GPIO_Out_Begin)/4] = dat;
+			return true;
+		}
 		return false;
 	}
 
 private:
+	enum {
+		num_outputs         = 4,
+		eGPIO_Info          = 0x0104,
+		eLVDS_Info          = 0x0108,
+		eFIXED_Info         = 0x010c,
+		eConfig_Begin       = 0x0200, // set registers at +0 (low), +4 (high), reset registers at +8 (low), +c (high)
+		eConfig_End         = 0x5000,
+		eConfig_Reset       = 0x8,
+		eSet_GPIO_Out_Begin = 0xa000,
+		eGet_GPIO_In_Begin  = 0xc000,
+		eIO_Map_Table_Begin = 0xe000,
+	};
+	// 3 words name, 1 word special purpose, index, configuration and logic level
+	uint32_t io_table_word(unsigned io, unsigned word) {
+		if (word < 3) {
+			char name[12] = {0};
+			snprintf(name, sizeof(name), "IO%u", io+1);
+			return (uint8_t)name[word*4+0]<<24 | (uint8_t)name[word*4+1]<<16 | (uint8_t)name[word*4+2]<<8 | (uint8_t)name[word*4+3];
+		}
+		const uint32_t cfg = 0<<6  // direction: output
+		                   | 0<<3  // channel: GPIO
+		                   | 1<<2; // output enable available
+		const uint32_t logic_level = 1<<4; // LVTTL
+		return io<<16 | cfg<<8 | logic_level;
+	}
+
 	uint32_t _adr_first;
 	int      _instance;
+	std::vector<uint32_t> _outputs;
+	std::map<uint32_t, uint32_t> _config;
 };
 
 
@@ -1771,8 +2369,9 @@ public:
 		vendor_id = 0x651,
 		product_id = 0xfab0bdd8,
 	};
-	MsiMailbox(uint32_t adr_first, int instance) 
-		: _adr_first(adr_first) 
+	MsiMailbox(Receiver &receiver, uint32_t adr_first, int instance) 
+		: _receiver(receiver)
+		, _adr_first(adr_first) 
 		, _instance(instance) 
 		, _write_count(0)
 		, _slots(128, 0xffffffff)
@@ -1781,8 +2380,8 @@ public:
 			std::cout << "MsiMailbox " << std::hex << _adr_first << std::endl;
 		}
 	}
-	bool contains(uint32_t adr) {
-		return adr >= _adr_first && adr <= _adr_first + 2*128*4;
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return {{_adr_first, _adr_first + 2*128*4}};
 	}
 	bool write_access(uint32_t adr, int sel, uint32_t dat) {
 		if (verbosity >= 1) {
@@ -1792,7 +2391,7 @@ public:
 		if (idx%2) {
 			_slots[idx/2] = dat;
 		} else {
-			eb_slave->push_msi(_slots[idx/2], dat);
+			_receiver.eb_slave->push_msi(_slots[idx/2], dat);
 		}
 		return true;
 	}
@@ -1811,6 +2410,7 @@ public:
 
 
 private:
+	Receiver &_receiver;
 	uint32_t _adr_first;
 	int      _instance;
 	int      _write_count;
@@ -1824,15 +2424,15 @@ public:
 		vendor_id = 0x651,
 		product_id = 0x10040086,
 	};
-	LM32ClusterInfoRom(uint32_t adr_first, uint32_t instance) 
+	LM32ClusterInfoRom(Receiver &receiver, uint32_t adr_first, uint32_t instance) 
 		: _adr_first(adr_first) 
 	{
 		if (verbosity >= 1) {
 			std::cout << "LM32ClusterInfoRom " << std::hex << _adr_first << std::endl;
 		}
 	}
-	bool contains(uint32_t adr) {
-		return adr >= _adr_first && adr <= _adr_first + 4;
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return {{_adr_first, _adr_first + 4}};
 	}
 	bool write_access(uint32_t adr, int sel, uint32_t dat) {
 		if (verbosity >= 1) {
@@ -1853,6 +2453,53 @@ private:
 	uint32_t _adr_first;
 };
 
+// Plain memory for the user RAM of an LM32 core. There is no CPU executing
+// code from it, but host programs can exchange data with it as with the 
+// shared memory of a real LM32 (e.g. to measure access times).
+class LM32Ram : public Device {
+public:
+	enum {
+		vendor_id = 0x651,
+		product_id = 0x54111351,
+		size = 0x20000, // as in software-tr.sdb
+	};
+	LM32Ram(Receiver &receiver, uint32_t adr_first, uint32_t instance) 
+		: _adr_first(adr_first) 
+		, _memory(size/4, 0)
+	{
+		if (verbosity >= 1) {
+			std::cout << "LM32Ram " << std::hex << _adr_first << std::endl;
+		}
+	}
+	std::vector<std::pair<uint32_t, uint32_t> > address_ranges() {
+		return {{_adr_first, _adr_first + size - 1}};
+	}
+	bool write_access(uint32_t adr, int sel, uint32_t dat) {
+		if (verbosity >= 1) {
+			std::cout << "LM32Ram write access: " << std::hex << adr << " " << dat << std::endl;
+		}
+		uint32_t &word = _memory[(adr-_adr_first)/4];
+		uint32_t mask = 0;
+		for (int i = 0; i < 4; ++i) {
+			if (sel & (1<<i)) mask |= UINT32_C(0xff) << (8*i);
+		}
+		word = (word & ~mask) | (dat & mask);
+		return true;
+	}
+	bool read_access(uint32_t adr, int sel, uint32_t *dat_out) {
+		*dat_out = _memory[(adr-_adr_first)/4];
+		if (verbosity >= 1) {
+			std::cout << "LM32Ram read access: " << std::hex << adr << " " << *dat_out << std::endl;
+		}
+		return true;
+	}
+
+
+private:
+	uint32_t _adr_first;
+	std::vector<uint32_t> _memory;
+};
+
 }
 
 ///////////////////////////////////////////////////////
@@ -1976,6 +2623,10 @@ int main(int argc, char *argv[]) {
 	try {
 
 		std::string sdb_filename = DATADIR "/software-tr.sdb";
+		bool signal_level = false; // emulate the wishbone signals instead of handling whole etherbone records
+		unsigned num_devices = 1;
+		unsigned queue_capacity = 100;
+		uint64_t delayed_threshold = 1000000;
 		if (argc != 1) {
 			for (int i = 1; i < argc; i++) {
 				std::string argvi(argv[i]);
@@ -1990,6 +2641,10 @@ int main(int argc, char *argv[]) {
 						return 1;
 					}
 				}
+				if (argvi == "--benchmark-matcher") {
+					benchmark_matcher();
+					return 0;
+				}
 				if (argvi == "--sdb") {
 					++i;
 					if (i < argc) {
@@ -2009,91 +2664,229 @@ int main(int argc, char *argv[]) {
 				if (argvi == "--polled-msis" || argvi == "-p") {
 					poll_msis = true;
 				}
+				if (argvi == "--signal-level" || argvi == "-s") {
+					signal_level = true;
+				}
+				if (argvi == "--devices" || argvi == "-n") {
+					++i;
+					std::istringstream in((i < argc)?argv[i]:"");
+					if (!(in >> num_devices) || num_devices == 0) {
+						std::cerr << "expecting number of devices after --devices" << std::endl;
+						return 1;
+					}
+				}
+				if (argvi == "--generate") {
+					++i;
+					std::istringstream in((i < argc)?argv[i]:"");
+					if (!(in >> event_generator.rate) || event_generator.rate <= 0) {
+						std::cerr << "expecting number of events per second after --generate" << std::endl;
+						return 1;
+					}
+				}
+				if (argvi == "--generate-ids") {
+					++i;
+					if (!event_generator.set_ids((i < argc)?argv[i]:"")) {
+						std::cerr << "expecting comma separated list of event ids after --generate-ids" << std::endl;
+						return 1;
+					}
+				}
+				if (argvi == "--generate-random") {
+					event_generator.random_ids = true;
+				}
+				if (argvi == "--generate-seed") {
+					++i;
+					std::istringstream in((i < argc)?argv[i]:"");
+					if (!(in >> event_generator.seed)) {
+						std::cerr << "expecting seed after --generate-seed" << std::endl;
+						return 1;
+					}
+				}
+				if (argvi == "--generate-burst") {
+					++i;
+					std::istringstream in((i < argc)?argv[i]:"");
+					if (!(in >> event_generator.burst_size) || event_generator.burst_size == 0) {
+						std::cerr << "expecting number of events per burst after --generate-burst" << std::endl;
+						return 1;
+					}
+				}
+				if (argvi == "--generate-count") {
+					++i;
+					std::istringstream in((i < argc)?argv[i]:"");
+					if (!(in >> event_generator.max_events)) {
+						std::cerr << "expecting number of events after --generate-count" << std::endl;
+						return 1;
+					}
+				}
+				if (argvi == "--lead-time") {
+					++i;
+					std::istringstream in((i < argc)?argv[i]:"");
+					if (!(in >> event_generator.lead_time)) {
+						std::cerr << "expecting time in ns after --lead-time" << std::endl;
+						return 1;
+					}
+				}
+				if (argvi == "--replay") {
+					++i;
+					if (i < argc) {
+						event_generator.replay_file = argv[i];
+					} else {
+						std::cerr << "expecting event file name after --replay" << std::endl;
+						return 1;
+					}
+				}
+				if (argvi == "--replay-repeat") {
+					++i;
+					std::istringstream in((i < argc)?argv[i]:"");
+					if (!(in >> event_generator.replay_repeat)) {
+						std::cerr << "expecting number of iterations after --replay-repeat" << std::endl;
+						return 1;
+					}
+				}
+				if (argvi == "--queue-capacity") {
+					++i;
+					std::istringstream in((i < argc)?argv[i]:"");
+					if (!(in >> queue_capacity) || queue_capacity == 0 || queue_capacity > 0xffff) {
+						std::cerr << "expecting number of actions (1..65535) after --queue-capacity" << std::endl;
+						return 1;
+					}
+				}
+				if (argvi == "--delayed-threshold") {
+					++i;
+					std::istringstream in((i < argc)?argv[i]:"");
+					if (!(in >> delayed_threshold)) {
+						std::cerr << "expecting time in ns after --delayed-threshold" << std::endl;
+						return 1;
+					}
+				}
+				if (argvi == "--jitter-report") {
+					++i;
+					std::istringstream in((i < argc)?argv[i]:"");
+					if (!(in >> jitter_report_interval)) {
+						std::cerr << "expecting number of seconds after --jitter-report" << std::endl;
+						return 1;
+					}
+				}
 			}
 		}
 
-		// all devices
-		std::vector<std::shared_ptr<Device> > devices;
+		if (signal_level && num_devices > 1) {
+			std::cerr << "--signal-level works only with one device" << std::endl;
+			return 1;
+		}
 
-		// read the sdb-rom from file
+		// read the sdb-rom from file, it is shared by all devices
 		auto sdb = std::make_shared<SDBrecords>(sdb_filename);
-		devices.push_back(sdb);
-		for(auto &device: sdb->create_devices<WatchdogMutex>()     ) devices.push_back(device);
-		for(auto &device: sdb->create_devices<BuildIdRom>()        ) devices.push_back(device);
-		for(auto &device: sdb->create_devices<WrPpsGenerator>()    ) devices.push_back(device);
-		for(auto &device: sdb->create_devices<EcaUnitControl>()    ) devices.push_back(device);
-		for(auto &device: sdb->create_devices<IoControl>()         ) devices.push_back(device);
-		for(auto &device: sdb->create_devices<EcaQueue>()          ) devices.push_back(device);
-		for(auto &device: sdb->create_devices<FpgaReset>()         ) devices.push_back(device);
-		for(auto &device: sdb->create_devices<EcaEventsIn>()       ) devices.push_back(device);
-		for(auto &device: sdb->create_devices<MsiMailbox>()        ) devices.push_back(device);
-		for(auto &device: sdb->create_devices<LM32ClusterInfoRom>()) devices.push_back(device);
-
-		// create the etherbone slave.
-		// It appears as pseudo-terminal device as /dev/pts/<n>
-		//  <n> is an integer selected by the OS
-		bool stop_until_connected = true;
-		eb_slave = new EBslave(stop_until_connected, 
-		                       sdb->start_adr(), 
-		                       0x20000, 
-		                       0x2ffff);
-
-		// Endless loop to service wb-requests from the etherbone slave (= wb master)
-		// (The code looks a bit strange because it was initially developed with the 
-		//  use case of a VHDL simulation in mind.)
-		std_logic_t cyc, stb, we;
-		std_logic_t ack=STD_LOGIC_0;
-		std_logic_t err=STD_LOGIC_0;
-		int adr, dat, sel;
-		uint32_t dat_out;
-
-		std::thread eca_thread(SoftwareECA::eca_events_to_actions, &software_eca);
-
-		int ending_countdown = 3; // after reset, 3 more eb_slave cycles are needed to end the eb_master transaction
-		while(FpgaReset::_reset_was_triggered == false || ending_countdown > 0){
-			if (FpgaReset::_reset_was_triggered) {
-				eb_slave->shutdown();
-				std::cerr << --ending_countdown << std::endl;
+
+		std::vector<std::unique_ptr<Receiver> > receivers;
+		for (unsigned n = 0; n < num_devices; ++n) {
+			receivers.push_back(std::unique_ptr<Receiver>(new Receiver));
+			Receiver &receiver = *receivers.back();
+			receiver.eca.queue_capacity    = queue_capacity;
+			receiver.eca.delayed_threshold = delayed_threshold;
+
+			// all devices
+			DeviceMap &devices = receiver.devices;
+			devices.add(sdb);
+			for(auto &device: sdb->create_devices<WatchdogMutex>(receiver)     ) devices.add(device);
+			for(auto &device: sdb->create_devices<BuildIdRom>(receiver)        ) devices.add(device);
+			for(auto &device: sdb->create_devices<WrPpsGenerator>(receiver)    ) devices.add(device);
+			for(auto &device: sdb->create_devices<EcaUnitControl>(receiver)    ) devices.add(device);
+			for(auto &device: sdb->create_devices<IoControl>(receiver)         ) devices.add(device);
+			for(auto &device: sdb->create_devices<EcaQueue>(receiver)          ) devices.add(device);
+			for(auto &device: sdb->create_devices<FpgaReset>(receiver)         ) devices.add(device);
+			for(auto &device: sdb->create_devices<EcaEventsIn>(receiver)       ) devices.add(device);
+			for(auto &device: sdb->create_devices<MsiMailbox>(receiver)        ) devices.add(device);
+			for(auto &device: sdb->create_devices<LM32ClusterInfoRom>(receiver)) devices.add(device);
+			for(auto &device: sdb->create_devices<LM32Ram>(receiver)           ) devices.add(device);
+
+			// create the etherbone slave.
+			// It appears as pseudo-terminal device as /dev/pts/<n>
+			//  <n> is an integer selected by the OS
+			// With several devices, nobody would connect to the later devices while the program 
+			// waits for a client on the first one, so the simulation starts immediately.
+			bool stop_until_connected = (num_devices == 1);
+			std::ostringstream device_file;
+			device_file << "/tmp/simbridge-eb-device";
+			if (n > 0) {
+				device_file << "-" << n;
 			}
-			eb_slave->master_out(&cyc,&stb,&we,&adr,&dat,&sel);
-			if (cyc==STD_LOGIC_1 && stb==STD_LOGIC_1) {
-				bool found_adr = false;
-				for (auto &device: devices) {
-					// look if any of the devices contains the requested address
-					if (device->contains(adr)) {
-						found_adr = true;
-						bool device_ack = false;
-						// do a read/write access on the device
-						if (we== STD_LOGIC_1) {
-							device_ack = device->write_access(adr,sel,dat);
-						} else {
-							device_ack = device->read_access(adr,sel,&dat_out);
-						}
-						if (device_ack) {
-							ack = STD_LOGIC_1;
-							err = STD_LOGIC_0;
-						} else {
-							err = STD_LOGIC_1;
-							ack = STD_LOGIC_0;
-						}
-						break;
-					}
-				} 
-				if (!found_adr) {
-					if (verbosity >= 0) {
-						std::cout << "address not mapped: 0x" 
-					              << std::hex << std::setw(8) << std::setfill('0') << adr
-						          << std::endl;
+			receiver.eb_slave.reset(new EBslave(stop_until_connected, 
+			                                    sdb->start_adr(), 
+			                                    0x20000, 
+			                                    0x2ffff,
+			                                    device_file.str()));
+			receiver.eca.eb_slave = receiver.eb_slave.get();
+			event_generator.ecas.push_back(&receiver.eca);
+		}
+
+		// one thread releases the actions of all devices
+		std::thread eca_thread(SoftwareECA::eca_events_to_actions);
+		std::thread generator_thread;
+		if (event_generator.enabled()) {
+			generator_thread = std::thread(EventGenerator::run, &event_generator);
+		}
+
+		if (!signal_level) {
+			// handle complete etherbone records until the reset is triggered.
+			// The response to the write access that triggered the reset is sent by handle_records.
+			// One poll covers the pseudo-terminals of all devices.
+			std::vector<struct pollfd> pfds(receivers.size());
+			while(FpgaReset::_reset_was_triggered == false) {
+				for (unsigned n = 0; n < receivers.size(); ++n) {
+					pfds[n].fd      = receivers[n]->eb_slave->fd();
+					pfds[n].events  = POLLIN;
+					pfds[n].revents = 0;
+				}
+				poll(&pfds[0], pfds.size(), 1);
+				for (unsigned n = 0; n < receivers.size(); ++n) {
+					if (pfds[n].revents || receivers[n]->eb_slave->msis_pending()) {
+						receivers[n]->eb_slave->handle_records(receivers[n]->devices, 0);
 					}
-					ack = STD_LOGIC_0;
-					err = STD_LOGIC_1;
 				}
 			}
+			for (auto &receiver: receivers) {
+				receiver->eb_slave->shutdown();
+			}
+		} else {
+			EBslave  *eb_slave = receivers[0]->eb_slave.get();
+			DeviceMap &devices = receivers[0]->devices;
+			// Endless loop to service wb-requests from the etherbone slave (= wb master)
+			// (The code looks a bit strange because it was initially developed with the 
+			//  use case of a VHDL simulation in mind.)
+			std_logic_t cyc, stb, we;
+			std_logic_t ack=STD_LOGIC_0;
+			std_logic_t err=STD_LOGIC_0;
+			int adr, dat, sel;
+			uint32_t dat_out;
+
+			int ending_countdown = 3; // after reset, 3 more eb_slave cycles are needed to end the eb_master transaction
+			while(FpgaReset::_reset_was_triggered == false || ending_countdown > 0){
+				if (FpgaReset::_reset_was_triggered) {
+					eb_slave->shutdown();
+					std::cerr << --ending_countdown << std::endl;
+				}
+				eb_slave->master_out(&cyc,&stb,&we,&adr,&dat,&sel);
+				if (cyc==STD_LOGIC_1 && stb==STD_LOGIC_1) {
+					// do a read/write access on the device that contains the requested address
+					if (we == STD_LOGIC_1) {
+						dat_out = dat;
+					}
+					if (devices.access(we == STD_LOGIC_1, adr, sel, &dat_out)) {
+						ack = STD_LOGIC_1;
+						err = STD_LOGIC_0;
+					} else {
+						err = STD_LOGIC_1;
+						ack = STD_LOGIC_0;
+					}
+				}
 
-			eb_slave->master_in(stb,  ack, err, STD_LOGIC_0, dat_out);
+				eb_slave->master_in(stb,  ack, err, STD_LOGIC_0, dat_out);
+			}
 		}
 		eca_thread.join();
-		delete eb_slave;
+		if (generator_thread.joinable()) {
+			generator_thread.join();
+		}
 	} catch (std::runtime_error &e) {
 		std::cerr << "Error: " << e.what() << std::endl;
 		return false;
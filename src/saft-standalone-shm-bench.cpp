@@ -0,0 +1,103 @@
+#include "SAFTd.hpp"
+#include "TimingReceiver.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <exception>
+#include <chrono>
+
+// Compare reading LM32 shared memory word by word (one etherbone transaction per word)
+// with reading the same block in one etherbone cycle, as done by BurstGenerator::readBlock.
+// Works with real hardware and with saft-software-tr, which emulates the LM32 user RAM.
+// The benchmark only reads. It never writes to the RAM, because on real hardware the RAM 
+// holds the firmware of the running cpu 0. For the same reason, the content may change 
+// between two reads, so a difference between single reads and block read is only reported.
+
+static std::vector<uint32_t> read_single(etherbone::Device &device, eb_address_t address, unsigned count)
+{
+	std::vector<uint32_t> result;
+	for (unsigned i = 0; i < count; ++i) {
+		eb_data_t data;
+		device.read(address + (i << 2), EB_DATA32, &data);
+		result.push_back(data);
+	}
+	return result;
+}
+
+static std::vector<uint32_t> read_block(etherbone::Device &device, eb_address_t address, unsigned count)
+{
+	std::vector<eb_data_t> buffer(count);
+	etherbone::Cycle cycle;
+	cycle.open(device);
+	for (unsigned i = 0; i < count; ++i) {
+		cycle.read(address + (i << 2), EB_DATA32, &buffer[i]);
+	}
+	cycle.close();
+	return std::vector<uint32_t>(buffer.begin(), buffer.end());
+}
+
+int main(int argc, char *argv[]) {
+	if (argc != 4) {
+		std::cerr << "Measure the time to read a block of LM32 shared memory with single reads" << std::endl;
+		std::cerr << "and with one etherbone cycle" << std::endl;
+		std::cerr << "usage: " << argv[0] << " <eb-device> <number-of-words> <number-of-measurements>" << std::endl;
+		std::cout << std::endl;
+		std::cerr << "   example: " << argv[0] << " dev/wbm0 64 100" << std::endl;
+		return 1;
+	}
+	try {
+		unsigned words, N;
+		std::istringstream words_in(argv[2]);
+		words_in >> words;
+		std::istringstream N_in(argv[3]);
+		N_in >> N;
+		if (!words_in || !N_in || N == 0) {
+			std::cerr << "cannot read number-of-words or number-of-measurements" << std::endl;
+			return 1;
+		}
+
+		auto saftd = std::make_shared<saftlib::SAFTd>();
+		auto tr    = std::make_shared<saftlib::TimingReceiver>(*saftd, "tr0", argv[1]);
+		if (tr->LM32Cluster::dpram_lm32_adr_first.empty()) {
+			std::cerr << "no LM32 RAM found" << std::endl;
+			return 1;
+		}
+		etherbone::Device &device = tr->OpenDevice::get_device();
+		eb_address_t address = tr->LM32Cluster::dpram_lm32_adr_first[0];
+		if (address + words*4 > tr->LM32Cluster::dpram_lm32_adr_last[0] + 1) {
+			std::cerr << "number-of-words exceeds LM32 RAM size" << std::endl;
+			return 1;
+		}
+
+		// check that both methods read the same data (the RAM is not written, see above)
+		if (read_single(device, address, words) != read_block(device, address, words)) {
+			std::cerr << "warning: single reads and block read returned different data" 
+			          << " (the running firmware may have changed the RAM)" << std::endl;
+		}
+
+		std::chrono::nanoseconds single(0), block(0);
+		for (unsigned n = 0; n < N; ++n) {
+			auto start = std::chrono::steady_clock::now();
+			read_single(device, address, words);
+			auto middle = std::chrono::steady_clock::now();
+			read_block(device, address, words);
+			auto stop = std::chrono::steady_clock::now();
+			single += middle-start;
+			block  += stop-middle;
+		}
+
+		std::cout << "words: " << words << ", measurements: " << N << std::endl;
+		std::cout << "single reads: " << single.count()/N/1000 << " us per block" << std::endl;
+		std::cout << "block read:   " << block.count()/N/1000  << " us per block" << std::endl;
+
+	} catch (std::runtime_error &e ) {
+		std::cerr << "exception: " << e.what() << std::endl;
+		return 1;
+	} catch (etherbone::exception_t &e) {
+		std::cerr << "etherbone exception: " << e << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -1,5 +1,8 @@
 #include "FunctionGeneratorSharedMemory.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+
 using namespace test::system::FunctionGenerator;
 
 FunctionGeneratorSharedMemory::FunctionGeneratorSharedMemory(std::string sharedMemoryName, size_t sharedMemorySizeInBytes)
@@ -35,4 +38,54 @@ void FunctionGeneratorSharedMemory::PrepareFgData(const std::vector<ParameterTup
     ParameterVector v(data.size(), m_sharedMemory->get_segment_manager());
     v.assign(data.cbegin(), data.cend());
     m_indexMap->insert(std::pair<const KeyType, ValueType>{key, std::move(v)});
-}
\ No newline at end of file
+}
+FunctionGeneratorParameterCache::FunctionGeneratorParameterCache(std::string sharedMemoryName, size_t sharedMemorySizeInBytes,
+                                                                 uint32_t numberOfFunctionGenerators, uint32_t numberOfBeamProcesses)
+    : m_sharedMemoryName(std::move(sharedMemoryName)), m_nextTuple(0)
+{
+    boost::interprocess::shared_memory_object::remove(m_sharedMemoryName.c_str());
+    m_sharedMemory.reset(new boost::interprocess::managed_shared_memory(boost::interprocess::create_only,
+                                                                        m_sharedMemoryName.c_str(),
+                                                                        sharedMemorySizeInBytes));
+    m_sharedMemory->construct<int32_t>("format-version")(FG_PARAMETER_CACHE_FORMAT_VERSION);
+
+    // use most of the free memory for tuples, the rest is needed by the segment manager
+    size_t indexSize = fg_parameter_cache_size(numberOfFunctionGenerators, numberOfBeamProcesses, 0);
+    size_t available = m_sharedMemory->get_free_memory() * 9 / 10;
+    if (available < indexSize)
+    {
+        throw std::runtime_error("Shared memory too small for parameter cache index");
+    }
+    uint32_t tupleCapacity = (available - indexSize) / FG_PARAMETER_CACHE_TUPLE_SIZE;
+    size_t blockSize = fg_parameter_cache_size(numberOfFunctionGenerators, numberOfBeamProcesses, tupleCapacity);
+    char* block = m_sharedMemory->construct<char>(FG_PARAMETER_CACHE_NAME)[blockSize](0);
+    m_cache = fg_parameter_cache_init(block, numberOfFunctionGenerators, numberOfBeamProcesses, tupleCapacity);
+}
+
+void FunctionGeneratorParameterCache::PrepareFgData(const std::vector<ParameterTuple>& data, int fgIndex, int beam_process)
+{
+    if (fgIndex < 0 || static_cast<uint32_t>(fgIndex) >= m_cache->num_fgs ||
+        beam_process < 0 || static_cast<uint32_t>(beam_process) >= m_cache->num_beam_processes)
+    {
+        throw std::out_of_range("Function generator or beam process not in parameter cache");
+    }
+    FgParameterCacheEntry& entry = fg_parameter_cache_index(m_cache)[fgIndex * m_cache->num_beam_processes + beam_process];
+    // overwrite in place if the new data fits, otherwise append (the old range is not reused)
+    uint32_t first = (data.size() <= entry.count) ? entry.first : m_nextTuple;
+    if (first + data.size() > m_cache->tuple_capacity)
+    {
+        throw std::length_error("Parameter cache is full");
+    }
+    ParameterTuple* tuples = reinterpret_cast<ParameterTuple*>(fg_parameter_cache_tuples(m_cache));
+
+    fg_parameter_cache_begin_write(m_cache);
+    std::copy(data.cbegin(), data.cend(), tuples + first);
+    entry.first = first;
+    entry.count = data.size();
+    fg_parameter_cache_end_write(m_cache);
+
+    if (first == m_nextTuple)
+    {
+        m_nextTuple += data.size();
+    }
+}
@@ -10,6 +10,7 @@
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
 
 #include "ParameterSet.hpp"
+#include "fg_parameter_cache.h"
 
 namespace test::system::FunctionGenerator
 {
@@ -33,4 +34,19 @@ private:
     boost::interprocess::interprocess_mutex* m_shmMutex;
     IndexMap* m_indexMap;
 };
+
+// writer for shared memory format version 1 (flat parameter cache, see fg_parameter_cache.h)
+class FunctionGeneratorParameterCache
+{
+public:
+    FunctionGeneratorParameterCache(std::string sharedMemoryName, size_t sharedMemorySizeInBytes,
+                                    uint32_t numberOfFunctionGenerators, uint32_t numberOfBeamProcesses);
+    void PrepareFgData(const std::vector<ParameterTuple>& data, int fgIndex, int beam_process);
+
+private:
+    std::string m_sharedMemoryName;
+    std::unique_ptr<boost::interprocess::managed_shared_memory> m_sharedMemory;
+    FgParameterCacheHeader* m_cache;
+    uint32_t m_nextTuple;
+};
 }
\ No newline at end of file
@@ -52,15 +52,30 @@ int main(int argc, char **argv)
     FUNCTION_GENERATOR_NAMES = components.masterFunctionGeneratorProxy->ReadAllNames();
     const auto numberOfFunctionGenerators = FUNCTION_GENERATOR_NAMES.size();
 
-    test::system::FunctionGenerator::FunctionGeneratorSharedMemory sharedMemory("MasterFunctionGeneratorTest", 40000000);
-
-    for(uint32_t beamProcess = 0; beamProcess < 100; ++beamProcess)
+    // "-c" selects shared memory format version 1 (flat parameter cache)
+    const bool useParameterCache = argc > 1 && std::string(argv[1]) == "-c";
+    auto prepareSharedMemory = [&](auto &sharedMemory)
     {
-        auto tupleSet = GenerateRandomTupleSet(3000, 3000);
-        for(size_t functionGeneratorIndex = 0; functionGeneratorIndex < numberOfFunctionGenerators; ++functionGeneratorIndex)
+        for(uint32_t beamProcess = 0; beamProcess < 100; ++beamProcess)
         {
-            sharedMemory.PrepareFgData(tupleSet, functionGeneratorIndex, beamProcess);
+            auto tupleSet = GenerateRandomTupleSet(3000, 3000);
+            for(size_t functionGeneratorIndex = 0; functionGeneratorIndex < numberOfFunctionGenerators; ++functionGeneratorIndex)
+            {
+                sharedMemory.PrepareFgData(tupleSet, functionGeneratorIndex, beamProcess);
+            }
         }
+    };
+    std::optional<test::system::FunctionGenerator::FunctionGeneratorSharedMemory> sharedMemory;
+    std::optional<test::system::FunctionGenerator::FunctionGeneratorParameterCache> parameterCache;
+    if (useParameterCache)
+    {
+        parameterCache.emplace("MasterFunctionGeneratorTest", 40000000, numberOfFunctionGenerators, 100);
+        prepareSharedMemory(*parameterCache);
+    }
+    else
+    {
+        sharedMemory.emplace("MasterFunctionGeneratorTest", 40000000);
+        prepareSharedMemory(*sharedMemory);
     }
 
     ParameterSets parameterSets(numberOfFunctionGenerators);
@@ -0,0 +1,120 @@
+/*  Copyright (C) 2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+// Drive all outputs of a TimingReceiver with TimingReceiver::WriteOutputs and read them back 
+// with TimingReceiver::ReadAllIoStates. The first round is done before any Output Proxy exists,
+// the second round after a Proxy was created for each Output.
+// Run it once with a normal saftbusd and once with a saftbusd that was started with 
+// SAFTBUS_LAZY_OBJECTS=1. In the lazy case the Output services do not exist during the first round.
+// Works with real hardware (the outputs will toggle!) and with saft-software-tr, which emulates 
+// a few GPIO outputs.
+
+#include <SAFTd_Proxy.hpp>
+#include <TimingReceiver_Proxy.hpp>
+#include <Output_Proxy.hpp>
+#include <saftbus/error.hpp>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+
+namespace {
+
+	bool write_and_check(std::shared_ptr<saftlib::TimingReceiver_Proxy> receiver, const std::string &round, uint8_t value)
+	{
+		std::vector<std::string> names;
+		std::map<std::string, std::vector<uint8_t> > states = receiver->ReadAllIoStates(names);
+		std::vector<uint8_t> mask(names.size(), 0);
+		std::vector<uint8_t> values(names.size(), value);
+		for (unsigned i = 0; i < names.size(); ++i) {
+			mask[i] = (states["Direction"][i] != 1); // 0=output, 1=input, 2=inout
+		}
+		try {
+			receiver->WriteOutputs(mask, values);
+		} catch (saftbus::Error &e) {
+			std::cerr << round << ": WriteOutputs(" << (int)value << ") failed: " << e.what() << std::endl;
+			return false;
+		}
+		bool ok = true;
+		states = receiver->ReadAllIoStates(names);
+		for (unsigned i = 0; i < names.size(); ++i) {
+			if (!mask[i]) continue;
+			if (states["Output"][i] != value) {
+				std::cerr << round << ": " << names[i] << " Output=" << (int)states["Output"][i] << " expected " << (int)value << std::endl;
+				ok = false;
+			}
+		}
+		return ok;
+	}
+
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 2) {
+		std::cerr << "usage: " << argv[0] << " <saftlib-device>" << std::endl;
+		std::cerr << "  drive all outputs with TimingReceiver::WriteOutputs, with and without Output Proxies" << std::endl;
+		return 1;
+	}
+
+	try {
+		std::map<std::string, std::string> devices = saftlib::SAFTd_Proxy::create()->getDevices();
+		if (devices.find(argv[1]) == devices.end()) {
+			std::cerr << "no device " << argv[1] << std::endl;
+			return 1;
+		}
+		std::shared_ptr<saftlib::TimingReceiver_Proxy> receiver = saftlib::TimingReceiver_Proxy::create(devices[argv[1]]);
+
+		std::map<std::string, std::string> outputs = receiver->getOutputs();
+		if (outputs.empty()) {
+			std::cerr << "device " << argv[1] << " has no outputs" << std::endl;
+			return 1;
+		}
+		std::cout << outputs.size() << " outputs" << std::endl;
+
+		bool ok = true;
+		// no Output Proxy exists yet
+		ok = write_and_check(receiver, "without proxies", 1) && ok;
+		ok = write_and_check(receiver, "without proxies", 0) && ok;
+
+		std::vector<std::shared_ptr<saftlib::Output_Proxy> > output_proxies;
+		for (auto &output: outputs) {
+			output_proxies.push_back(saftlib::Output_Proxy::create(output.second));
+		}
+		ok = write_and_check(receiver, "with proxies", 1) && ok;
+		ok = write_and_check(receiver, "with proxies", 0) && ok;
+
+		// the Outputs are not owned, so the single writes must still be allowed
+		for (auto &output: output_proxies) {
+			output->WriteOutput(true);
+			if (!output->ReadOutput()) {
+				std::cerr << "Output::WriteOutput had no effect" << std::endl;
+				ok = false;
+			}
+			output->WriteOutput(false);
+		}
+
+		std::cout << (ok?"PASSED":"FAILED") << std::endl;
+		return ok?0:1;
+	} catch (saftbus::Error &e) {
+		std::cerr << "saftbus error: " << e.what() << std::endl;
+	}
+	return 1;
+}
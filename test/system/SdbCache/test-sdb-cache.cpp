@@ -0,0 +1,183 @@
+/*  Copyright (C) 2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+// Compare the SDB records that SdbCache serves with the ones etherbone finds on the hardware.
+// The comparison is done twice: with the table from the SDB walk, and with the table from the 
+// cache file that the first SdbCache has written.
+// Works with real hardware and with saft-software-tr. The device must not be used by saftbusd.
+
+#include "SdbCache.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <dirent.h>
+
+namespace {
+
+	struct Identity {
+		const char *name;
+		uint32_t vendor_id;
+		uint32_t device_id;
+	};
+	// the SDB devices that saftlib drivers look up, and one that does not exist
+	const Identity identities[] = {
+		{"ECA",             0x00000651, 0xb2afc251},
+		{"ECA queue",       0x00000651, 0xd5a3faea},
+		{"ECA TLU",         0x00000651, 0x7c82afbc},
+		{"ECA event input", 0x00000651, 0x8752bf45},
+		{"IO control",      0x00000651, 0x10c05791},
+		{"serdes clk gen",  0x00000651, 0x5f3eaf43},
+		{"build id ROM",    0x00000651, 0x2d39fa8b},
+		{"MSI mailbox",     0x00000651, 0xfab0bdd8},
+		{"watchdog",        0x00000651, 0xb6232cd3},
+		{"LM32 RAM",        0x00000651, 0x54111351},
+		{"temp. sensor",    0x00000651, 0x7e3d5e25},
+		{"WR PPS gen",      0x0000ce42, 0xde0d8ced},
+		{"does not exist",  0x00000651, 0x12345678},
+	};
+
+	bool same(const sdb_device &a, const sdb_device &b) {
+		return a.abi_class     == b.abi_class 
+		    && a.abi_ver_major == b.abi_ver_major 
+		    && a.abi_ver_minor == b.abi_ver_minor 
+		    && a.bus_specific  == b.bus_specific
+		    && a.sdb_component.addr_first                == b.sdb_component.addr_first
+		    && a.sdb_component.addr_last                 == b.sdb_component.addr_last
+		    && a.sdb_component.product.vendor_id         == b.sdb_component.product.vendor_id
+		    && a.sdb_component.product.device_id         == b.sdb_component.product.device_id
+		    && a.sdb_component.product.version           == b.sdb_component.product.version
+		    && a.sdb_component.product.date              == b.sdb_component.product.date
+		    && a.sdb_component.product.record_type       == b.sdb_component.product.record_type
+		    && memcmp(a.sdb_component.product.name, b.sdb_component.product.name, sizeof(a.sdb_component.product.name)) == 0;
+	}
+	bool same(const etherbone::sdb_msi_device &a, const etherbone::sdb_msi_device &b) {
+		return a.msi_first == b.msi_first 
+		    && a.msi_last  == b.msi_last
+		    && a.sdb_component.addr_first          == b.sdb_component.addr_first
+		    && a.sdb_component.addr_last           == b.sdb_component.addr_last
+		    && a.sdb_component.product.vendor_id   == b.sdb_component.product.vendor_id
+		    && a.sdb_component.product.device_id   == b.sdb_component.product.device_id;
+	}
+
+	template<typename T>
+	void sort_by_address(std::vector<T> &records) {
+		std::sort(records.begin(), records.end(), [](const T &a, const T &b) {
+			return a.sdb_component.addr_first < b.sdb_component.addr_first;
+		});
+	}
+
+	// returns the number of identities where SdbCache and etherbone differ
+	int compare(etherbone::Device &device, const std::string &what) {
+		int errors = 0;
+		for (auto &id: identities) {
+			std::vector<sdb_device> cached, found;
+			saftlib::SdbCache::find_by_identity(device, id.vendor_id, id.device_id, cached);
+			device.sdb_find_by_identity(id.vendor_id, id.device_id, found);
+			sort_by_address(cached);
+			sort_by_address(found);
+			bool devices_ok = cached.size() == found.size() 
+			               && std::equal(cached.begin(), cached.end(), found.begin(), 
+			                             [](const sdb_device &a, const sdb_device &b) { return same(a, b); });
+
+			std::vector<etherbone::sdb_msi_device> cached_msi, found_msi;
+			saftlib::SdbCache::find_by_identity_msi(device, id.vendor_id, id.device_id, cached_msi);
+			device.sdb_find_by_identity_msi(id.vendor_id, id.device_id, found_msi);
+			sort_by_address(cached_msi);
+			sort_by_address(found_msi);
+			bool msi_ok = cached_msi.size() == found_msi.size() 
+			           && std::equal(cached_msi.begin(), cached_msi.end(), found_msi.begin(), 
+			                         [](const etherbone::sdb_msi_device &a, const etherbone::sdb_msi_device &b) { return same(a, b); });
+
+			std::cout << what << ": " << std::setw(16) << std::left << id.name << std::right
+			          << " devices " << found.size() << (devices_ok ? " ok" : " MISMATCH")
+			          << ", msi devices " << found_msi.size() << (msi_ok ? " ok" : " MISMATCH");
+			for (auto &msi: found_msi) {
+				std::cout << std::hex << " [0x" << msi.msi_first << "-0x" << msi.msi_last << "]" << std::dec;
+			}
+			std::cout << std::endl;
+			if (!devices_ok) ++errors;
+			if (!msi_ok)     ++errors;
+		}
+		return errors;
+	}
+
+	void remove_dir(const std::string &dir) {
+		DIR *d = opendir(dir.c_str());
+		if (d) {
+			while (struct dirent *entry = readdir(d)) {
+				std::string name = entry->d_name;
+				if (name != "." && name != "..") {
+					unlink((dir + "/" + name).c_str());
+				}
+			}
+			closedir(d);
+		}
+		rmdir(dir.c_str());
+	}
+}
+
+int main(int argc, char *argv[]) {
+	if (argc != 2) {
+		std::cerr << "Compare the SDB lookups of SdbCache (SDB walk and cache file) with etherbone" << std::endl;
+		std::cerr << "usage: " << argv[0] << " <eb-device>" << std::endl;
+		std::cerr << "   example: " << argv[0] << " dev/wbm0" << std::endl;
+		return 1;
+	}
+	char cache_dir[] = "/tmp/test-sdb-cache-XXXXXX";
+	if (mkdtemp(cache_dir) == nullptr) {
+		std::cerr << "cannot create a temporary directory" << std::endl;
+		return 1;
+	}
+	setenv("SAFTLIB_SDB_CACHE_DIR", cache_dir, 1);
+
+	int errors = 0;
+	try {
+		etherbone::Socket socket;
+		socket.open();
+		etherbone::Device device;
+		device.open(socket, argv[1]);
+		{
+			saftlib::SdbCache cache(device); // reads the SDB tree, writes the cache file when destroyed
+			errors += compare(device, "walk");
+		}
+		{
+			saftlib::SdbCache cache(device); // loads the cache file
+			errors += compare(device, "file");
+		}
+		device.close();
+		socket.close();
+	} catch (etherbone::exception_t &e) {
+		std::cerr << "etherbone exception: " << e << std::endl;
+		errors = -1;
+	}
+	remove_dir(cache_dir);
+
+	if (errors) {
+		std::cout << "FAILED" << std::endl;
+		return 1;
+	}
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}